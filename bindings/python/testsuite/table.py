@@ -0,0 +1,38 @@
+#!/usr/bin/python
+
+import json
+import unittest
+from storage import Environment, ProbeMode_NONE, TargetMode_DIRECT, Storage, Devicegraph, Disk, PtType_GPT
+
+
+class TestTable(unittest.TestCase):
+
+    def test_table(self):
+
+        environment = Environment(True, ProbeMode_NONE, TargetMode_DIRECT)
+        s = Storage(environment)
+
+        devicegraph = Devicegraph(s)
+        sda = Disk.create(devicegraph, "/dev/sda")
+        gpt = sda.create_partition_table(PtType_GPT)
+
+        table = devicegraph.get_table()
+
+        self.assertEqual(table.size(), 2)
+        self.assertEqual(list(table.sids), [sda.get_sid(), gpt.get_sid()])
+        self.assertEqual(list(table.classnames), ["Disk", "Gpt"])
+        self.assertEqual(list(table.parent_sids), [sda.get_sid()])
+        self.assertEqual(list(table.child_offsets), [0, 1, 1])
+        self.assertEqual(list(table.child_sids), [gpt.get_sid()])
+
+        self.assertEqual(list(devicegraph.get_children_sids(sda.get_sid())), [gpt.get_sid()])
+
+        data = json.loads(devicegraph.get_table_json())
+
+        self.assertEqual(data["sids"], [sda.get_sid(), gpt.get_sid()])
+        self.assertEqual(data["names"], ["/dev/sda", ""])
+        self.assertEqual(data["parent_offsets"], [0, 0, 1])
+
+
+if __name__ == '__main__':
+    unittest.main()
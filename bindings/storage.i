@@ -27,11 +27,21 @@
 %catches(storage::DeviceNotFound) storage::Devicegraph::find_device(sid_t) const;
 %catches(storage::HolderNotFound) storage::Devicegraph::find_holder(sid_t, sid_t);
 %catches(storage::HolderNotFound) storage::Devicegraph::find_holder(sid_t, sid_t) const;
+%catches(storage::DeviceNotFound) storage::Devicegraph::get_children_sids(sid_t) const;
+%catches(storage::DeviceNotFound) storage::Devicegraph::get_parent_sids(sid_t) const;
 
 %catches(storage::DeviceNotFound, storage::DeviceHasWrongType) storage::BlkDevice::find(const Devicegraph*, const std::string&);
 %catches(storage::DeviceNotFound, storage::DeviceHasWrongType) storage::Disk::find(const Devicegraph*, const std::string&);
 %catches(storage::DeviceNotFound, storage::DeviceHasWrongType) storage::Partition::find(const Devicegraph*, const std::string&);
 
+%catches(storage::DeviceNotFound) storage::DeviceView::find(const std::string&) const;
+%catches(std::out_of_range) storage::DeviceView::get_name(size_t) const;
+%catches(std::out_of_range) storage::DeviceView::get_type(size_t) const;
+%catches(std::out_of_range) storage::DeviceView::get_size_k(size_t) const;
+%catches(std::out_of_range) storage::DeviceView::get_mountpoint(size_t) const;
+%catches(std::out_of_range) storage::DeviceView::get_parents(size_t) const;
+%catches(std::out_of_range) storage::DeviceView::get_children(size_t) const;
+
 %feature("director") storage::CommitCallbacks;
 %feature("director") storage::RemoteCallbacks;
 
@@ -62,11 +72,15 @@
 #include "storage/Devices/LvmVg.h"
 #include "storage/Holders/Holder.h"
 #include "storage/Devicegraph.h"
+#include "storage/DevicegraphTemplate.h"
+#include "storage/DeviceView.h"
 #include "storage/Environment.h"
 #include "storage/Storage.h"
+#include "storage/ImageBuilder.h"
 %}
 
 %include "stdint.i"
+%include "std_except.i"
 %include "std_string.i"
 %include "std_vector.i"
 %include "std_list.i"
@@ -92,14 +106,26 @@
 %include "../../storage/Devices/LvmVg.h"
 %include "../../storage/Holders/Holder.h"
 %include "../../storage/Devicegraph.h"
+%include "../../storage/DevicegraphTemplate.h"
+%include "../../storage/DeviceView.h"
 %include "../../storage/Environment.h"
 %include "../../storage/Storage.h"
+%include "../../storage/ImageBuilder.h"
 
 using namespace storage;
 
 %template(VectorString) std::vector<std::string>;
 %template(ListString) std::list<std::string>;
 %template(MapStringString) std::map<std::string, std::string>;
+%template(VectorMapStringString) std::vector<std::map<std::string, std::string>>;
+
+%template(VectorSid) std::vector<sid_t>;
+%template(VectorSizeT) std::vector<size_t>;
+%template(VectorUnsignedLongLong) std::vector<unsigned long long>;
+
+%template(VectorRegion) std::vector<Region>;
+%template(VectorRemoteCommand) std::vector<RemoteCommand>;
+%template(VectorRemoteFile) std::vector<RemoteFile>;
 
 %template(VectorConstDevicePtr) std::vector<const Device*>;
 %template(VectorConstPartitionPtr) std::vector<const Partition*>;
@@ -0,0 +1,72 @@
+
+#include <iostream>
+#include <sstream>
+
+#include "storage/Devices/Disk.h"
+#include "storage/Devices/Gpt.h"
+#include "storage/Devices/Partition.h"
+#include "storage/Holders/Subdevice.h"
+#include "storage/Devicegraph.h"
+#include "storage/DevicegraphTemplate.h"
+#include "storage/Actiongraph.h"
+#include "storage/Storage.h"
+#include "storage/Environment.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+// like big1 but the partitions are stamped onto all disks from a template,
+// the partitions are renamed according to the disk names
+
+
+int
+main()
+{
+    storage::Environment environment(true, ProbeMode::NONE, TargetMode::DIRECT);
+
+    Storage storage(environment);
+
+    Devicegraph* lhs = storage.create_devicegraph("lhs");
+
+    const int n = 1000;
+
+    vector<const Device*> disks;
+
+    for (int i = 0; i < n; ++i)
+    {
+	ostringstream s;
+	s << "/dev/disk" << i;
+	Disk::create(lhs, s.str());
+    }
+
+    Devicegraph* rhs = storage.copy_devicegraph("lhs", "rhs");
+
+    for (Disk* disk : Disk::get_all(rhs))
+	disks.push_back(disk);
+
+    Devicegraph* tmp = storage.create_devicegraph("template");
+
+    Disk* disk = Disk::create(tmp, "/dev/disk");
+
+    Gpt* gpt = Gpt::create(tmp);
+    Subdevice::create(tmp, disk, gpt);
+
+    for (int i = 1; i <= 3; ++i)
+    {
+	ostringstream s;
+	s << "/dev/disk" << i;
+	Partition* partition = Partition::create(tmp, s.str(), PRIMARY);
+	Subdevice::create(tmp, gpt, partition);
+    }
+
+    DevicegraphTemplate devicegraph_template(disk);
+    devicegraph_template.instantiate(rhs, disks);
+
+    cout << rhs << endl;
+
+    Actiongraph actiongraph(storage, lhs, rhs);
+
+    actiongraph.print_graph();
+}
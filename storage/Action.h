@@ -24,6 +24,8 @@ namespace storage
 
 	    virtual ~Base() {}
 
+	    virtual const char* get_classname() const = 0;
+
 	    virtual Text text(const Actiongraph& actiongraph, bool doing) const = 0;
 	    virtual void commit(const Actiongraph& actiongraph) const {} // = 0; TODO
 
@@ -44,6 +46,8 @@ namespace storage
 
 	    Nop(sid_t sid) : Base(sid) {}
 
+	    virtual const char* get_classname() const override { return "Nop"; }
+
 	    virtual Text text(const Actiongraph& actiongraph, bool doing) const override;
 
 	};
@@ -55,6 +59,8 @@ namespace storage
 
 	    Create(sid_t sid) : Base(sid) {}
 
+	    virtual const char* get_classname() const override { return "Create"; }
+
 	    virtual Text text(const Actiongraph& actiongraph, bool doing) const override;
 	    virtual void commit(const Actiongraph& actiongraph) const override;
 
@@ -74,6 +80,8 @@ namespace storage
 
 	    Modify(sid_t sid) : Base(sid) {}
 
+	    virtual const char* get_classname() const override { return "Modify"; }
+
 	protected:
 
 	    const Device* device_lhs(const Actiongraph& actiongraph) const
@@ -91,6 +99,8 @@ namespace storage
 
 	    Delete(sid_t sid) : Base(sid) {}
 
+	    virtual const char* get_classname() const override { return "Delete"; }
+
 	    virtual Text text(const Actiongraph& actiongraph, bool doing) const override;
 	    virtual void commit(const Actiongraph& actiongraph) const override;
 
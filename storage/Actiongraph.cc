@@ -15,6 +15,11 @@
 #include "storage/Action.h"
 #include "storage/Actiongraph.h"
 #include "storage/Storage.h"
+#include "storage/StorageImpl.h"
+#include "storage/EtcFstab.h"
+#include "storage/CommitPlan.h"
+#include "storage/Utils/Tracer.h"
+#include "storage/Utils/OutputProcessor.h"
 #include "storage/Utils/StorageTmpl.h"
 
 
@@ -43,6 +48,11 @@ namespace storage
     }
 
 
+    Actiongraph::~Actiongraph()
+    {
+    }
+
+
     Actiongraph::vertex_descriptor
     Actiongraph::add_vertex(Action::Base* action)
     {
@@ -254,6 +264,8 @@ namespace storage
     void
     Actiongraph::commit(const CommitCallbacks* commit_callbacks) const
     {
+	durations.assign(num_vertices(graph), -1.0);
+
 	for (const vertex_descriptor& vertex : order)
 	{
 	    const Action::Base* action = graph[vertex].get();
@@ -265,27 +277,110 @@ namespace storage
 	    y2mil("Commit Action " << text);
 	    cout << text << endl;
 
+	    Tracer::Span span("action", text);
+	    span.set_arg("sid", action->sid);
+	    span.set_arg("class", action->get_classname());
+
 	    if (commit_callbacks)
 	    {
+		Tracer::Span callback_span("callback", "pre");
+
 		commit_callbacks->message(text);
 		commit_callbacks->pre(action);
 	    }
 
+	    StopWatch stopwatch;
+
 	    try
 	    {
+		FractionProgress::Callback callback;
+		if (commit_callbacks)
+		    callback = [commit_callbacks](const string& message, double fraction) {
+			commit_callbacks->progress(message, fraction);
+		    };
+
+		FractionProgress::Record record(callback);
+
 		action->commit(*this);
 	    }
 	    catch (const exception& e)
 	    {
-		if (!commit_callbacks || !commit_callbacks->error(text, e.what()))
+		span.set_arg("error", e.what());
+
+		bool ignore = false;
+
+		if (commit_callbacks)
+		{
+		    Tracer::Span callback_span("callback", "error");
+
+		    ignore = commit_callbacks->error(text, e.what());
+		}
+
+		if (!ignore)
+		{
+		    // keep the fstab entries of the actions done so far, the
+		    // original error is more important than a failure here
+		    try
+		    {
+			sync_etc_fstab();
+		    }
+		    catch (const exception& e2)
+		    {
+			y2err("syncing fstab after error failed: " << e2.what());
+		    }
+
 		    throw;
+		}
 	    }
 
+	    durations[vertex] = stopwatch.read();
+
 	    if (commit_callbacks)
 	    {
+		Tracer::Span callback_span("callback", "post");
+
 		commit_callbacks->post(action);
 	    }
 	}
+
+	sync_etc_fstab();
+    }
+
+
+    double
+    Actiongraph::get_duration(vertex_descriptor v) const
+    {
+	return v < durations.size() ? durations[v] : -1.0;
+    }
+
+
+    EtcFstab&
+    Actiongraph::get_etc_fstab() const
+    {
+	if (!etc_fstab)
+	    etc_fstab.reset(new EtcFstab(storage.get_impl().prepend_rootprefix("/etc")));
+
+	return *etc_fstab;
+    }
+
+
+    void
+    Actiongraph::sync_etc_fstab() const
+    {
+	if (!etc_fstab)
+	    return;
+
+	Tracer::Span span("fstab", "sync fstab");
+
+	int ret = etc_fstab->flush();
+
+	span.set_arg("ret", ret);
+
+	// read again on next use
+	etc_fstab.reset();
+
+	if (ret != 0)
+	    throw runtime_error("updating fstab failed");
     }
 
 
@@ -333,11 +428,12 @@ namespace storage
 
     struct write_vertex
     {
-	write_vertex(const Actiongraph& actiongraph, bool details)
-	    : actiongraph(actiongraph), details(details) {}
+	write_vertex(const Actiongraph& actiongraph, bool details, const CommitPlan* plan)
+	    : actiongraph(actiongraph), details(details), plan(plan) {}
 
 	const Actiongraph& actiongraph;
 	const bool details;
+	const CommitPlan* plan;
 
 	void operator()(ostream& out, const Actiongraph::vertex_descriptor& v) const
 	{
@@ -345,6 +441,14 @@ namespace storage
 
 	    string label = action->text(actiongraph, false).text;
 
+	    if (plan)
+	    {
+		ostringstream tmp;
+		classic(tmp);
+		tmp << plan->get_cost(v);
+		label += "\\n" "cost:" + tmp.str() + "s";
+	    }
+
 	    if (details)
 	    {
 		label += "\\n" "sid:" + to_string(action->sid);
@@ -370,21 +474,40 @@ namespace storage
 	    else
 		throw logic_error("unknown Action::Base subclass");
 
+	    if (plan && plan->is_critical(v))
+		out << ", penwidth=3";
+
 	    out << " ]";
 	}
     };
 
 
+    struct write_edge
+    {
+	write_edge(const Actiongraph& actiongraph, const CommitPlan* plan)
+	    : actiongraph(actiongraph), plan(plan) {}
+
+	const Actiongraph& actiongraph;
+	const CommitPlan* plan;
+
+	void operator()(ostream& out, const Actiongraph::edge_descriptor& e) const
+	{
+	    if (plan && plan->is_critical(e))
+		out << "[ penwidth=3 ]";
+	}
+    };
+
+
     void
-    Actiongraph::write_graphviz(const string& filename, bool details) const
+    Actiongraph::write_graphviz(const string& filename, bool details, const CommitPlan* plan) const
     {
 	ofstream fout(filename);
 
 	fout << "// generated by libstorage version " VERSION << endl;
 	fout << endl;
 
-	boost::write_graphviz(fout, graph, write_vertex(*this, details), boost::default_writer(),
-			      write_graph(*this));
+	boost::write_graphviz(fout, graph, write_vertex(*this, details, plan),
+			      write_edge(*this, plan), write_graph(*this));
 
 	fout.close();
     }
@@ -6,6 +6,7 @@
 #include <map>
 #include <deque>
 #include <set>
+#include <memory>
 #include <boost/noncopyable.hpp>
 #include <boost/graph/adjacency_list.hpp>
 
@@ -26,6 +27,8 @@ namespace storage
 
     class Storage;
     class CommitCallbacks;
+    class CommitPlan;
+    class EtcFstab;
 
 
     namespace Action
@@ -55,6 +58,7 @@ namespace storage
 	typedef graph_t::vertices_size_type vertices_size_type;
 
 	Actiongraph(const Storage& storage, const Devicegraph* lhs, const Devicegraph* rhs);
+	~Actiongraph();
 
 	const Storage& get_storage() const { return storage; }
 
@@ -73,13 +77,38 @@ namespace storage
 	Text get_action_text(vertex_descriptor v, bool doing) const;
 
 	void print_graph() const;
-	void write_graphviz(const string& filename, bool details = false) const;
+
+	/**
+	 * If a plan is given the estimated costs are added to the actions and
+	 * the critical path is highlighted.
+	 */
+	void write_graphviz(const string& filename, bool details = false,
+			    const CommitPlan* plan = nullptr) const;
 
 	graph_t graph;
 
 	list<string> get_commit_steps() const;
 	void commit(const CommitCallbacks* commit_callbacks) const;
 
+	/**
+	 * The fstab of the current commit. It is read on first use and all
+	 * fstab actions collect their changes in it.
+	 */
+	EtcFstab& get_etc_fstab() const;
+
+	/**
+	 * Writes the pending changes of the fstab to disk. Done once at the
+	 * end of commit, actions may call it when they need the changes on
+	 * disk earlier.
+	 */
+	void sync_etc_fstab() const;
+
+	/**
+	 * Duration of the action in seconds measured during the last commit
+	 * or a negative value if the action was not committed.
+	 */
+	double get_duration(vertex_descriptor v) const;
+
 	// special actions
 	vertex_iterator mount_root_filesystem;
 
@@ -99,6 +128,10 @@ namespace storage
 
 	Order order;
 
+	mutable std::unique_ptr<EtcFstab> etc_fstab;
+
+	mutable vector<double> durations;
+
     };
 
 }
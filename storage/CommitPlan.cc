@@ -0,0 +1,482 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#include <math.h>
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <boost/graph/topological_sort.hpp>
+
+#include "config.h"
+#include "storage/Devices/DeviceImpl.h"
+#include "storage/Devices/BlkDevice.h"
+#include "storage/Devices/Filesystem.h"
+#include "storage/Devicegraph.h"
+#include "storage/Action.h"
+#include "storage/CommitPlan.h"
+#include "storage/Utils/XmlFile.h"
+#include "storage/Utils/JsonParser.h"
+#include "storage/Utils/AppUtil.h"
+
+
+namespace storage
+{
+    using namespace std;
+
+
+    CommitTimeModel::CommitTimeModel()
+    {
+	costs = {
+	    { "Nop", Cost(0.0) },
+	    { "Create", Cost(1.0) },
+	    { "Modify", Cost(0.5) },
+	    { "Delete", Cost(1.0) },
+
+	    { "Create/Partition", Cost(1.5) },
+	    { "Delete/Partition", Cost(1.5) },
+	    { "Create/Gpt", Cost(1.0) },
+	    { "Create/Msdos", Cost(1.0) },
+	    { "Create/Ext4", Cost(1.0, 0.25) },
+	    { "Create/Xfs", Cost(0.5, 0.02) },
+	    { "Create/Btrfs", Cost(0.5, 0.02) },
+	    { "Create/Swap", Cost(0.2, 0.01) },
+	    { "Create/LvmVg", Cost(1.0) },
+	    { "Create/LvmLv", Cost(1.0) },
+	    { "Create/Encryption", Cost(3.0) },
+
+	    { "Mount", Cost(0.2) },
+	    { "Umount", Cost(0.2) },
+	    { "AddFstab", Cost(0.01) },
+	    { "RemoveFstab", Cost(0.01) },
+	    { "SetLabel", Cost(0.5) },
+	    { "SetPartitionId", Cost(1.0) },
+	    { "Rename", Cost(0.5) },
+	    { "OpenEncryption", Cost(2.0) }
+	};
+    }
+
+
+    CommitTimeModel::Cost
+    CommitTimeModel::get_cost(const string& key) const
+    {
+	map<string, Cost>::const_iterator it = costs.find(key);
+	if (it != costs.end())
+	    return it->second;
+
+	string::size_type pos = key.find('/');
+	if (pos != string::npos)
+	{
+	    it = costs.find(key.substr(0, pos));
+	    if (it != costs.end())
+		return it->second;
+	}
+
+	return Cost(1.0);
+    }
+
+
+    static const Device*
+    find_action_device(const Actiongraph& actiongraph, Actiongraph::vertex_descriptor v)
+    {
+	sid_t sid = actiongraph.graph[v]->sid;
+
+	for (Side side : { RHS, LHS })
+	{
+	    const Devicegraph* devicegraph = actiongraph.get_devicegraph(side);
+	    if (devicegraph && devicegraph->device_exists(sid))
+		return devicegraph->find_device(sid);
+	}
+
+	return nullptr;
+    }
+
+
+    string
+    CommitTimeModel::get_key(const Actiongraph& actiongraph, Actiongraph::vertex_descriptor v)
+    {
+	const Action::Base* action = actiongraph.graph[v].get();
+
+	string key = action->get_classname();
+
+	// only the generic actions depend on the kind of device
+	if (dynamic_cast<const Action::Create*>(action) || dynamic_cast<const Action::Delete*>(action))
+	{
+	    const Device* device = find_action_device(actiongraph, v);
+	    if (device)
+		key += string("/") + device->get_impl().get_classname();
+	}
+
+	return key;
+    }
+
+
+    double
+    CommitTimeModel::get_size_gib(const Actiongraph& actiongraph, Actiongraph::vertex_descriptor v)
+    {
+	const Device* device = find_action_device(actiongraph, v);
+
+	unsigned long long size_k = 0;
+
+	if (const BlkDevice* blkdevice = dynamic_cast<const BlkDevice*>(device))
+	{
+	    size_k = blkdevice->get_size_k();
+	}
+	else if (const Filesystem* filesystem = dynamic_cast<const Filesystem*>(device))
+	{
+	    for (const BlkDevice* blkdevice : filesystem->get_blkdevices())
+		size_k += blkdevice->get_size_k();
+	}
+
+	return size_k / (1024.0 * 1024.0);
+    }
+
+
+    double
+    CommitTimeModel::estimate(const Actiongraph& actiongraph, Actiongraph::vertex_descriptor v) const
+    {
+	Cost cost = get_cost(get_key(actiongraph, v));
+
+	if (cost.per_gib == 0.0)
+	    return cost.base;
+
+	return cost.base + cost.per_gib * get_size_gib(actiongraph, v);
+    }
+
+
+    void
+    CommitTimeModel::record(const Actiongraph& actiongraph)
+    {
+	for (Actiongraph::vertex_descriptor v : actiongraph.vertices())
+	{
+	    double duration = actiongraph.get_duration(v);
+	    if (duration < 0.0)
+		continue;
+
+	    samples[get_key(actiongraph, v)].emplace_back(get_size_gib(actiongraph, v), duration);
+	}
+    }
+
+
+    void
+    CommitTimeModel::calibrate()
+    {
+	for (const map<string, vector<pair<double, double>>>::value_type& it : samples)
+	{
+	    const vector<pair<double, double>>& points = it.second;
+	    if (points.empty())
+		continue;
+
+	    double n = points.size();
+	    double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+
+	    for (const pair<double, double>& point : points)
+	    {
+		sx += point.first;
+		sy += point.second;
+		sxx += point.first * point.first;
+		sxy += point.first * point.second;
+	    }
+
+	    Cost cost(sy / n);
+
+	    // least squares fit if the sizes differ enough to tell base and
+	    // size dependent part apart
+	    double d = n * sxx - sx * sx;
+	    if (d > 1e-9)
+	    {
+		double per_gib = (n * sxy - sx * sy) / d;
+		double base = (sy - per_gib * sx) / n;
+
+		if (per_gib >= 0.0 && base >= 0.0)
+		    cost = Cost(base, per_gib);
+		else if (per_gib >= 0.0)
+		    cost = Cost(0.0, sxy / sxx);
+	    }
+
+	    y2mil("calibrated " << it.first << " base:" << cost.base << " per-gib:" <<
+		  cost.per_gib << " samples:" << points.size());
+
+	    costs[it.first] = cost;
+	}
+    }
+
+
+    static string
+    to_string(double value)
+    {
+	std::ostringstream ostr;
+	classic(ostr);
+	ostr << value;
+	return ostr.str();
+    }
+
+
+    void
+    CommitTimeModel::load(const string& filename)
+    {
+	XmlFile xml(filename);
+
+	const xmlNode* root_node = xml.getRootElement();
+	if (!root_node)
+	    throw runtime_error("invalid commit time model");
+
+	const xmlNode* model_node = getChildNode(root_node, "CommitTimeModel");
+	if (!model_node)
+	    throw runtime_error("invalid commit time model");
+
+	for (const xmlNode* cost_node : getChildNodes(model_node, "Cost"))
+	{
+	    string key;
+	    if (!getChildValue(cost_node, "key", key))
+		continue;
+
+	    Cost cost;
+	    getChildValue(cost_node, "base", cost.base);
+	    getChildValue(cost_node, "per-gib", cost.per_gib);
+
+	    costs[key] = cost;
+	}
+    }
+
+
+    void
+    CommitTimeModel::save(const string& filename) const
+    {
+	XmlFile xml;
+
+	xmlNode* model_node = xmlNewNode("CommitTimeModel");
+	xml.setRootElement(model_node);
+
+	xmlNode* comment = xmlNewComment(" generated by libstorage version " VERSION " ");
+	xmlAddPrevSibling(model_node, comment);
+
+	for (const map<string, Cost>::value_type& it : costs)
+	{
+	    xmlNode* cost_node = xmlNewChild(model_node, "Cost");
+
+	    setChildValue(cost_node, "key", it.first);
+	    setChildValue(cost_node, "base", to_string(it.second.base));
+	    setChildValueIf(cost_node, "per-gib", to_string(it.second.per_gib),
+			    it.second.per_gib != 0.0);
+	}
+
+	if (!xml.save(filename))
+	    throw runtime_error("saving commit time model failed");
+    }
+
+
+    CommitPlan::CommitPlan(const Actiongraph& actiongraph, const CommitTimeModel& model)
+	: actiongraph(actiongraph)
+    {
+	const Actiongraph::graph_t& graph = actiongraph.graph;
+
+	size_t n = num_vertices(graph);
+
+	keys.resize(n);
+	costs.resize(n);
+	tails.resize(n, 0.0);
+	critical.resize(n, false);
+
+	for (Actiongraph::vertex_descriptor v : actiongraph.vertices())
+	{
+	    keys[v] = CommitTimeModel::get_key(actiongraph, v);
+	    costs[v] = model.estimate(actiongraph, v);
+	}
+
+	// topological_sort delivers the vertices in reverse order so all
+	// successors are handled before a vertex
+	vector<Actiongraph::vertex_descriptor> reverse_order;
+	boost::topological_sort(graph, back_inserter(reverse_order));
+
+	for (Actiongraph::vertex_descriptor v : reverse_order)
+	{
+	    double tail = 0.0;
+
+	    for (Actiongraph::edge_descriptor e : boost::make_iterator_range(out_edges(v, graph)))
+		tail = max(tail, tails[target(e, graph)]);
+
+	    tails[v] = costs[v] + tail;
+	}
+
+	if (n == 0)
+	    return;
+
+	Actiongraph::vertex_descriptor v = *max_element(reverse_order.rbegin(), reverse_order.rend(),
+	    [this](Actiongraph::vertex_descriptor a, Actiongraph::vertex_descriptor b) {
+		return tails[a] < tails[b];
+	    });
+
+	while (true)
+	{
+	    critical_path.push_back(v);
+	    critical[v] = true;
+
+	    if (out_degree(v, graph) == 0)
+		break;
+
+	    Actiongraph::vertex_descriptor next = v;
+	    for (Actiongraph::edge_descriptor e : boost::make_iterator_range(out_edges(v, graph)))
+	    {
+		Actiongraph::vertex_descriptor t = target(e, graph);
+		if (next == v || tails[t] > tails[next])
+		    next = t;
+	    }
+
+	    v = next;
+	}
+    }
+
+
+    double
+    CommitPlan::get_serial_time() const
+    {
+	double ret = 0.0;
+
+	for (double cost : costs)
+	    ret += cost;
+
+	return ret;
+    }
+
+
+    double
+    CommitPlan::get_critical_path_time() const
+    {
+	return critical_path.empty() ? 0.0 : tails[critical_path.front()];
+    }
+
+
+    bool
+    CommitPlan::is_critical(Actiongraph::edge_descriptor e) const
+    {
+	Actiongraph::vertex_descriptor s = source(e, actiongraph.graph);
+	Actiongraph::vertex_descriptor t = target(e, actiongraph.graph);
+
+	if (!critical[s] || !critical[t])
+	    return false;
+
+	vector<Actiongraph::vertex_descriptor>::const_iterator it =
+	    find(critical_path.begin(), critical_path.end(), s);
+
+	return it + 1 != critical_path.end() && *(it + 1) == t;
+    }
+
+
+    double
+    CommitPlan::get_makespan(unsigned int workers) const
+    {
+	const Actiongraph::graph_t& graph = actiongraph.graph;
+
+	vector<size_t> pending(num_vertices(graph));
+	vector<Actiongraph::vertex_descriptor> ready;
+
+	for (Actiongraph::vertex_descriptor v : actiongraph.vertices())
+	{
+	    pending[v] = in_degree(v, graph);
+	    if (pending[v] == 0)
+		ready.push_back(v);
+	}
+
+	multimap<double, Actiongraph::vertex_descriptor> running;
+	double now = 0.0;
+
+	while (true)
+	{
+	    // start the ready actions with the longest remaining path first
+	    sort(ready.begin(), ready.end(), [this](Actiongraph::vertex_descriptor a,
+						    Actiongraph::vertex_descriptor b) {
+		return tails[a] > tails[b] || (tails[a] == tails[b] && a < b);
+	    });
+
+	    vector<Actiongraph::vertex_descriptor>::iterator it = ready.begin();
+	    for (; it != ready.end() && (workers == 0 || running.size() < workers); ++it)
+		running.emplace(now + costs[*it], *it);
+	    ready.erase(ready.begin(), it);
+
+	    if (running.empty())
+		break;
+
+	    now = running.begin()->first;
+	    Actiongraph::vertex_descriptor v = running.begin()->second;
+	    running.erase(running.begin());
+
+	    for (Actiongraph::edge_descriptor e : boost::make_iterator_range(out_edges(v, graph)))
+	    {
+		Actiongraph::vertex_descriptor t = target(e, graph);
+		if (--pending[t] == 0)
+		    ready.push_back(t);
+	    }
+	}
+
+	return now;
+    }
+
+
+    void
+    CommitPlan::write_json(std::ostream& out, unsigned int workers) const
+    {
+	const Actiongraph::graph_t& graph = actiongraph.graph;
+
+	out << "{\n"
+	    << "  \"workers\": " << workers << ",\n"
+	    << "  \"serial\": " << to_string(get_serial_time()) << ",\n"
+	    << "  \"makespan\": " << to_string(get_makespan(workers)) << ",\n"
+	    << "  \"critical-path-length\": " << to_string(get_critical_path_time()) << ",\n"
+	    << "  \"actions\": [";
+
+	bool first = true;
+
+	for (Actiongraph::vertex_descriptor v : actiongraph.vertices())
+	{
+	    out << (first ? "\n" : ",\n");
+	    first = false;
+
+	    out << "    { \"vertex\": " << v << ", \"sid\": " << graph[v]->sid
+		<< ", \"key\": " << json_quote(keys[v])
+		<< ", \"text\": " << json_quote(actiongraph.get_action_text(v, false).text)
+		<< ", \"cost\": " << to_string(costs[v])
+		<< ", \"critical\": " << (critical[v] ? "true" : "false")
+		<< ", \"predecessors\": [";
+
+	    bool first_predecessor = true;
+	    for (Actiongraph::edge_descriptor e : boost::make_iterator_range(in_edges(v, graph)))
+	    {
+		out << (first_predecessor ? "" : ", ") << source(e, graph);
+		first_predecessor = false;
+	    }
+
+	    out << "] }";
+	}
+
+	out << "\n  ],\n"
+	    << "  \"critical-path\": [";
+
+	for (vector<Actiongraph::vertex_descriptor>::const_iterator it = critical_path.begin();
+	     it != critical_path.end(); ++it)
+	    out << (it == critical_path.begin() ? "" : ", ") << *it;
+
+	out << "]\n"
+	    << "}\n";
+    }
+
+}
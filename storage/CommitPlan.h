@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#ifndef COMMIT_PLAN_H
+#define COMMIT_PLAN_H
+
+
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+
+#include "storage/Actiongraph.h"
+
+
+namespace storage
+{
+    using std::string;
+    using std::vector;
+    using std::map;
+
+
+    /**
+     * Model for the duration of actions. The cost of an action is base +
+     * per_gib * size of the device in GiB, in seconds. Costs are looked
+     * up by action and device class, e.g. "Create/Ext4", then by action
+     * class only, e.g. "Mount".
+     *
+     * The model can be calibrated from the durations measured during
+     * commits and saved to and loaded from a file.
+     */
+    class CommitTimeModel
+    {
+    public:
+
+	struct Cost
+	{
+	    Cost(double base = 0.0, double per_gib = 0.0) : base(base), per_gib(per_gib) {}
+
+	    double base;
+	    double per_gib;
+	};
+
+	CommitTimeModel();
+
+	void set_cost(const string& key, const Cost& cost) { costs[key] = cost; }
+	Cost get_cost(const string& key) const;
+
+	double estimate(const Actiongraph& actiongraph, Actiongraph::vertex_descriptor v) const;
+
+	/**
+	 * Adds the durations measured during the last commit of the
+	 * actiongraph as samples.
+	 */
+	void record(const Actiongraph& actiongraph);
+
+	/**
+	 * Fits the costs of all keys with samples to the samples.
+	 */
+	void calibrate();
+
+	void load(const string& filename);
+	void save(const string& filename) const;
+
+	static string get_key(const Actiongraph& actiongraph, Actiongraph::vertex_descriptor v);
+	static double get_size_gib(const Actiongraph& actiongraph, Actiongraph::vertex_descriptor v);
+
+    private:
+
+	map<string, Cost> costs;
+
+	// pairs of size in GiB and duration in seconds
+	map<string, vector<std::pair<double, double>>> samples;
+
+    };
+
+
+    /**
+     * Estimated costs of the actions of an actiongraph together with the
+     * critical path, i.e. the most expensive chain of dependent actions,
+     * and the expected duration when running actions in parallel.
+     */
+    class CommitPlan
+    {
+    public:
+
+	CommitPlan(const Actiongraph& actiongraph, const CommitTimeModel& model);
+
+	double get_cost(Actiongraph::vertex_descriptor v) const { return costs[v]; }
+
+	// duration when running all actions one after another
+	double get_serial_time() const;
+
+	const vector<Actiongraph::vertex_descriptor>& get_critical_path() const
+	    { return critical_path; }
+
+	double get_critical_path_time() const;
+
+	bool is_critical(Actiongraph::vertex_descriptor v) const { return critical[v]; }
+	bool is_critical(Actiongraph::edge_descriptor e) const;
+
+	/**
+	 * Expected duration with the given number of actions running in
+	 * parallel, zero means unlimited. Ready actions are started in the
+	 * order of their remaining critical path.
+	 */
+	double get_makespan(unsigned int workers) const;
+
+	void write_json(std::ostream& out, unsigned int workers) const;
+
+    private:
+
+	const Actiongraph& actiongraph;
+
+	vector<string> keys;
+	vector<double> costs;
+
+	// cost of the most expensive path starting with the action
+	vector<double> tails;
+
+	vector<Actiongraph::vertex_descriptor> critical_path;
+	vector<bool> critical;
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#include <unordered_map>
+#include <boost/algorithm/string.hpp>
+
+#include "storage/DeviceView.h"
+#include "storage/Devicegraph.h"
+#include "storage/SystemInfo/SystemInfo.h"
+#include "storage/Utils/AppUtil.h"
+#include "storage/Utils/StorageTmpl.h"
+
+
+namespace storage
+{
+    using namespace std;
+
+
+    namespace
+    {
+
+	class Interner
+	{
+	public:
+
+	    Interner(vector<string>& strings) : strings(strings) {}
+
+	    unsigned int intern(const string& s)
+	    {
+		unordered_map<string, unsigned int>::const_iterator it = ids.find(s);
+		if (it != ids.end())
+		    return it->second;
+
+		unsigned int id = strings.size();
+		strings.push_back(s);
+		ids[s] = id;
+		return id;
+	    }
+
+	private:
+
+	    vector<string>& strings;
+	    unordered_map<string, unsigned int> ids;
+
+	};
+
+
+	string
+	get_type(const string& kernel_name, const BlockSysfs::Entry& entry)
+	{
+	    if (!entry.disk.empty())
+		return "partition";
+
+	    if (!entry.dm_name.empty())
+	    {
+		if (boost::starts_with(entry.dm_uuid, "LVM-"))
+		    return "lvm_lv";
+		if (boost::starts_with(entry.dm_uuid, "CRYPT-"))
+		    return "encryption";
+		if (boost::starts_with(entry.dm_uuid, "mpath-"))
+		    return "multipath";
+		if (boost::starts_with(entry.dm_uuid, "DMRAID-"))
+		    return "dmraid";
+		if (boost::starts_with(entry.dm_uuid, "part"))
+		    return "partition";
+		return "dm";
+	    }
+
+	    if (boost::starts_with(kernel_name, "md"))
+		return "md";
+
+	    if (boost::starts_with(kernel_name, "loop"))
+		return "loop";
+
+	    return "disk";
+	}
+
+    }
+
+
+    DeviceView::DeviceView()
+    {
+	SystemInfo systeminfo;
+
+	const BlockSysfs& blocksysfs = systeminfo.getBlockSysfs();
+	const ProcMounts& procmounts = systeminfo.getProcMounts();
+
+	Interner interner(strings);
+
+	const size_t n = blocksysfs.size();
+
+	names.reserve(n);
+	types.reserve(n);
+	mountpoints.reserve(n);
+	sizes_k.reserve(n);
+
+	unordered_map<string, unsigned int> indices;
+
+	for (const BlockSysfs::value_type& it : blocksysfs)
+	{
+	    indices[it.first] = names.size();
+
+	    const string name = it.second.dm_name.empty() ? "/dev/" + it.first :
+		"/dev/mapper/" + it.second.dm_name;
+
+	    name_indices[name] = names.size();
+
+	    names.push_back(interner.intern(name));
+	    types.push_back(interner.intern(storage::get_type(it.first, it.second)));
+	    mountpoints.push_back(interner.intern(procmounts.getMount({ name, "/dev/" + it.first })));
+	    sizes_k.push_back(it.second.size_k);
+	}
+
+	// parents in CSR style, the children are counted on the way
+
+	vector<unsigned int> num_children(n, 0);
+
+	parent_offsets.reserve(n + 1);
+
+	for (const BlockSysfs::value_type& it : blocksysfs)
+	{
+	    parent_offsets.push_back(parents.size());
+
+	    list<string> tmp = it.second.slaves;
+	    if (!it.second.disk.empty())
+		tmp.push_front(it.second.disk);
+
+	    for (const string& parent : tmp)
+	    {
+		unordered_map<string, unsigned int>::const_iterator pos = indices.find(parent);
+		if (pos == indices.end())
+		{
+		    y2war("unknown parent " << parent << " of " << it.first);
+		    continue;
+		}
+
+		parents.push_back(pos->second);
+		++num_children[pos->second];
+	    }
+	}
+
+	parent_offsets.push_back(parents.size());
+
+	// children from the parents
+
+	child_offsets.resize(n + 1);
+	child_offsets[0] = 0;
+	for (size_t i = 0; i < n; ++i)
+	    child_offsets[i + 1] = child_offsets[i] + num_children[i];
+
+	children.resize(parents.size());
+
+	vector<unsigned int> next(child_offsets.begin(), child_offsets.end() - 1);
+	for (size_t i = 0; i < n; ++i)
+	    for (unsigned int j = parent_offsets[i]; j < parent_offsets[i + 1]; ++j)
+		children[next[parents[j]]++] = i;
+
+	y2mil("device view with " << n << " devices and " << strings.size() << " strings");
+    }
+
+
+    void
+    DeviceView::check_index(size_t index) const
+    {
+	if (index >= size())
+	    throw out_of_range("device index out of range");
+    }
+
+
+    const string&
+    DeviceView::get_name(size_t index) const
+    {
+	check_index(index);
+	return strings[names[index]];
+    }
+
+
+    const string&
+    DeviceView::get_type(size_t index) const
+    {
+	check_index(index);
+	return strings[types[index]];
+    }
+
+
+    unsigned long long
+    DeviceView::get_size_k(size_t index) const
+    {
+	check_index(index);
+	return sizes_k[index];
+    }
+
+
+    const string&
+    DeviceView::get_mountpoint(size_t index) const
+    {
+	check_index(index);
+	return strings[mountpoints[index]];
+    }
+
+
+    vector<size_t>
+    DeviceView::get_parents(size_t index) const
+    {
+	check_index(index);
+	return vector<size_t>(parents.begin() + parent_offsets[index],
+			      parents.begin() + parent_offsets[index + 1]);
+    }
+
+
+    vector<size_t>
+    DeviceView::get_children(size_t index) const
+    {
+	check_index(index);
+	return vector<size_t>(children.begin() + child_offsets[index],
+			      children.begin() + child_offsets[index + 1]);
+    }
+
+
+    size_t
+    DeviceView::find(const string& name) const
+    {
+	unordered_map<string, unsigned int>::const_iterator it = name_indices.find(name);
+	if (it != name_indices.end())
+	    return it->second;
+
+	throw DeviceNotFound("device not found, name:" + name);
+    }
+
+
+    std::ostream&
+    operator<<(std::ostream& out, const DeviceView& device_view)
+    {
+	for (size_t i = 0; i < device_view.size(); ++i)
+	{
+	    out << device_view.get_name(i) << " type:" << device_view.get_type(i)
+		<< " size_k:" << device_view.get_size_k(i);
+
+	    if (!device_view.get_mountpoint(i).empty())
+		out << " mountpoint:" << device_view.get_mountpoint(i);
+
+	    vector<size_t> parents = device_view.get_parents(i);
+	    if (!parents.empty())
+	    {
+		out << " parents:";
+		for (size_t j = 0; j < parents.size(); ++j)
+		    out << (j == 0 ? "" : ",") << device_view.get_name(parents[j]);
+	    }
+
+	    out << endl;
+	}
+
+	return out;
+    }
+
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#ifndef DEVICE_VIEW_H
+#define DEVICE_VIEW_H
+
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <ostream>
+
+
+namespace storage
+{
+
+    /**
+     * A compact read-only view of the block devices of the system, e.g. for
+     * monitoring. It is built directly from sysfs and /proc/mounts without
+     * a Storage object, so no devices or holders are created, no staging
+     * devicegraph is copied and the architecture is not probed.
+     *
+     * The devices are addressed by their index. All data is stored in
+     * columns, the strings are interned and the parents and children of
+     * device i are stored in CSR style like in DevicegraphTable.
+     *
+     * The type is one of "disk", "partition", "md", "loop", "lvm_lv",
+     * "encryption", "multipath", "dmraid" and "dm".
+     */
+    class DeviceView
+    {
+    public:
+
+	/**
+	 * Probes the system. Like the probe of Storage it uses the mockup
+	 * if one is loaded.
+	 */
+	DeviceView();
+
+	size_t size() const { return names.size(); }
+
+	const std::string& get_name(size_t index) const;
+	const std::string& get_type(size_t index) const;
+	unsigned long long get_size_k(size_t index) const;
+
+	/**
+	 * Empty if the device is not mounted, "swap" for active swap.
+	 */
+	const std::string& get_mountpoint(size_t index) const;
+
+	std::vector<size_t> get_parents(size_t index) const;
+	std::vector<size_t> get_children(size_t index) const;
+
+	/**
+	 * Returns the index of the device with the name, e.g. "/dev/sda1" or
+	 * "/dev/mapper/system-root". Throws DeviceNotFound.
+	 */
+	size_t find(const std::string& name) const;
+
+	friend std::ostream& operator<<(std::ostream& out, const DeviceView& device_view);
+
+    private:
+
+	void check_index(size_t index) const;
+
+	std::vector<std::string> strings;
+
+	// indices into strings
+	std::vector<unsigned int> names;
+	std::vector<unsigned int> types;
+	std::vector<unsigned int> mountpoints;
+
+	std::vector<unsigned long long> sizes_k;
+
+	std::vector<unsigned int> parent_offsets;
+	std::vector<unsigned int> parents;
+	std::vector<unsigned int> child_offsets;
+	std::vector<unsigned int> children;
+
+	// index of the devices by name for find()
+	std::unordered_map<std::string, unsigned int> name_indices;
+
+    };
+
+}
+
+#endif
@@ -11,13 +11,14 @@
 #include "storage/Devices/BlkDevice.h"
 #include "storage/Devices/Disk.h"
 #include "storage/Devices/Partition.h"
-#include "storage/Devices/PartitionTable.h"
+#include "storage/Devices/PartitionTableImpl.h"
 #include "storage/Devices/LvmVg.h"
 #include "storage/Devices/LvmLv.h"
 #include "storage/Devices/Encryption.h"
 #include "storage/Devices/Filesystem.h"
 #include "storage/Holders/HolderImpl.h"
 #include "storage/Utils/AppUtil.h"
+#include "storage/Utils/JsonParser.h"
 
 
 namespace storage
@@ -276,10 +277,47 @@ namespace storage
     }
 
 
+    void
+    Devicegraph::set_checkpoint(const string& name)
+    {
+	get_impl().journal.set_checkpoint(name);
+    }
+
+
+    bool
+    Devicegraph::has_checkpoint(const string& name) const
+    {
+	return get_impl().journal.has_checkpoint(name);
+    }
+
+
+    void
+    Devicegraph::restore_checkpoint(const string& name)
+    {
+	get_impl().journal.restore_checkpoint(this, name);
+
+	// partitions may have changed without notifying their partition table
+	for (Impl::vertex_descriptor vertex : get_impl().vertices())
+	{
+	    const PartitionTable* partitiontable =
+		dynamic_cast<const PartitionTable*>(get_impl().graph[vertex].get());
+	    if (partitiontable)
+		partitiontable->get_impl().invalidate_free_space();
+	}
+    }
+
+
+    void
+    Devicegraph::clear_checkpoints()
+    {
+	get_impl().journal.clear();
+    }
+
+
     void
     Devicegraph::copy(Devicegraph& dest) const
     {
-	dest.get_impl().graph.clear();
+	dest.get_impl().clear();
 
 	Haha<Impl::graph_t> haha(get_impl().graph);
 
@@ -290,6 +328,144 @@ namespace storage
     }
 
 
+    vector<sid_t>
+    Devicegraph::get_sids() const
+    {
+	vector<sid_t> ret;
+	ret.reserve(num_devices());
+
+	for (Devicegraph::Impl::vertex_descriptor vertex : get_impl().vertices())
+	    ret.push_back(get_impl().graph[vertex]->get_sid());
+
+	return ret;
+    }
+
+
+    vector<sid_t>
+    Devicegraph::get_children_sids(sid_t sid) const
+    {
+	Devicegraph::Impl::vertex_descriptor vertex = get_impl().find_vertex(sid);
+
+	vector<sid_t> ret;
+
+	for (Devicegraph::Impl::vertex_descriptor child : get_impl().children(vertex))
+	    ret.push_back(get_impl().graph[child]->get_sid());
+
+	return ret;
+    }
+
+
+    vector<sid_t>
+    Devicegraph::get_parent_sids(sid_t sid) const
+    {
+	Devicegraph::Impl::vertex_descriptor vertex = get_impl().find_vertex(sid);
+
+	vector<sid_t> ret;
+
+	for (Devicegraph::Impl::vertex_descriptor parent : get_impl().parents(vertex))
+	    ret.push_back(get_impl().graph[parent]->get_sid());
+
+	return ret;
+    }
+
+
+    DevicegraphTable
+    Devicegraph::get_table() const
+    {
+	DevicegraphTable table;
+
+	const size_t n = num_devices();
+
+	table.sids.reserve(n);
+	table.classnames.reserve(n);
+	table.names.reserve(n);
+	table.sizes_k.reserve(n);
+	table.parent_offsets.reserve(n + 1);
+	table.parent_sids.reserve(num_holders());
+	table.child_offsets.reserve(n + 1);
+	table.child_sids.reserve(num_holders());
+
+	for (Devicegraph::Impl::vertex_descriptor vertex : get_impl().vertices())
+	{
+	    const Device* device = get_impl().graph[vertex].get();
+
+	    table.sids.push_back(device->get_sid());
+	    table.classnames.push_back(device->get_impl().get_classname());
+
+	    const BlkDevice* blkdevice = dynamic_cast<const BlkDevice*>(device);
+	    table.names.push_back(blkdevice ? blkdevice->get_name() : "");
+	    table.sizes_k.push_back(blkdevice ? blkdevice->get_size_k() : 0);
+
+	    table.parent_offsets.push_back(table.parent_sids.size());
+	    for (Devicegraph::Impl::vertex_descriptor parent : get_impl().parents(vertex))
+		table.parent_sids.push_back(get_impl().graph[parent]->get_sid());
+
+	    table.child_offsets.push_back(table.child_sids.size());
+	    for (Devicegraph::Impl::vertex_descriptor child : get_impl().children(vertex))
+		table.child_sids.push_back(get_impl().graph[child]->get_sid());
+	}
+
+	table.parent_offsets.push_back(table.parent_sids.size());
+	table.child_offsets.push_back(table.child_sids.size());
+
+	return table;
+    }
+
+
+    namespace
+    {
+	template <typename Type>
+	void
+	write_json_array(ostream& out, const char* key, const vector<Type>& values)
+	{
+	    out << "\"" << key << "\":[";
+	    for (size_t i = 0; i < values.size(); ++i)
+		out << (i == 0 ? "" : ",") << values[i];
+	    out << "]";
+	}
+
+
+	void
+	write_json_array(ostream& out, const char* key, const vector<string>& values)
+	{
+	    out << "\"" << key << "\":[";
+	    for (size_t i = 0; i < values.size(); ++i)
+		out << (i == 0 ? "" : ",") << json_quote(values[i]);
+	    out << "]";
+	}
+    }
+
+
+    string
+    Devicegraph::get_table_json() const
+    {
+	const DevicegraphTable table = get_table();
+
+	ostringstream out;
+	classic(out);
+
+	out << "{";
+	write_json_array(out, "sids", table.sids);
+	out << ",";
+	write_json_array(out, "classnames", table.classnames);
+	out << ",";
+	write_json_array(out, "names", table.names);
+	out << ",";
+	write_json_array(out, "sizes_k", table.sizes_k);
+	out << ",";
+	write_json_array(out, "parent_offsets", table.parent_offsets);
+	out << ",";
+	write_json_array(out, "parent_sids", table.parent_sids);
+	out << ",";
+	write_json_array(out, "child_offsets", table.child_offsets);
+	out << ",";
+	write_json_array(out, "child_sids", table.child_sids);
+	out << "}";
+
+	return out.str();
+    }
+
+
     std::ostream&
     operator<<(std::ostream& out, const Devicegraph& devicegraph)
     {
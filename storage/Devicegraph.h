@@ -27,6 +27,31 @@ namespace storage
     };
 
 
+    /**
+     * All devices of a devicegraph in columns, entry i of each vector
+     * belongs to the same device. The parents of device i are
+     * parent_sids[parent_offsets[i]] up to but excluding
+     * parent_sids[parent_offsets[i + 1]], likewise for the children. Name
+     * and size are empty resp. 0 for devices that are no block devices.
+     *
+     * Lets the bindings read a whole devicegraph with a few calls instead
+     * of creating a wrapper object per device.
+     */
+    struct DevicegraphTable
+    {
+	size_t size() const { return sids.size(); }
+
+	std::vector<sid_t> sids;
+	std::vector<std::string> classnames;
+	std::vector<std::string> names;
+	std::vector<unsigned long long> sizes_k;
+	std::vector<size_t> parent_offsets;
+	std::vector<sid_t> parent_sids;
+	std::vector<size_t> child_offsets;
+	std::vector<sid_t> child_sids;
+    };
+
+
     class Devicegraph : private boost::noncopyable
     {
 
@@ -48,6 +73,25 @@ namespace storage
 	size_t num_devices() const;
 	size_t num_holders() const;
 
+	/**
+	 * Returns the sids of all devices. Together with the functions
+	 * taking a sid this allows to walk the devicegraph without wrapper
+	 * objects. Each of these functions looks up the sid in linear time,
+	 * to walk the whole devicegraph use get_table() instead.
+	 */
+	std::vector<sid_t> get_sids() const;
+
+	std::vector<sid_t> get_children_sids(sid_t sid) const;
+	std::vector<sid_t> get_parent_sids(sid_t sid) const;
+
+	DevicegraphTable get_table() const;
+
+	/**
+	 * Returns the table as a JSON object with one array per column, e.g.
+	 * for json.loads() in Python.
+	 */
+	std::string get_table_json() const;
+
 	Device* find_device(sid_t sid);
 	const Device* find_device(sid_t sid) const;
 
@@ -63,6 +107,25 @@ namespace storage
 
 	void check() const;
 
+	/**
+	 * Sets a named checkpoint. From the first checkpoint on all changes
+	 * to the devicegraph are recorded in a journal.
+	 */
+	void set_checkpoint(const std::string& name);
+
+	bool has_checkpoint(const std::string& name) const;
+
+	/**
+	 * Undoes or redoes the recorded changes to get back to the state of
+	 * the checkpoint. Only the changes in between are processed.
+	 */
+	void restore_checkpoint(const std::string& name);
+
+	/**
+	 * Removes all checkpoints and the journal.
+	 */
+	void clear_checkpoints();
+
 	// TODO move to Impl
 	void copy(Devicegraph& dest) const;
 
@@ -14,7 +14,7 @@
 #include "storage/Devices/Msdos.h"
 #include "storage/Devices/Gpt.h"
 #include "storage/Devices/Partition.h"
-#include "storage/Devices/PartitionTable.h"
+#include "storage/Devices/PartitionTableImpl.h"
 #include "storage/Devices/LvmVg.h"
 #include "storage/Devices/LvmLv.h"
 #include "storage/Devices/Encryption.h"
@@ -27,6 +27,9 @@
 #include "storage/Holders/Subdevice.h"
 #include "storage/Utils/XmlFile.h"
 #include "storage/Utils/StorageTmpl.h"
+#include "storage/SystemInfo/Arch.h"
+#include "storage/Storage.h"
+#include "storage/Environment.h"
 
 
 namespace storage
@@ -195,12 +198,33 @@ namespace storage
     Devicegraph::Impl::clear()
     {
 	graph.clear();
+	journal.clear();
     }
 
 
     void
     Devicegraph::Impl::remove_vertex(vertex_descriptor vertex)
     {
+	if (journal.is_recording())
+	{
+	    for (edge_descriptor edge : boost::make_iterator_range(boost::in_edges(vertex, graph)))
+		journal.record_remove_holder(graph[edge], graph[source(edge, graph)]->get_sid(),
+					     graph[target(edge, graph)]->get_sid());
+
+	    for (edge_descriptor edge : boost::make_iterator_range(boost::out_edges(vertex, graph)))
+		journal.record_remove_holder(graph[edge], graph[source(edge, graph)]->get_sid(),
+					     graph[target(edge, graph)]->get_sid());
+
+	    journal.record_remove_device(graph[vertex]);
+	}
+
+	for (vertex_descriptor parent : parents(vertex))
+	{
+	    const PartitionTable* partitiontable = dynamic_cast<const PartitionTable*>(graph[parent].get());
+	    if (partitiontable)
+		partitiontable->get_impl().remove_free_space(graph[vertex]->get_sid());
+	}
+
 	boost::clear_vertex(vertex, graph);
 	boost::remove_vertex(vertex, graph);
     }
@@ -210,6 +234,30 @@ namespace storage
     Devicegraph::Impl::swap(Devicegraph::Impl& x)
     {
 	graph.swap(x.graph);
+	journal.swap(x.journal);
+    }
+
+
+    const Environment*
+    Devicegraph::Impl::get_environment() const
+    {
+	return storage ? &storage->get_environment() : frozen_environment.get();
+    }
+
+
+    const Arch*
+    Devicegraph::Impl::get_arch() const
+    {
+	return storage ? &storage->get_arch() : frozen_arch.get();
+    }
+
+
+    void
+    Devicegraph::Impl::freeze(const Environment& environment, const Arch& arch)
+    {
+	frozen_environment = std::make_shared<Environment>(environment);
+	frozen_arch = std::make_shared<Arch>(arch);
+	storage = nullptr;
     }
 
 
@@ -10,6 +10,7 @@
 #include "storage/Devices/BlkDevice.h"
 #include "storage/Holders/Holder.h"
 #include "storage/Devicegraph.h"
+#include "storage/DevicegraphJournal.h"
 
 
 namespace storage
@@ -19,6 +20,10 @@ namespace storage
     using std::pair;
 
 
+    class Environment;
+    class Arch;
+
+
     class Devicegraph::Impl : private boost::noncopyable
     {
 
@@ -146,12 +151,32 @@ namespace storage
 
 	const Storage* get_storage() const { return storage; }
 
+	/**
+	 * The environment and arch of the storage object or, for frozen
+	 * devicegraphs, the copies made by freeze(). nullptr if the
+	 * devicegraph has neither.
+	 */
+	const Environment* get_environment() const;
+	const Arch* get_arch() const;
+
+	/**
+	 * Detaches the devicegraph from its storage object so that it can
+	 * outlive it, used for snapshots. Afterwards get_storage() returns
+	 * nullptr.
+	 */
+	void freeze(const Environment& environment, const Arch& arch);
+
 	graph_t graph;
 
+	DevicegraphJournal journal;
+
     private:
 
 	const Storage* storage;
 
+	std::shared_ptr<const Environment> frozen_environment;
+	std::shared_ptr<const Arch> frozen_arch;
+
     };
 
 }
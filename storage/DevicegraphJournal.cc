@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#include "storage/DevicegraphJournal.h"
+#include "storage/DevicegraphImpl.h"
+#include "storage/Devices/DeviceImpl.h"
+#include "storage/Holders/HolderImpl.h"
+
+
+namespace storage
+{
+
+    void
+    DevicegraphJournal::record_add_device(const shared_ptr<Device>& device)
+    {
+	Entry entry(Entry::ADD_DEVICE);
+	entry.device = device;
+	entry.sid = device->get_sid();
+	add(entry);
+    }
+
+
+    void
+    DevicegraphJournal::record_remove_device(const shared_ptr<Device>& device)
+    {
+	Entry entry(Entry::REMOVE_DEVICE);
+	entry.device = device;
+	entry.sid = device->get_sid();
+	add(entry);
+    }
+
+
+    void
+    DevicegraphJournal::record_add_holder(const shared_ptr<Holder>& holder, sid_t source_sid,
+					  sid_t target_sid)
+    {
+	Entry entry(Entry::ADD_HOLDER);
+	entry.holder = holder;
+	entry.source_sid = source_sid;
+	entry.target_sid = target_sid;
+	add(entry);
+    }
+
+
+    void
+    DevicegraphJournal::record_remove_holder(const shared_ptr<Holder>& holder, sid_t source_sid,
+					     sid_t target_sid)
+    {
+	Entry entry(Entry::REMOVE_HOLDER);
+	entry.holder = holder;
+	entry.source_sid = source_sid;
+	entry.target_sid = target_sid;
+	add(entry);
+    }
+
+
+    void
+    DevicegraphJournal::record_modify_device(sid_t sid, const shared_ptr<Device::Impl>& impl)
+    {
+	Entry entry(Entry::MODIFY_DEVICE);
+	entry.sid = sid;
+	entry.impl = impl;
+	add(entry);
+    }
+
+
+    void
+    DevicegraphJournal::add(const Entry& entry)
+    {
+	if (position < entries.size())
+	{
+	    // drop the changes that could be redone so far
+
+	    entries.erase(entries.begin() + position, entries.end());
+
+	    for (map<string, size_t>::iterator it = checkpoints.begin(); it != checkpoints.end(); )
+	    {
+		if (it->second > position)
+		    it = checkpoints.erase(it);
+		else
+		    ++it;
+	    }
+	}
+
+	entries.push_back(entry);
+	position = entries.size();
+    }
+
+
+    void
+    DevicegraphJournal::set_checkpoint(const string& name)
+    {
+	checkpoints[name] = position;
+    }
+
+
+    bool
+    DevicegraphJournal::has_checkpoint(const string& name) const
+    {
+	return checkpoints.find(name) != checkpoints.end();
+    }
+
+
+    void
+    DevicegraphJournal::restore_checkpoint(Devicegraph* devicegraph, const string& name)
+    {
+	map<string, size_t>::const_iterator it = checkpoints.find(name);
+	if (it == checkpoints.end())
+	    throw runtime_error("checkpoint not found");
+
+	size_t target = it->second;
+
+	replaying = true;
+
+	try
+	{
+	    while (position > target)
+		undo(devicegraph, entries[--position]);
+
+	    while (position < target)
+		redo(devicegraph, entries[position++]);
+	}
+	catch (...)
+	{
+	    replaying = false;
+	    throw;
+	}
+
+	replaying = false;
+    }
+
+
+    void
+    DevicegraphJournal::clear()
+    {
+	entries.clear();
+	position = 0;
+	checkpoints.clear();
+    }
+
+
+    void
+    DevicegraphJournal::swap(DevicegraphJournal& x)
+    {
+	entries.swap(x.entries);
+	std::swap(position, x.position);
+	checkpoints.swap(x.checkpoints);
+    }
+
+
+    void
+    DevicegraphJournal::undo(Devicegraph* devicegraph, Entry& entry)
+    {
+	switch (entry.type)
+	{
+	    case Entry::ADD_DEVICE:
+		remove_device(devicegraph, entry);
+		break;
+
+	    case Entry::REMOVE_DEVICE:
+		add_device(devicegraph, entry);
+		break;
+
+	    case Entry::ADD_HOLDER:
+		remove_holder(devicegraph, entry);
+		break;
+
+	    case Entry::REMOVE_HOLDER:
+		add_holder(devicegraph, entry);
+		break;
+
+	    case Entry::MODIFY_DEVICE:
+		swap_device(devicegraph, entry);
+		break;
+	}
+    }
+
+
+    void
+    DevicegraphJournal::redo(Devicegraph* devicegraph, Entry& entry)
+    {
+	switch (entry.type)
+	{
+	    case Entry::ADD_DEVICE:
+		add_device(devicegraph, entry);
+		break;
+
+	    case Entry::REMOVE_DEVICE:
+		remove_device(devicegraph, entry);
+		break;
+
+	    case Entry::ADD_HOLDER:
+		add_holder(devicegraph, entry);
+		break;
+
+	    case Entry::REMOVE_HOLDER:
+		remove_holder(devicegraph, entry);
+		break;
+
+	    case Entry::MODIFY_DEVICE:
+		swap_device(devicegraph, entry);
+		break;
+	}
+    }
+
+
+    void
+    DevicegraphJournal::add_device(Devicegraph* devicegraph, Entry& entry)
+    {
+	Devicegraph::Impl::vertex_descriptor vertex =
+	    boost::add_vertex(entry.device, devicegraph->get_impl().graph);
+
+	entry.device->get_impl().set_devicegraph_and_vertex(devicegraph, vertex);
+    }
+
+
+    void
+    DevicegraphJournal::remove_device(Devicegraph* devicegraph, Entry& entry)
+    {
+	// all holders of the device are already removed since changes are
+	// undone and redone in order
+	Devicegraph::Impl::vertex_descriptor vertex = devicegraph->get_impl().find_vertex(entry.sid);
+	boost::remove_vertex(vertex, devicegraph->get_impl().graph);
+    }
+
+
+    void
+    DevicegraphJournal::add_holder(Devicegraph* devicegraph, Entry& entry)
+    {
+	Devicegraph::Impl& impl = devicegraph->get_impl();
+
+	pair<Devicegraph::Impl::edge_descriptor, bool> tmp =
+	    boost::add_edge(impl.find_vertex(entry.source_sid), impl.find_vertex(entry.target_sid),
+			    entry.holder, impl.graph);
+
+	if (!tmp.second)
+	    throw logic_error("holder already exists");
+
+	entry.holder->get_impl().set_devicegraph_and_edge(devicegraph, tmp.first);
+    }
+
+
+    void
+    DevicegraphJournal::remove_holder(Devicegraph* devicegraph, Entry& entry)
+    {
+	Devicegraph::Impl& impl = devicegraph->get_impl();
+
+	Devicegraph::Impl::edge_descriptor edge = impl.find_edge(entry.source_sid, entry.target_sid);
+	boost::remove_edge(edge, impl.graph);
+    }
+
+
+    void
+    DevicegraphJournal::swap_device(Devicegraph* devicegraph, Entry& entry)
+    {
+	Devicegraph::Impl::vertex_descriptor vertex = devicegraph->get_impl().find_vertex(entry.sid);
+
+	Device* device = devicegraph->get_impl().graph[vertex].get();
+	device->swap_impl(entry.impl);
+	device->get_impl().set_devicegraph_and_vertex(devicegraph, vertex);
+    }
+
+}
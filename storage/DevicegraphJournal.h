@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#ifndef DEVICEGRAPH_JOURNAL_H
+#define DEVICEGRAPH_JOURNAL_H
+
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <boost/noncopyable.hpp>
+
+#include "storage/Devices/Device.h"
+#include "storage/Holders/Holder.h"
+
+
+namespace storage
+{
+    using std::string;
+    using std::vector;
+    using std::map;
+    using std::shared_ptr;
+
+
+    /**
+     * Records the changes of a devicegraph so that it can be moved back and
+     * forth between named checkpoints without copying the devicegraph.
+     *
+     * Nothing is recorded until the first checkpoint is set. Devices and
+     * holders are kept alive by the journal, so after undoing and redoing a
+     * change the original objects are back in the devicegraph. A modified
+     * device is recorded with a clone of its state before the modification.
+     *
+     * Recording a change after restoring an older checkpoint discards all
+     * changes and checkpoints after it.
+     */
+    class DevicegraphJournal : private boost::noncopyable
+    {
+    public:
+
+	DevicegraphJournal() : position(0), replaying(false) {}
+
+	bool is_recording() const { return !checkpoints.empty() && !replaying; }
+
+	void record_add_device(const shared_ptr<Device>& device);
+	void record_remove_device(const shared_ptr<Device>& device);
+	void record_add_holder(const shared_ptr<Holder>& holder, sid_t source_sid,
+			       sid_t target_sid);
+	void record_remove_holder(const shared_ptr<Holder>& holder, sid_t source_sid,
+				  sid_t target_sid);
+	void record_modify_device(sid_t sid, const shared_ptr<Device::Impl>& impl);
+
+	void set_checkpoint(const string& name);
+	bool has_checkpoint(const string& name) const;
+	void restore_checkpoint(Devicegraph* devicegraph, const string& name);
+
+	size_t num_entries() const { return entries.size(); }
+
+	void clear();
+
+	void swap(DevicegraphJournal& x);
+
+    private:
+
+	struct Entry
+	{
+	    enum Type { ADD_DEVICE, REMOVE_DEVICE, ADD_HOLDER, REMOVE_HOLDER, MODIFY_DEVICE };
+
+	    Entry(Type type) : type(type), sid(0), source_sid(0), target_sid(0) {}
+
+	    Type type;
+
+	    shared_ptr<Device> device;
+	    shared_ptr<Device::Impl> impl;
+	    shared_ptr<Holder> holder;
+
+	    sid_t sid;
+	    sid_t source_sid;
+	    sid_t target_sid;
+	};
+
+	void add(const Entry& entry);
+
+	void undo(Devicegraph* devicegraph, Entry& entry);
+	void redo(Devicegraph* devicegraph, Entry& entry);
+
+	void add_device(Devicegraph* devicegraph, Entry& entry);
+	void remove_device(Devicegraph* devicegraph, Entry& entry);
+	void add_holder(Devicegraph* devicegraph, Entry& entry);
+	void remove_holder(Devicegraph* devicegraph, Entry& entry);
+	void swap_device(Devicegraph* devicegraph, Entry& entry);
+
+	vector<Entry> entries;
+
+	// number of entries currently applied to the devicegraph
+	size_t position;
+
+	map<string, size_t> checkpoints;
+
+	bool replaying;
+
+    };
+
+}
+
+
+#endif
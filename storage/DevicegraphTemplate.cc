@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#include <string.h>
+#include <boost/algorithm/string.hpp>
+
+#include "storage/DevicegraphTemplate.h"
+#include "storage/DevicegraphImpl.h"
+#include "storage/Devices/DiskImpl.h"
+#include "storage/Devices/PartitionImpl.h"
+#include "storage/Devices/PartitionTableImpl.h"
+#include "storage/Devices/LvmVgImpl.h"
+#include "storage/Holders/HolderImpl.h"
+#include "storage/Utils/AppUtil.h"
+
+
+namespace storage
+{
+    using namespace std;
+
+
+    DevicegraphTemplate::DevicegraphTemplate(const Device* root)
+	: root_classname(root->get_impl().get_classname())
+    {
+	const Devicegraph* devicegraph = root->get_impl().get_devicegraph();
+	const Devicegraph::Impl& impl = devicegraph->get_impl();
+
+	Devicegraph::Impl::vertex_descriptor root_vertex = root->get_impl().get_vertex();
+
+	vector<Devicegraph::Impl::vertex_descriptor> vertices = impl.descendants(root_vertex, false);
+
+	map<Devicegraph::Impl::vertex_descriptor, size_t> indices;
+	indices[root_vertex] = npos;
+
+	devices.reserve(vertices.size());
+
+	for (Devicegraph::Impl::vertex_descriptor vertex : vertices)
+	{
+	    indices[vertex] = devices.size();
+	    devices.emplace_back(impl.graph[vertex]->clone());
+	}
+
+	for (Devicegraph::Impl::vertex_descriptor vertex : vertices)
+	{
+	    for (Devicegraph::Impl::edge_descriptor edge :
+		     boost::make_iterator_range(in_edges(vertex, impl.graph)))
+	    {
+		map<Devicegraph::Impl::vertex_descriptor, size_t>::const_iterator it =
+		    indices.find(source(edge, impl.graph));
+		if (it == indices.end())
+		    throw runtime_error("device " + impl.graph[vertex]->get_displayname() +
+					" has a parent outside of the template");
+
+		holders.push_back({ it->second, indices[vertex],
+				    shared_ptr<const Holder>(impl.graph[edge]->clone()) });
+	    }
+	}
+
+	y2mil("template of " << root->get_displayname() << " with " << devices.size() <<
+	      " devices and " << holders.size() << " holders");
+    }
+
+
+    DevicegraphTemplate::~DevicegraphTemplate()
+    {
+    }
+
+
+    string
+    DevicegraphTemplate::rename(const Device* device, const Device* target) const
+    {
+	const Partition* partition = dynamic_cast<const Partition*>(device);
+	if (partition)
+	{
+	    const Disk* disk = dynamic_cast<const Disk*>(target);
+	    if (!disk)
+		throw runtime_error("partitions need a disk as target");
+
+	    return disk->get_impl().partition_name(partition->get_number());
+	}
+
+	const BlkDevice* blkdevice = dynamic_cast<const BlkDevice*>(target);
+	string basename = blkdevice ? blkdevice->get_name() : to_string(target->get_sid());
+	basename = basename.substr(basename.rfind('/') + 1);
+
+	blkdevice = dynamic_cast<const BlkDevice*>(device);
+	if (blkdevice)
+	    return boost::replace_all_copy(blkdevice->get_name(), "@", basename);
+
+	const LvmVg* lvm_vg = dynamic_cast<const LvmVg*>(device);
+	if (lvm_vg)
+	    return boost::replace_all_copy(lvm_vg->get_name(), "@", basename);
+
+	return "";
+    }
+
+
+    void
+    DevicegraphTemplate::instantiate(Devicegraph* devicegraph,
+				     const vector<const Device*>& targets) const
+    {
+	Devicegraph::Impl& impl = devicegraph->get_impl();
+
+	for (const Device* target : targets)
+	{
+	    if (target->get_impl().get_devicegraph() != devicegraph)
+		throw runtime_error("target " + target->get_displayname() + " in wrong devicegraph");
+
+	    if (strcmp(target->get_impl().get_classname(), root_classname.c_str()) != 0)
+		throw runtime_error("target " + target->get_displayname() + " is no " +
+				    root_classname);
+	}
+
+	const bool recording = impl.journal.is_recording();
+
+	sid_t sid = Device::Impl::allocate_sids(devices.size() * targets.size());
+
+	vector<Devicegraph::Impl::vertex_descriptor> vertices(devices.size());
+
+	for (const Device* target : targets)
+	{
+	    for (size_t i = 0; i < devices.size(); ++i)
+	    {
+		Device* device = devices[i]->clone();
+		device->get_impl().set_sid(sid++);
+
+		const string name = rename(devices[i].get(), target);
+		if (!name.empty())
+		{
+		    if (dynamic_cast<BlkDevice*>(device))
+			dynamic_cast<BlkDevice*>(device)->get_impl().set_name(name);
+		    else if (dynamic_cast<LvmVg*>(device))
+			dynamic_cast<LvmVg*>(device)->get_impl().set_name(name);
+		}
+
+		vertices[i] = boost::add_vertex(shared_ptr<Device>(device), impl.graph);
+		device->get_impl().set_devicegraph_and_vertex(devicegraph, vertices[i]);
+
+		// the cached free space refers to the sids of the template
+		PartitionTable* partition_table = dynamic_cast<PartitionTable*>(device);
+		if (partition_table)
+		    partition_table->get_impl().invalidate_free_space();
+
+		if (recording)
+		    impl.journal.record_add_device(impl.graph[vertices[i]]);
+	    }
+
+	    for (const HolderEntry& entry : holders)
+	    {
+		Devicegraph::Impl::vertex_descriptor source = entry.source == npos ?
+		    target->get_impl().get_vertex() : vertices[entry.source];
+		Devicegraph::Impl::vertex_descriptor target_vertex = vertices[entry.target];
+
+		Holder* holder = entry.holder->clone();
+
+		pair<Devicegraph::Impl::edge_descriptor, bool> tmp =
+		    boost::add_edge(source, target_vertex, shared_ptr<Holder>(holder), impl.graph);
+		if (!tmp.second)
+		    throw runtime_error("holder already exists");
+
+		holder->get_impl().set_devicegraph_and_edge(devicegraph, tmp.first);
+
+		if (recording)
+		    impl.journal.record_add_holder(impl.graph[tmp.first], impl.graph[source]->get_sid(),
+						   impl.graph[target_vertex]->get_sid());
+	    }
+	}
+
+	y2mil("instantiated template on " << targets.size() << " targets");
+    }
+
+}
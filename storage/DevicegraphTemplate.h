@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#ifndef DEVICEGRAPH_TEMPLATE_H
+#define DEVICEGRAPH_TEMPLATE_H
+
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "storage/Devices/Device.h"
+
+
+namespace storage
+{
+
+    class Devicegraph;
+    class Holder;
+
+
+    /**
+     * A copy of all devices below a root device, e.g. the partition
+     * table, partitions, filesystems and LVM of a disk, that can be
+     * stamped onto many devices of the same class.
+     *
+     * The copies get new sids, reserved in one block per call. Partitions
+     * are renamed after the target disk, e.g. /dev/sda2 becomes
+     * /dev/nvme0n1p2. In the names of other block devices and volume
+     * groups the placeholder "@" is replaced by the last component of the
+     * name of the target, e.g. /dev/vg-@/root becomes /dev/vg-sdb/root.
+     */
+    class DevicegraphTemplate
+    {
+    public:
+
+	/**
+	 * Captures the descendants of root and the holders between them.
+	 * All parents of the descendants must be root or descendants
+	 * themselves, otherwise runtime_error is thrown.
+	 */
+	DevicegraphTemplate(const Device* root);
+	~DevicegraphTemplate();
+
+	size_t num_devices() const { return devices.size(); }
+	size_t num_holders() const { return holders.size(); }
+
+	/**
+	 * Adds a copy of the captured devices below every target. The
+	 * targets must be in devicegraph and of the class of root. The
+	 * devicegraph may be the one of root.
+	 */
+	void instantiate(Devicegraph* devicegraph, const std::vector<const Device*>& targets) const;
+
+    private:
+
+	struct HolderEntry
+	{
+	    // index into devices, npos for root
+	    size_t source;
+	    size_t target;
+	    std::shared_ptr<const Holder> holder;
+	};
+
+	static const size_t npos = -1;
+
+	std::string rename(const Device* device, const Device* target) const;
+
+	std::string root_classname;
+
+	std::vector<std::shared_ptr<const Device>> devices;
+	std::vector<HolderEntry> holders;
+
+    };
+
+}
+
+#endif
@@ -55,6 +55,7 @@ namespace storage
     void
     BlkDevice::set_name(const string& name)
     {
+	get_impl().record_modify();
 	get_impl().set_name(name);
     }
 
@@ -76,6 +77,7 @@ namespace storage
     void
     BlkDevice::set_size_k(unsigned long long size_k)
     {
+	get_impl().record_modify();
 	get_impl().set_size_k(size_k);
     }
 
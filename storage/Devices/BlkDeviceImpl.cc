@@ -8,6 +8,7 @@
 #include "storage/SystemInfo/SystemInfo.h"
 #include "storage/Utils/StorageDefines.h"
 #include "storage/Utils/SystemCmd.h"
+#include "storage/Utils/Tracer.h"
 
 
 namespace storage
@@ -51,14 +52,16 @@ namespace storage
 
 	if (!cmdudevadminfo.get_by_path_links().empty())
 	{
-	    udev_path = cmdudevadminfo.get_by_path_links().front();
-	    process_udev_path(udev_path);
+	    string tmp = cmdudevadminfo.get_by_path_links().front();
+	    process_udev_path(tmp);
+	    udev_path = tmp;
 	}
 
 	if (!cmdudevadminfo.get_by_id_links().empty())
 	{
-	    udev_ids = cmdudevadminfo.get_by_id_links();
-	    process_udev_ids(udev_ids);
+	    vector<string> tmp = cmdudevadminfo.get_by_id_links();
+	    process_udev_ids(tmp);
+	    udev_ids = tmp;
 	}
     }
 
@@ -158,7 +161,7 @@ namespace storage
 	    out << " udev-path:" << udev_path;
 
 	if (!udev_ids.empty())
-	    out << " udev-ids:" << udev_ids;
+	    out << " udev-ids:" << udev_ids.get();
     }
 
 
@@ -193,10 +196,16 @@ namespace storage
     void
     BlkDevice::Impl::wait_for_device() const
     {
+	// images have no device nodes and udev is not involved
+	if (is_image_target())
+	    return;
+
+	Tracer::Span span("wait", "wait_for_device " + get_name());
+
 	string cmd_line(UDEVADMBIN " settle --timeout=20");
 	SystemCmd cmd(cmd_line);
 
-	bool exist = access(name.c_str(), R_OK) == 0;
+	bool exist = access(get_name().c_str(), R_OK) == 0;
 	y2mil("name:" << name << " exist:" << exist);
 
 	if (!exist)
@@ -204,15 +213,25 @@ namespace storage
 	    for (int count = 0; count < 500; ++count)
 	    {
 		usleep(10000);
-		exist = access(name.c_str(), R_OK) == 0;
+		exist = access(get_name().c_str(), R_OK) == 0;
 		if (exist)
 		    break;
 	    }
 	    y2mil("name:" << name << " exist:" << exist);
 	}
 
+	span.set_arg("exist", exist);
+
 	if (!exist)
 	    throw runtime_error("wait_for_device failed");
     }
 
+
+    void
+    BlkDevice::Impl::get_image_location(string& filename, unsigned long long& offset,
+					unsigned long long& size) const
+    {
+	throw runtime_error("no image location for " + get_name());
+    }
+
 }
@@ -4,6 +4,7 @@
 
 #include "storage/Devices/BlkDevice.h"
 #include "storage/Devices/DeviceImpl.h"
+#include "storage/Utils/Interned.h"
 
 
 namespace storage
@@ -51,6 +52,16 @@ namespace storage
 
 	void wait_for_device() const;
 
+	/**
+	 * For TargetMode::IMAGE the image file and the offset and size in
+	 * bytes of the block device within the image. The size can be
+	 * smaller than the size of the block device since partitions are
+	 * aligned in images. Only disks and partitions have a location, for
+	 * other block devices runtime_error is thrown.
+	 */
+	virtual void get_image_location(string& filename, unsigned long long& offset,
+					unsigned long long& size) const;
+
     protected:
 
 	Impl(const string& name)
@@ -64,15 +75,15 @@ namespace storage
 
     private:
 
-	string name;
+	Interned<string> name;
 
-	string sysfs_name;
-	string sysfs_path;
+	Interned<string> sysfs_name;
+	Interned<string> sysfs_path;
 
 	unsigned long long size_k;
 	dev_t major_minor;
-	string udev_path;
-	vector<string> udev_ids;
+	Interned<string> udev_path;
+	Interned<vector<string>> udev_ids;
 
     };
 
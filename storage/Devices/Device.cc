@@ -69,6 +69,9 @@ namespace storage
 	    boost::add_vertex(shared_ptr<Device>(this), devicegraph->get_impl().graph);
 
 	get_impl().set_devicegraph_and_vertex(devicegraph, vertex);
+
+	if (devicegraph->get_impl().journal.is_recording())
+	    devicegraph->get_impl().journal.record_add_device(devicegraph->get_impl().graph[vertex]);
     }
 
 
@@ -192,6 +195,7 @@ namespace storage
     void
     Device::set_userdata(const map<string, string>& userdata)
     {
+	get_impl().record_modify();
 	get_impl().set_userdata(userdata);
     }
 
@@ -83,6 +83,8 @@ namespace storage
 	Impl& get_impl() { return *impl; }
 	const Impl& get_impl() const { return *impl; }
 
+	void swap_impl(std::shared_ptr<Impl>& impl) { Device::impl.swap(impl); }
+
 	virtual Device* clone() const = 0;
 
 	void save(xmlNode* node) const;
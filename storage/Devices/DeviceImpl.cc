@@ -2,6 +2,8 @@
 
 #include "storage/Devices/DeviceImpl.h"
 #include "storage/Devicegraph.h"
+#include "storage/Storage.h"
+#include "storage/Environment.h"
 #include "storage/Action.h"
 #include "storage/Utils/XmlFile.h"
 #include "storage/Utils/StorageTmpl.h"
@@ -13,12 +15,52 @@ namespace storage
     using namespace std;
 
 
-    sid_t Device::Impl::global_sid = 42;	// just a random number ;)
+    std::atomic<sid_t> Device::Impl::global_sid(42);	// just a random number ;)
+
+    thread_local Device::Impl::SidReservation* Device::Impl::current_reservation = nullptr;
 
 
     Device::Impl::Impl()
-	: sid(global_sid++), devicegraph(nullptr), userdata()
+	: sid(next_sid()), devicegraph(nullptr), userdata()
+    {
+    }
+
+
+    sid_t
+    Device::Impl::allocate_sids(size_t n)
     {
+	return global_sid.fetch_add(n, memory_order_relaxed);
+    }
+
+
+    sid_t
+    Device::Impl::next_sid()
+    {
+	SidReservation* reservation = current_reservation;
+	if (reservation && reservation->next != reservation->end)
+	    return reservation->next++;
+
+	return global_sid.fetch_add(1, memory_order_relaxed);
+    }
+
+
+    Device::Impl::SidReservation::SidReservation(size_t n)
+	: next(allocate_sids(n)), end(next + n), previous(current_reservation)
+    {
+	current_reservation = this;
+    }
+
+
+    Device::Impl::SidReservation::SidReservation(sid_t first, size_t n)
+	: next(first), end(first + n), previous(current_reservation)
+    {
+	current_reservation = this;
+    }
+
+
+    Device::Impl::SidReservation::~SidReservation()
+    {
+	current_reservation = previous;
     }
 
 
@@ -66,6 +108,14 @@ namespace storage
     }
 
 
+    void
+    Device::Impl::record_modify()
+    {
+	if (devicegraph && devicegraph->get_impl().journal.is_recording())
+	    devicegraph->get_impl().journal.record_modify_device(sid, shared_ptr<Impl>(clone()));
+    }
+
+
     Devicegraph*
     Device::Impl::get_devicegraph()
     {
@@ -86,6 +136,15 @@ namespace storage
     }
 
 
+    bool
+    Device::Impl::is_image_target() const
+    {
+	const Environment* environment = get_devicegraph()->get_impl().get_environment();
+
+	return environment && environment->get_target_mode() == TargetMode::IMAGE;
+    }
+
+
     Devicegraph::Impl::vertex_descriptor
     Device::Impl::get_vertex() const
     {
@@ -3,6 +3,8 @@
 
 
 #include <libxml/tree.h>
+#include <atomic>
+#include <boost/noncopyable.hpp>
 
 #include "storage/Devices/Device.h"
 #include "storage/Devicegraph.h"
@@ -41,6 +43,50 @@ namespace storage
 
 	sid_t get_sid() const { return sid; }
 
+	/**
+	 * Only for devices not yet in a devicegraph, e.g. the copies made by
+	 * DevicegraphTemplate, or devices moved to another devicegraph.
+	 */
+	void set_sid(sid_t sid) { Impl::sid = sid; }
+
+	/**
+	 * Reserves n consecutive sids and returns the first one. Safe to call
+	 * from several threads.
+	 */
+	static sid_t allocate_sids(size_t n);
+
+	/**
+	 * Reserves a block of sids for the devices created by the current
+	 * thread while the object exists. Avoids contention on the global sid
+	 * counter when several threads build devicegraphs. If the block is
+	 * used up further sids are again taken from the global counter.
+	 * Reservations of one thread must be destroyed in reverse order.
+	 */
+	class SidReservation : private boost::noncopyable
+	{
+	public:
+
+	    SidReservation(size_t n);
+
+	    /**
+	     * Uses the n sids starting at first without touching the global
+	     * counter. Only for devices that get new sids before they are
+	     * used elsewhere, e.g. the devices of a parallel probe.
+	     */
+	    SidReservation(sid_t first, size_t n);
+	    ~SidReservation();
+
+	private:
+
+	    sid_t next;
+	    sid_t end;
+
+	    SidReservation* previous;
+
+	    friend class Device::Impl;
+
+	};
+
 	void set_devicegraph_and_vertex(Devicegraph* devicegraph,
 					Devicegraph::Impl::vertex_descriptor vertex);
 
@@ -49,9 +95,21 @@ namespace storage
 
 	Devicegraph::Impl::vertex_descriptor get_vertex() const;
 
+	/**
+	 * Whether the devicegraph belongs to a storage with
+	 * TargetMode::IMAGE. The commit functions then work on image files.
+	 */
+	bool is_image_target() const;
+
 	Device* get_device() { return devicegraph->get_impl().graph[vertex].get(); }
 	const Device* get_device() const { return devicegraph->get_impl().graph[vertex].get(); }
 
+	/**
+	 * Records the current state in the journal of the devicegraph. Must
+	 * be called before the device is modified.
+	 */
+	void record_modify();
+
 	const map<string, string>& get_userdata() const { return userdata; }
 	void set_userdata(const map<string, string>& userdata) { Impl::userdata = userdata; }
 
@@ -80,7 +138,11 @@ namespace storage
 
     private:
 
-	static sid_t global_sid;
+	static sid_t next_sid();
+
+	static std::atomic<sid_t> global_sid;
+
+	static thread_local SidReservation* current_reservation;
 
 	sid_t sid;
 
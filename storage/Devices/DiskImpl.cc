@@ -15,6 +15,7 @@
 #include "storage/Utils/StorageTmpl.h"
 #include "storage/Utils/StorageTypes.h"
 #include "storage/Utils/StorageDefines.h"
+#include "storage/Utils/DiskImage.h"
 
 
 namespace storage
@@ -42,18 +43,47 @@ namespace storage
     {
 	vector<string> ret;
 
+	vector<string> devices;
+
 	for (const string& name : systeminfo.getDir(SYSFSDIR "/block"))
 	{
 	    // we do not treat mds as disks although they can be partitioned since kernel 2.6.28
 	    if (boost::starts_with(name, "md") || boost::starts_with(name, "loop"))
 		continue;
 
-	    const CmdUdevadmInfo udevadminfo = systeminfo.getCmdUdevadmInfo("/dev/" + name);
+	    devices.push_back("/dev/" + name);
+	}
+
+	// the partitions of the disks are probed later on
+	vector<string> udevadm_devices = devices;
+	for (const string& device : systeminfo.getProcParts().getEntries())
+	{
+	    if (boost::starts_with(device, "/dev/md") || boost::starts_with(device, "/dev/loop") ||
+		boost::starts_with(device, "/dev/dm-"))
+		continue;
+
+	    if (std::find(devices.begin(), devices.end(), device) == devices.end())
+		udevadm_devices.push_back(device);
+	}
+
+	systeminfo.prefetch_udevadm_infos(udevadm_devices);
+
+	vector<string> range_files;
 
-	    const File range_file = systeminfo.getFile(SYSFSDIR + udevadminfo.get_path() + "/ext_range");
+	for (const string& device : devices)
+	{
+	    const CmdUdevadmInfo& udevadminfo = systeminfo.getCmdUdevadmInfo(device);
+	    range_files.push_back(SYSFSDIR + udevadminfo.get_path() + "/ext_range");
+	}
+
+	systeminfo.prefetch({}, range_files);
+
+	for (size_t i = 0; i < devices.size(); ++i)
+	{
+	    const File range_file = systeminfo.getFile(range_files[i]);
 
 	    if (range_file.get_int() > 1)
-		ret.push_back("/dev/" + name);
+		ret.push_back(devices[i]);
 	}
 
 	return ret;
@@ -75,6 +105,8 @@ namespace storage
 	if (systeminfo.getLsscsi().getEntry(get_name(), entry))
 	    transport = entry.transport;
 
+	ProbeProfile::Scope scope("partition table");
+
 	const Parted& parted = systeminfo.getParted(get_name());
 	if (parted.getLabel() == PtType::MSDOS || parted.getLabel() == PtType::GPT)
 	{
@@ -102,14 +134,16 @@ namespace storage
     PtType
     Disk::Impl::get_default_partition_table_type() const
     {
-	const Arch& arch = get_devicegraph()->get_storage()->get_arch();
+	const Arch* arch = get_devicegraph()->get_impl().get_arch();
+	if (!arch)
+	    throw runtime_error("no arch for devicegraph");
 
 	PtType ret = PtType::MSDOS;
 
 	unsigned long long int num_sectors = geometry.kbToSector(get_size_k());
 	y2mil("num_sectors:" << num_sectors);
 
-	if (arch.is_efiboot() || arch.is_ia64())
+	if (arch->is_efiboot() || arch->is_ia64())
 	    ret = PtType::GPT;
 	else if (num_sectors > (1ULL << 32) - 1)
 	    ret = PtType::GPT;
@@ -262,6 +296,28 @@ namespace storage
     }
 
 
+    void
+    Disk::Impl::do_create() const
+    {
+	// disks are only created for images, the name is the image file
+	if (!is_image_target())
+	    throw runtime_error("cannot create disk");
+
+	DiskImage image(get_name());
+	image.create(get_size_k() * 1024);
+    }
+
+
+    void
+    Disk::Impl::get_image_location(string& filename, unsigned long long& offset,
+				   unsigned long long& size) const
+    {
+	filename = get_name();
+	offset = 0;
+	size = get_size_k() * 1024;
+    }
+
+
     string
     Disk::Impl::partition_name(int number) const
     {
@@ -62,7 +62,11 @@ namespace storage
 
 	virtual void process_udev_ids(vector<string>& udev_ids) const override;
 
+	virtual void get_image_location(string& filename, unsigned long long& offset,
+					unsigned long long& size) const override;
+
 	Text do_create_text(bool doing) const override;
+	virtual void do_create() const override;
 
 	string partition_name(int number) const;
 
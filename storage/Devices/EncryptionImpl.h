@@ -56,6 +56,8 @@ namespace storage
 
 	    OpenEncryption(sid_t sid) : Modify(sid) {}
 
+	    virtual const char* get_classname() const override { return "OpenEncryption"; }
+
 	    virtual Text text(const Actiongraph& actiongraph, bool doing) const override;
 
 	};
@@ -8,6 +8,7 @@
 #include "storage/Action.h"
 #include "storage/Utils/StorageDefines.h"
 #include "storage/Utils/SystemCmd.h"
+#include "storage/Utils/OutputProcessor.h"
 
 
 namespace storage
@@ -29,10 +30,34 @@ namespace storage
 
 	blkdevice->get_impl().wait_for_device();
 
-	string cmd_line = MKFSEXT2BIN " -t ext4 -v -F " + quote(blkdevice->get_name());
+	string cmd_line = MKFSEXT2BIN " -t ext4 -v -F ";
+
+	if (is_image_target())
+	{
+	    // mke2fs writes directly at the offset of the partition, discard
+	    // would punch holes into the whole image
+	    string filename;
+	    unsigned long long offset, size;
+	    blkdevice->get_impl().get_image_location(filename, offset, size);
+
+	    if (!get_label().empty())
+		cmd_line += "-L " + quote(get_label()) + " ";
+
+	    cmd_line += "-E nodiscard,offset=" + to_string(offset) + " " + quote(filename) + " " +
+		to_string(size / 1024) + "k";
+	}
+	else
+	{
+	    cmd_line += quote(blkdevice->get_name());
+	}
+
 	cout << cmd_line << endl;
 
-	SystemCmd cmd(cmd_line);
+	Mke2fsProgress progress(cmd_line);
+
+	SystemCmd cmd;
+	cmd.setOutputProcessor(&progress);
+	cmd.execute(cmd_line);
 	if (cmd.retcode() != 0)
 	    throw runtime_error("create ext4 failed");
     }
@@ -49,6 +49,7 @@ namespace storage
     void
     Filesystem::set_label(const string& label)
     {
+	get_impl().record_modify();
 	get_impl().set_label(label);
     }
 
@@ -70,6 +71,7 @@ namespace storage
     void
     Filesystem::set_mountpoints(const vector<string>& mountpoints)
     {
+	get_impl().record_modify();
 	get_impl().set_mountpoints(mountpoints);
     }
 
@@ -77,6 +79,7 @@ namespace storage
     void
     Filesystem::add_mountpoint(const string& mountpoint)
     {
+	get_impl().record_modify();
 	return get_impl().add_mountpoint(mountpoint);
     }
 
@@ -91,6 +94,7 @@ namespace storage
     void
     Filesystem::set_mount_by(MountByType mount_by)
     {
+	get_impl().record_modify();
 	get_impl().set_mount_by(mount_by);
     }
 
@@ -105,6 +109,7 @@ namespace storage
     void
     Filesystem::set_fstab_options(const list<string>& fstab_options)
     {
+	get_impl().record_modify();
 	get_impl().set_fstab_options(fstab_options);
     }
 
@@ -119,6 +124,7 @@ namespace storage
     void
     Filesystem::set_mkfs_options(const string& mkfs_options)
     {
+	get_impl().record_modify();
 	get_impl().set_mkfs_options(mkfs_options);
     }
 
@@ -133,6 +139,7 @@ namespace storage
     void
     Filesystem::set_tune_options(const string& tune_options)
     {
+	get_impl().record_modify();
 	get_impl().set_tune_options(tune_options);
     }
 
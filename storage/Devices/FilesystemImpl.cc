@@ -1,8 +1,10 @@
 
 
+#include <unistd.h>
 #include <iostream>
 
 #include "storage/Devices/FilesystemImpl.h"
+#include "storage/Devices/BlkDeviceImpl.h"
 #include "storage/Devicegraph.h"
 #include "storage/Action.h"
 #include "storage/Utils/XmlFile.h"
@@ -10,7 +12,9 @@
 #include "storage/Utils/StorageTmpl.h"
 #include "storage/Utils/StorageDefines.h"
 #include "storage/Utils/SystemCmd.h"
+#include "storage/Utils/DiskImage.h"
 #include "storage/SystemInfo/SystemInfo.h"
+#include "storage/SystemInfo/ProcMountinfo.h"
 #include "storage/StorageImpl.h"
 
 
@@ -21,8 +25,8 @@ namespace storage
 
 
     Filesystem::Impl::Impl(const xmlNode* node)
-	: Device::Impl(node), label(), uuid(), mountpoints({}), mount_by(MOUNTBY_DEVICE),
-	  fstab_options({}), mkfs_options(), tune_options()
+	: Device::Impl(node), label(), uuid(), mountpoints(), mount_by(MOUNTBY_DEVICE),
+	  fstab_options(), mkfs_options(), tune_options()
     {
 	string tmp;
 
@@ -59,7 +63,9 @@ namespace storage
     void
     Filesystem::Impl::add_mountpoint(const string& mountpoint)
     {
-	Impl::mountpoints.push_back(mountpoint);
+	vector<string> tmp = mountpoints;
+	tmp.push_back(mountpoint);
+	mountpoints = tmp;
     }
 
 
@@ -104,7 +110,7 @@ namespace storage
 	setChildValueIf(node, "mount-by", toString(mount_by), mount_by != MOUNTBY_DEVICE);
 
 	if (!fstab_options.empty())
-	    setChildValue(node, "fstab-options", boost::join(fstab_options, ","));
+	    setChildValue(node, "fstab-options", boost::join(fstab_options.get(), ","));
 
 	setChildValueIf(node, "mkfs-options", mkfs_options, !mkfs_options.empty());
 	setChildValueIf(node, "tune-options", tune_options, !tune_options.empty());
@@ -129,7 +135,7 @@ namespace storage
 	const ProcMounts& proc_mounts = systeminfo.getProcMounts();
 	string mountpoint = proc_mounts.getMount(blkdevice->get_name());
 	if (!mountpoint.empty())
-	    mountpoints.push_back(mountpoint);
+	    add_mountpoint(mountpoint);
 
 	fstab.setDevice(blkdevice->get_name(), {}, uuid, label, blkdevice->get_udev_ids(),
 			blkdevice->get_udev_path());
@@ -152,7 +158,10 @@ namespace storage
 	Actiongraph::vertex_descriptor v1 = actiongraph.add_vertex(format);
 	first = last = format;
 
-	if (!get_label().empty())
+	// for images mkfs sets the label and nothing is mounted
+	const bool image = is_image_target();
+
+	if (!image && !get_label().empty())
 	{
 	    Action::SetLabel* set_label = new Action::SetLabel(get_sid());
 	    Actiongraph::vertex_descriptor tmp = actiongraph.add_vertex(set_label);
@@ -162,7 +171,7 @@ namespace storage
 	    last = set_label;
 	}
 
-	if (!get_mountpoints().empty())
+	if (!image && !get_mountpoints().empty())
 	{
 	    Action::Nop* nop = new Action::Nop(get_sid());
 	    Actiongraph::vertex_descriptor v2 = actiongraph.add_vertex(nop);
@@ -188,12 +197,47 @@ namespace storage
     }
 
 
+    void
+    Filesystem::Impl::create_via_file(const string& cmd_line, OutputProcessor* output_processor) const
+    {
+	const BlkDevice* blkdevice = get_blkdevice();
+
+	string filename;
+	unsigned long long offset, size;
+	blkdevice->get_impl().get_image_location(filename, offset, size);
+
+	// next to the image so that copying stays on one filesystem
+	const string tmp_filename = filename + "." + to_string(get_sid()) + ".tmp";
+
+	DiskImage tmp(tmp_filename);
+	tmp.create(size);
+
+	try
+	{
+	    SystemCmd cmd;
+	    cmd.setOutputProcessor(output_processor);
+	    cmd.execute(cmd_line + " " + quote(tmp_filename));
+	    if (cmd.retcode() != 0)
+		throw runtime_error("create " + toString(get_type()) + " failed");
+
+	    DiskImage(filename).copy_from(tmp_filename, offset);
+	}
+	catch (...)
+	{
+	    unlink(tmp_filename.c_str());
+	    throw;
+	}
+
+	unlink(tmp_filename.c_str());
+    }
+
+
     void
     Filesystem::Impl::add_delete_actions(Actiongraph& actiongraph) const
     {
 	vector<Action::Base*> actions;
 
-	for (const string& mountpoint : mountpoints)
+	for (const string& mountpoint : get_mountpoints())
 	{
 	    actions.push_back(new Action::RemoveFstab(get_sid(), mountpoint));
 	    actions.push_back(new Action::Umount(get_sid(), mountpoint));
@@ -247,11 +291,11 @@ namespace storage
 	storage::log_diff(log, "label", label, rhs.label);
 	storage::log_diff(log, "uuid", uuid, rhs.uuid);
 
-	storage::log_diff(log, "mountpoints", mountpoints, rhs.mountpoints);
+	storage::log_diff(log, "mountpoints", mountpoints.get(), rhs.mountpoints.get());
 
 	storage::log_diff_enum(log, "mount-by", mount_by, rhs.mount_by);
 
-	storage::log_diff(log, "fstab-options", fstab_options, rhs.fstab_options);
+	storage::log_diff(log, "fstab-options", fstab_options.get(), rhs.fstab_options.get());
 
 	storage::log_diff(log, "mkfs-options", mkfs_options, rhs.mkfs_options);
 	storage::log_diff(log, "tune-options", tune_options, rhs.tune_options);
@@ -270,10 +314,10 @@ namespace storage
 	    out << " uuid:" << uuid;
 
 	if (!mountpoints.empty())
-	    out << " mountpoints:" << mountpoints;
+	    out << " mountpoints:" << mountpoints.get();
 
 	if (!fstab_options.empty())
-	    out << " fstab-options:" << fstab_options;
+	    out << " fstab-options:" << fstab_options.get();
 
 	if (!mkfs_options.empty())
 	    out << " mkfs-options:" << mkfs_options;
@@ -375,6 +419,14 @@ namespace storage
 	const Storage& storage = actiongraph.get_storage();
 
 	string real_mountpoint = storage.get_impl().prepend_rootprefix(mountpoint);
+
+	const ProcMountinfo& proc_mountinfo = storage.get_impl().get_proc_mountinfo();
+	if (proc_mountinfo.is_mounted(blkdevice->get_name(), real_mountpoint))
+	{
+	    y2mil(blkdevice->get_name() << " already mounted at " << real_mountpoint);
+	    return;
+	}
+
 	if (access(real_mountpoint.c_str(), R_OK ) != 0)
 	{
 	    createPath(real_mountpoint);
@@ -417,9 +469,7 @@ namespace storage
     void
     Filesystem::Impl::do_add_fstab(const Actiongraph& actiongraph, const string& mountpoint) const
     {
-	const Storage& storage = actiongraph.get_storage();
-
-	EtcFstab fstab(storage.get_impl().prepend_rootprefix("/etc"));	// TODO pass as parameter
+	EtcFstab& fstab = actiongraph.get_etc_fstab();
 
 	const BlkDevice* blkdevice = get_blkdevice();
 
@@ -433,7 +483,6 @@ namespace storage
 	entry.opts = fstab_options;
 
 	fstab.addEntry(entry);
-	fstab.flush();
     }
 
 
@@ -445,9 +494,17 @@ namespace storage
 
 
     void
-    Filesystem::Impl::do_remove_fstab(const string& mountpoint) const
+    Filesystem::Impl::do_remove_fstab(const Actiongraph& actiongraph, const string& mountpoint) const
     {
-	// TOOD
+	EtcFstab& fstab = actiongraph.get_etc_fstab();
+
+	const BlkDevice* blkdevice = get_blkdevice();
+
+	fstab.setDevice(blkdevice->get_name(), {}, uuid, label, blkdevice->get_udev_ids(),
+			blkdevice->get_udev_path());
+
+	if (fstab.removeEntry(FstabKey(blkdevice->get_name(), mountpoint)) != 0)
+	    throw runtime_error("removing fstab entry failed");
     }
 
 
@@ -530,7 +587,7 @@ namespace storage
 	Text
 	RemoveFstab::text(const Actiongraph& actiongraph, bool doing) const
 	{
-	    const Filesystem* filesystem = to_filesystem(device_rhs(actiongraph));
+	    const Filesystem* filesystem = to_filesystem(device_lhs(actiongraph));
 	    return filesystem->get_impl().do_remove_fstab_text(mountpoint, doing);
 	}
 
@@ -538,8 +595,8 @@ namespace storage
 	void
 	RemoveFstab::commit(const Actiongraph& actiongraph) const
 	{
-	    const Filesystem* filesystem = to_filesystem(device_rhs(actiongraph));
-	    filesystem->get_impl().do_remove_fstab(mountpoint);
+	    const Filesystem* filesystem = to_filesystem(device_lhs(actiongraph));
+	    filesystem->get_impl().do_remove_fstab(actiongraph, mountpoint);
 	}
 
     }
@@ -6,6 +6,7 @@
 #include "storage/Devices/DeviceImpl.h"
 #include "storage/Action.h"
 #include "storage/StorageInterface.h"
+#include "storage/Utils/Interned.h"
 
 
 namespace storage
@@ -14,6 +15,7 @@ namespace storage
     using namespace std;
 
     class EtcFstab;
+    class OutputProcessor;
 
 
     // abstract class
@@ -75,27 +77,34 @@ namespace storage
 	virtual void do_add_fstab(const Actiongraph& actiongraph, const string& mountpoint) const;
 
 	virtual Text do_remove_fstab_text(const string& mountpoint, bool doing) const;
-	virtual void do_remove_fstab(const string& mountpoint) const;
+	virtual void do_remove_fstab(const Actiongraph& actiongraph, const string& mountpoint) const;
 
     protected:
 
 	Impl()
-	    : Device::Impl(), label(), uuid(), mountpoints({}), mount_by(MOUNTBY_DEVICE),
-	      fstab_options({}), mkfs_options(), tune_options() {}
+	    : Device::Impl(), label(), uuid(), mountpoints(), mount_by(MOUNTBY_DEVICE),
+	      fstab_options(), mkfs_options(), tune_options() {}
 
 	Impl(const xmlNode* node);
 
 	void save(xmlNode* node) const override;
 
+	/**
+	 * For TargetMode::IMAGE: Runs cmd_line with a temporary sparse file
+	 * of the size of the block device appended and copies the result
+	 * into the image. For mkfs tools that cannot write at an offset.
+	 */
+	void create_via_file(const string& cmd_line, OutputProcessor* output_processor) const;
+
     private:
 
 	string label;
 	string uuid;
 
 	// TODO this should be a list of a struct with mountpoint, mount-by and fstab-options
-	vector<string> mountpoints;
+	Interned<vector<string>> mountpoints;
 	MountByType mount_by;
-	list<string> fstab_options;
+	Interned<list<string>> fstab_options;
 
 	string mkfs_options;
 	string tune_options;
@@ -112,6 +121,8 @@ namespace storage
 
 	    SetLabel(sid_t sid) : Modify(sid) {}
 
+	    virtual const char* get_classname() const override { return "SetLabel"; }
+
 	    virtual Text text(const Actiongraph& actiongraph, bool doing) const override;
 	    virtual void commit(const Actiongraph& actiongraph) const override;
 
@@ -125,6 +136,8 @@ namespace storage
 	    Mount(sid_t sid, const string& mountpoint)
 		: Modify(sid), mountpoint(mountpoint) {}
 
+	    virtual const char* get_classname() const override { return "Mount"; }
+
 	    virtual Text text(const Actiongraph& actiongraph, bool doing) const override;
 	    virtual void commit(const Actiongraph& actiongraph) const override;
 
@@ -140,6 +153,8 @@ namespace storage
 	    Umount(sid_t sid, const string& mountpoint)
 		: Modify(sid), mountpoint(mountpoint) {}
 
+	    virtual const char* get_classname() const override { return "Umount"; }
+
 	    virtual Text text(const Actiongraph& actiongraph, bool doing) const override;
 	    virtual void commit(const Actiongraph& actiongraph) const override;
 
@@ -155,6 +170,8 @@ namespace storage
 	    AddFstab(sid_t sid, const string& mountpoint)
 		: Modify(sid), mountpoint(mountpoint) {}
 
+	    virtual const char* get_classname() const override { return "AddFstab"; }
+
 	    virtual Text text(const Actiongraph& actiongraph, bool doing) const override;
 	    virtual void commit(const Actiongraph& actiongraph) const override;
 
@@ -173,6 +190,8 @@ namespace storage
 	    RemoveFstab(sid_t sid, const string& mountpoint)
 		: Modify(sid), mountpoint(mountpoint) {}
 
+	    virtual const char* get_classname() const override { return "RemoveFstab"; }
+
 	    virtual Text text(const Actiongraph& actiongraph, bool doing) const override;
 	    virtual void commit(const Actiongraph& actiongraph) const override;
 
@@ -66,6 +66,7 @@ namespace storage
     void
     Gpt::set_enlarge(bool enlarge)
     {
+	get_impl().record_modify();
 	get_impl().set_enlarge(enlarge);
     }
 
@@ -118,6 +118,12 @@ namespace storage
     void
     Gpt::Impl::do_create() const
     {
+	if (is_image_target())
+	{
+	    write_image();
+	    return;
+	}
+
 	const Disk* disk = get_disk();
 
 	string cmd_line = PARTEDBIN " -s " + quote(disk->get_name()) + " mklabel gpt";
@@ -128,4 +134,11 @@ namespace storage
 	    throw runtime_error("create gpt failed");
     }
 
+
+    void
+    Gpt::Impl::do_write_image(const DiskImage& image, const vector<DiskImage::Entry>& entries) const
+    {
+	image.write_gpt(entries);
+    }
+
 }
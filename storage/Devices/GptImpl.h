@@ -44,9 +44,17 @@ namespace storage
 	bool get_enlarge() const { return enlarge; }
 	void set_enlarge(bool enlarge) { Impl::enlarge = enlarge; }
 
+	virtual unsigned long long reserved_image_sectors() const override
+	    { return DiskImage::gpt_backup_sectors; }
+
 	virtual Text do_create_text(bool doing) const override;
 	virtual void do_create() const override;
 
+    protected:
+
+	virtual void do_write_image(const DiskImage& image,
+				    const vector<DiskImage::Entry>& entries) const override;
+
     private:
 
 	bool enlarge;
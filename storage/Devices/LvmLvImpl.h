@@ -52,6 +52,8 @@ namespace storage
 
 	    Rename(sid_t sid) : Modify(sid) {}
 
+	    virtual const char* get_classname() const override { return "Rename"; }
+
 	    virtual Text text(const Actiongraph& actiongraph, bool doing) const override;
 	    virtual void commit(const Actiongraph& actiongraph) const override;
 
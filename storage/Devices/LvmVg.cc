@@ -70,6 +70,7 @@ namespace storage
     void
     LvmVg::set_name(const string& name)
     {
+	get_impl().record_modify();
 	get_impl().set_name(name);
     }
 
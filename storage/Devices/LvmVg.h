@@ -24,7 +24,7 @@ namespace storage
 
 	LvmLv* create_lvm_lv(const std::string& name);
 
-    protected:
+    public:
 
 	class Impl;
 
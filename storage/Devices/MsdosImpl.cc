@@ -105,6 +105,12 @@ namespace storage
     void
     Msdos::Impl::do_create() const
     {
+	if (is_image_target())
+	{
+	    write_image();
+	    return;
+	}
+
 	const Disk* disk = get_disk();
 
 	string cmd_line = PARTEDBIN " -s " + quote(disk->get_name()) + " mklabel msdos";
@@ -115,4 +121,11 @@ namespace storage
 	    throw runtime_error("create msdos failed");
     }
 
+
+    void
+    Msdos::Impl::do_write_image(const DiskImage& image, const vector<DiskImage::Entry>& entries) const
+    {
+	image.write_msdos(entries);
+    }
+
 }
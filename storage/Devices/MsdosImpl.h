@@ -46,6 +46,11 @@ namespace storage
 	virtual Text do_create_text(bool doing) const override;
 	virtual void do_create() const override;
 
+    protected:
+
+	virtual void do_write_image(const DiskImage& image,
+				    const vector<DiskImage::Entry>& entries) const override;
+
     };
 
 }
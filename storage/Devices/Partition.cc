@@ -73,6 +73,7 @@ namespace storage
     void
     Partition::set_region(const Region& region)
     {
+	get_impl().record_modify();
 	get_impl().set_region(region);
     }
 
@@ -87,6 +88,7 @@ namespace storage
     void
     Partition::set_type(PartitionType type)
     {
+	get_impl().record_modify();
 	get_impl().set_type(type);
     }
 
@@ -101,6 +103,7 @@ namespace storage
     void
     Partition::set_id(unsigned int id)
     {
+	get_impl().record_modify();
 	get_impl().set_id(id);
     }
 
@@ -115,6 +118,7 @@ namespace storage
     void
     Partition::set_boot(bool boot)
     {
+	get_impl().record_modify();
 	get_impl().set_boot(boot);
     }
 
@@ -4,11 +4,13 @@
 
 #include "storage/Devices/PartitionImpl.h"
 #include "storage/Devices/DiskImpl.h"
+#include "storage/Devices/PartitionTableImpl.h"
 #include "storage/Devicegraph.h"
 #include "storage/SystemInfo/SystemInfo.h"
 #include "storage/Utils/SystemCmd.h"
 #include "storage/Utils/StorageDefines.h"
 #include "storage/Utils/StorageTmpl.h"
+#include "storage/Utils/DiskImage.h"
 
 
 namespace storage
@@ -85,6 +87,8 @@ namespace storage
 	assert(disk);
 
 	region.set_length(get_size_k() * 1024 / disk->get_impl().get_geometry().cylinderSize());
+
+	update_free_space();
     }
 
 
@@ -103,6 +107,27 @@ namespace storage
     }
 
 
+    void
+    Partition::Impl::set_type(PartitionType type)
+    {
+	Impl::type = type;
+
+	update_free_space();
+    }
+
+
+    void
+    Partition::Impl::update_free_space() const
+    {
+	const Devicegraph* devicegraph = get_devicegraph();
+	if (devicegraph->get_impl().num_parents(get_vertex()) != 1)
+	    return;
+
+	const PartitionTable* partitiontable = get_partition_table();
+	partitiontable->get_impl().update_free_space(get_sid(), type, region);
+    }
+
+
     const PartitionTable*
     Partition::Impl::get_partition_table() const
     {
@@ -221,12 +246,66 @@ namespace storage
     }
 
 
+    void
+    Partition::Impl::get_image_sectors(unsigned long long& start, unsigned long long& length) const
+    {
+	const PartitionTable* partitiontable = get_partition_table();
+	assert(partitiontable);
+
+	const Disk* disk = partitiontable->get_disk();
+	assert(disk);
+
+	const unsigned long long alignment = DiskImage::alignment;
+	const unsigned long long cylinder = disk->get_impl().get_geometry().cylinderSize() /
+	    DiskImage::sector_size;
+
+	start = max(region.get_start() * cylinder, alignment);
+	start = (start + alignment - 1) / alignment * alignment;
+	if (type == LOGICAL)
+	    start += alignment;
+
+	unsigned long long end = min((region.get_end() + 1) * cylinder,
+				     disk->get_size_k() * 1024 / DiskImage::sector_size -
+				     partitiontable->get_impl().reserved_image_sectors());
+
+	if (end <= start)
+	    throw runtime_error("partition " + get_name() + " too small for image");
+
+	length = end - start;
+    }
+
+
+    void
+    Partition::Impl::get_image_location(string& filename, unsigned long long& offset,
+					unsigned long long& size) const
+    {
+	const PartitionTable* partitiontable = get_partition_table();
+	assert(partitiontable);
+
+	partitiontable->get_disk()->get_impl().get_image_location(filename, offset, size);
+
+	unsigned long long start, length;
+	get_image_sectors(start, length);
+
+	offset += start * DiskImage::sector_size;
+	size = length * DiskImage::sector_size;
+    }
+
+
     void
     Partition::Impl::do_create() const
     {
 	const PartitionTable* partitiontable = get_partition_table();
 	assert(partitiontable);
 
+	// rewriting the table also adds all other partitions, that does
+	// no harm since they are committed anyway
+	if (is_image_target())
+	{
+	    partitiontable->get_impl().write_image();
+	    return;
+	}
+
 	const Disk* disk = partitiontable->get_disk();
 	assert(disk);
 
@@ -268,6 +347,12 @@ namespace storage
 	const PartitionTable* partitiontable = get_partition_table();
 	assert(partitiontable);
 
+	if (is_image_target())
+	{
+	    partitiontable->get_impl().write_image();
+	    return;
+	}
+
 	const Disk* disk = partitiontable->get_disk();
 	assert(disk);
 
@@ -292,6 +377,9 @@ namespace storage
     void
     Partition::Impl::do_delete() const
     {
+	if (is_image_target())
+	    throw runtime_error("cannot delete partition of image");
+
 	const PartitionTable* partitiontable = get_partition_table();
 	assert(partitiontable);
 
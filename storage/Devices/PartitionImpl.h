@@ -39,7 +39,7 @@ namespace storage
 	void set_region(const Region& region);
 
 	PartitionType get_type() const { return type; }
-	void set_type(PartitionType type) { Impl::type = type; }
+	void set_type(PartitionType type);
 
 	unsigned int get_id() const { return id; }
 	void set_id(unsigned int id) { Impl::id = id; }
@@ -62,6 +62,16 @@ namespace storage
 
 	virtual void process_udev_ids(vector<string>& udev_ids) const override;
 
+	/**
+	 * For TargetMode::IMAGE the start and length of the partition in
+	 * sectors of DiskImage. The region is aligned, moved behind the
+	 * partition table and EBR and cut at the end of the disk.
+	 */
+	void get_image_sectors(unsigned long long& start, unsigned long long& length) const;
+
+	virtual void get_image_location(string& filename, unsigned long long& offset,
+					unsigned long long& size) const override;
+
 	virtual Text do_create_text(bool doing) const override;
 	virtual void do_create() const override;
 
@@ -73,6 +83,8 @@ namespace storage
 
     private:
 
+	void update_free_space() const;
+
 	Region region;
 	PartitionType type;
 	unsigned int id;
@@ -90,6 +102,8 @@ namespace storage
 
 	    SetPartitionId(sid_t sid) : Modify(sid) {}
 
+	    virtual const char* get_classname() const override { return "SetPartitionId"; }
+
 	    virtual Text text(const Actiongraph& actiongraph, bool doing) const override;
 	    virtual void commit(const Actiongraph& actiongraph) const override;
 
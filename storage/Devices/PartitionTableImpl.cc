@@ -21,11 +21,23 @@ namespace storage
 
 
     PartitionTable::Impl::Impl(const xmlNode* node)
-	: Device::Impl(node), read_only(false)
+	: Device::Impl(node), read_only(false), free_space_valid(false)
     {
     }
 
 
+    PartitionTable::Impl::Impl(const Impl& impl)
+	: Device::Impl(impl), read_only(impl.read_only), free_space_valid(false)
+    {
+	lock_guard<std::mutex> lock(impl.free_space_mutex);
+
+	free_space_valid = impl.free_space_valid;
+	primary_free_space = impl.primary_free_space;
+	logical_free_space = impl.logical_free_space;
+	free_space_entries = impl.free_space_entries;
+    }
+
+
     void
     PartitionTable::Impl::probe(SystemInfo& systeminfo)
     {
@@ -48,6 +60,8 @@ namespace storage
 	    Partition* p = create_partition(name, entry.type);
 	    p->get_impl().probe(systeminfo);
 	}
+
+	invalidate_free_space();
     }
 
 
@@ -66,6 +80,8 @@ namespace storage
 	Partition* partition = Partition::create(get_devicegraph(), name, type);
 	Subdevice::create(get_devicegraph(), get_device(), partition);
 
+	update_free_space(partition->get_sid(), type, partition->get_region());
+
 	return partition;
     }
 
@@ -130,6 +146,28 @@ namespace storage
     }
 
 
+    void
+    PartitionTable::Impl::write_image() const
+    {
+	string filename;
+	unsigned long long offset, size;
+	get_disk()->get_impl().get_image_location(filename, offset, size);
+
+	vector<DiskImage::Entry> entries;
+
+	for (const Partition* partition : get_partitions())
+	{
+	    unsigned long long start, length;
+	    partition->get_impl().get_image_sectors(start, length);
+
+	    entries.emplace_back(partition->get_number(), partition->get_type(), start, length,
+				 partition->get_id(), partition->get_boot());
+	}
+
+	do_write_image(DiskImage(filename), entries);
+    }
+
+
     bool
     PartitionTable::Impl::equal(const Device::Impl& rhs_base) const
     {
@@ -220,15 +258,43 @@ namespace storage
 
 	unsigned int range = get_disk()->get_impl().get_range();
 
-	bool tmp_primary_possible = num_primary() + (has_extended() ? 1 : 0) < max_primary(range);
-	bool tmp_extended_possible = tmp_primary_possible && extended_possible() && !has_extended();
-	bool tmp_logical_possible = has_extended() && num_logical() < (max_logical(range) - max_primary(range));
+	vector<const Partition*> partitions = get_partitions();
+
+	unsigned int num_primary = 0;
+	unsigned int num_extended = 0;
+	unsigned int num_logical = 0;
+
+	for (const Partition* partition : partitions)
+	{
+	    switch (partition->get_type())
+	    {
+		case PRIMARY: ++num_primary; break;
+		case EXTENDED: ++num_extended; break;
+		case LOGICAL: ++num_logical; break;
+		default: break;
+	    }
+	}
+
+	bool tmp_primary_possible = num_primary + num_extended < max_primary(range);
+	bool tmp_extended_possible = tmp_primary_possible && extended_possible() && num_extended == 0;
+	bool tmp_logical_possible = num_extended > 0 && num_logical < (max_logical(range) - max_primary(range));
 
 	list<PartitionSlotInfo> slots;
 
-	vector<const Partition*> partitions = get_partitions();
 	sort(partitions.begin(), partitions.end(), Partition::Impl::cmp_lt_number);
 
+	vector<Region> primary_free_regions;
+	vector<Region> logical_free_regions;
+
+	{
+	    lock_guard<std::mutex> lock(free_space_mutex);
+
+	    ensure_free_space();
+
+	    primary_free_regions = primary_free_space.get_free_regions();
+	    logical_free_regions = logical_free_space.get_free_regions();
+	}
+
 	if (all || !logical)
 	{
 	    PartitionSlotInfo slot;
@@ -264,25 +330,10 @@ namespace storage
 	    slot.logicalSlot = false;
 	    slot.logicalPossible = false;
 
-	    unsigned long start = 0;
-	    unsigned long end = get_disk()->get_impl().get_geometry().cylinders;
-
-	    list<Region> tmp;
-	    for (const Partition* partition : partitions)
-	    {
-		if (partition->get_type() != LOGICAL)
-		    tmp.push_back(partition->get_region());
-	    }
-	    tmp.sort();
-
-	    for (list<Region>::const_iterator i = tmp.begin(); i != tmp.end(); ++i)
+	    for (const Region& region : primary_free_regions)
 	    {
-		if (i->get_start() > start)
-		{
-		    slot.cylRegion = RegionInfo(start, i->get_start() - start);
-		    slots.push_back(slot);
-		}
-		start = i->get_end() + 1;
+		slot.cylRegion = region;
+		slots.push_back(slot);
 
 		/*
 		if (label == "dasd")
@@ -292,83 +343,175 @@ namespace storage
 		}
 		*/
 	    }
-	    if (end > start)
-	    {
-		slot.cylRegion = RegionInfo(start, end - start);
-		slots.push_back(slot);
-	    }
 	}
 
-	if (all || logical)
+	if ((all || logical) && num_extended > 0)
 	{
-	    try
-	    {
-		const Partition* extended = get_extended();
-
-		PartitionSlotInfo slot;
-
-		slot.nr = max_primary(range) + num_logical() + 1;
-		slot.device = get_disk()->get_impl().partition_name(slot.nr);
+	    PartitionSlotInfo slot;
 
-		slot.primarySlot = false;
-		slot.primaryPossible = false;
-		slot.extendedSlot = false;
-		slot.extendedPossible = false;
-		slot.logicalSlot = true;
-		slot.logicalPossible = tmp_logical_possible;
+	    slot.nr = max_primary(range) + num_logical + 1;
+	    slot.device = get_disk()->get_impl().partition_name(slot.nr);
 
-		unsigned long start = extended->get_region().get_start();
-		unsigned long end = extended->get_region().get_end();
+	    slot.primarySlot = false;
+	    slot.primaryPossible = false;
+	    slot.extendedSlot = false;
+	    slot.extendedPossible = false;
+	    slot.logicalSlot = true;
+	    slot.logicalPossible = tmp_logical_possible;
 
-		list<Region> tmp;
-		for (const Partition* partition : partitions)
-		{
-		    if (partition->get_type() == LOGICAL)
-			tmp.push_back(partition->get_region());
-		}
-		tmp.sort();
-
-		for (list<Region>::const_iterator i = tmp.begin(); i != tmp.end(); ++i)
-		{
-		    if (i->get_start() > start)
-		    {
-			slot.cylRegion = RegionInfo(start, i->get_start() - start);
-			slots.push_back(slot);
-		    }
-		    start = i->get_end() + 1;
-		}
-		if (end > start)
-		{
-		    slot.cylRegion = RegionInfo(start, end - start);
-		    slots.push_back(slot);
-		}
-	    }
-	    catch (...)
+	    for (const Region& region : logical_free_regions)
 	    {
+		slot.cylRegion = region;
+		slots.push_back(slot);
 	    }
 	}
 
 	y2deb("slots:" << slots);
 
+	return slots;
+    }
+
+
+    void
+    PartitionTable::Impl::ensure_free_space() const
+    {
+	if (free_space_valid)
+	    return;
+
+	// The last cylinder of the extended partition is never offered for
+	// logical partitions.
+
 	Region usable_region = get_usable_region();
 
-	list<PartitionSlotInfo>::iterator it = slots.begin();
-	while (it != slots.end())
+	Region primary_bounds(0, get_disk()->get_impl().get_geometry().cylinders);
+	primary_free_space.reset(!primary_bounds.empty() && usable_region.intersect(primary_bounds) ?
+				 usable_region.intersection(primary_bounds) : Region());
+
+	logical_free_space.reset(Region());
+
+	free_space_entries.clear();
+
+	vector<const Partition*> partitions = get_partitions();
+
+	for (const Partition* partition : partitions)
 	{
-	    if (usable_region.intersect(it->cylRegion))
+	    if (partition->get_type() == EXTENDED)
 	    {
-		it->cylRegion = usable_region.intersection(it->cylRegion);
-		++it;
+		const Region& region = partition->get_region();
+		Region logical_bounds(region.get_start(), region.empty() ? 0 : region.get_length() - 1);
+		if (!logical_bounds.empty() && usable_region.intersect(logical_bounds))
+		    logical_free_space.reset(usable_region.intersection(logical_bounds));
 	    }
+	}
+
+	for (const Partition* partition : partitions)
+	{
+	    free_space_entries[partition->get_sid()] = make_pair(partition->get_type(),
+								 partition->get_region());
+
+	    if (partition->get_type() == LOGICAL)
+		logical_free_space.add_used(partition->get_region());
 	    else
-	    {
-		it = slots.erase(it);
-	    }
+		primary_free_space.add_used(partition->get_region());
 	}
 
-	y2deb("slots:" << slots);
+	free_space_valid = true;
 
-	return slots;
+	y2deb("primary " << primary_free_space);
+	y2deb("logical " << logical_free_space);
+    }
+
+
+    void
+    PartitionTable::Impl::invalidate_free_space() const
+    {
+	lock_guard<std::mutex> lock(free_space_mutex);
+
+	free_space_valid = false;
+    }
+
+
+    void
+    PartitionTable::Impl::update_free_space(sid_t sid, PartitionType type, const Region& region) const
+    {
+	lock_guard<std::mutex> lock(free_space_mutex);
+
+	if (!free_space_valid)
+	    return;
+
+	do_remove_free_space(sid);
+
+	// the extended partition defines the bounds for the logical
+	// partitions, simply start over
+	if (!free_space_valid || type == EXTENDED)
+	{
+	    free_space_valid = false;
+	    return;
+	}
+
+	free_space_entries[sid] = make_pair(type, region);
+
+	if (type == LOGICAL)
+	    logical_free_space.add_used(region);
+	else
+	    primary_free_space.add_used(region);
+    }
+
+
+    void
+    PartitionTable::Impl::remove_free_space(sid_t sid) const
+    {
+	lock_guard<std::mutex> lock(free_space_mutex);
+
+	do_remove_free_space(sid);
+    }
+
+
+    void
+    PartitionTable::Impl::do_remove_free_space(sid_t sid) const
+    {
+	if (!free_space_valid)
+	    return;
+
+	map<sid_t, pair<PartitionType, Region>>::iterator it = free_space_entries.find(sid);
+	if (it == free_space_entries.end())
+	    return;
+
+	if (it->second.first == EXTENDED)
+	{
+	    free_space_valid = false;
+	    return;
+	}
+
+	if (it->second.first == LOGICAL)
+	    logical_free_space.remove_used(it->second.second);
+	else
+	    primary_free_space.remove_used(it->second.second);
+
+	free_space_entries.erase(it);
+    }
+
+
+    bool
+    PartitionTable::Impl::get_largest_free_region(bool logical, Region& region) const
+    {
+	lock_guard<std::mutex> lock(free_space_mutex);
+
+	ensure_free_space();
+
+	return (logical ? logical_free_space : primary_free_space).get_largest_free_region(region);
+    }
+
+
+    bool
+    PartitionTable::Impl::get_best_fit_region(unsigned long long length, bool logical,
+					      Region& region) const
+    {
+	lock_guard<std::mutex> lock(free_space_mutex);
+
+	ensure_free_space();
+
+	return (logical ? logical_free_space : primary_free_space).get_best_fit_region(length, region);
     }
 
 
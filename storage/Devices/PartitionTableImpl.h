@@ -2,9 +2,13 @@
 #define PARTITION_TABLE_IMPL_H
 
 
+#include <mutex>
+
 #include "storage/Devices/PartitionTable.h"
 #include "storage/Devices/DeviceImpl.h"
 #include "storage/Utils/Enum.h"
+#include "storage/Utils/FreeSpaceMap.h"
+#include "storage/Utils/DiskImage.h"
 
 
 namespace storage
@@ -56,19 +60,63 @@ namespace storage
 
 	list<PartitionSlotInfo> get_unused_partition_slots(bool all = true, bool logical = true) const;
 
+	bool get_largest_free_region(bool logical, Region& region) const;
+	bool get_best_fit_region(unsigned long long length, bool logical, Region& region) const;
+
+	/**
+	 * Keep the cached free space in sync with the partitions. Called
+	 * when a partition is added, removed or changes its region or
+	 * type. Other changes must invalidate the cache.
+	 */
+	void update_free_space(sid_t sid, PartitionType type, const Region& region) const;
+	void remove_free_space(sid_t sid) const;
+	void invalidate_free_space() const;
+
+	/**
+	 * For TargetMode::IMAGE writes the partition table with all its
+	 * partitions in the devicegraph into the image of the disk.
+	 */
+	void write_image() const;
+
+	/**
+	 * Sectors at the end of a disk image used by the partition table
+	 * itself.
+	 */
+	virtual unsigned long long reserved_image_sectors() const { return 0; }
+
     protected:
 
+	virtual void do_write_image(const DiskImage& image,
+				    const vector<DiskImage::Entry>& entries) const = 0;
+
 	Impl()
-	    : Device::Impl(), read_only(false) {}
+	    : Device::Impl(), read_only(false), free_space_valid(false) {}
 
 	Impl(const xmlNode* node);
 
+	Impl(const Impl& impl);
+
 	virtual void save(xmlNode* node) const override;
 
     private:
 
+	// the following two require free_space_mutex to be locked
+	void ensure_free_space() const;
+	void do_remove_free_space(sid_t sid) const;
+
 	bool read_only;
 
+	/* The free space for primary and extended partitions and the free
+	   space for logical partitions within the extended partition. Built
+	   on demand and then updated incrementally. Since several threads
+	   may read the same devicegraph the cache is guarded by a mutex. */
+
+	mutable std::mutex free_space_mutex;
+	mutable bool free_space_valid;
+	mutable FreeSpaceMap primary_free_space;
+	mutable FreeSpaceMap logical_free_space;
+	mutable map<sid_t, pair<PartitionType, Region>> free_space_entries;
+
     };
 
 }
@@ -8,6 +8,7 @@
 #include "storage/Action.h"
 #include "storage/Utils/StorageDefines.h"
 #include "storage/Utils/SystemCmd.h"
+#include "storage/Utils/OutputProcessor.h"
 
 
 namespace storage
@@ -29,10 +30,27 @@ namespace storage
 
 	blkdevice->get_impl().wait_for_device();
 
+	if (is_image_target())
+	{
+	    string cmd_line = MKSWAPBIN " -f";
+	    if (!get_label().empty())
+		cmd_line += " -L " + quote(get_label());
+	    cout << cmd_line << endl;
+
+	    FractionProgress progress(cmd_line);
+
+	    create_via_file(cmd_line, &progress);
+	    return;
+	}
+
 	string cmd_line = MKSWAPBIN " -f " + quote(blkdevice->get_name());
 	cout << cmd_line << endl;
 
-	SystemCmd cmd(cmd_line);
+	FractionProgress progress(cmd_line);
+
+	SystemCmd cmd;
+	cmd.setOutputProcessor(&progress);
+	cmd.execute(cmd_line);
 	if (cmd.retcode() != 0)
 	    throw runtime_error("create swap failed");
     }
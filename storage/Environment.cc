@@ -86,6 +86,48 @@ namespace storage
     }
 
 
+    const string&
+    Environment::get_trace_filename() const
+    {
+	return get_impl().get_trace_filename();
+    }
+
+
+    void
+    Environment::set_trace_filename(const string& trace_filename)
+    {
+	get_impl().set_trace_filename(trace_filename);
+    }
+
+
+    bool
+    Environment::get_probe_cache() const
+    {
+	return get_impl().get_probe_cache();
+    }
+
+
+    void
+    Environment::set_probe_cache(bool probe_cache)
+    {
+	get_impl().set_probe_cache(probe_cache);
+    }
+
+
+    unsigned int
+    Environment::get_probe_jobs() const
+    {
+	return get_impl().get_probe_jobs();
+    }
+
+
+    void
+    Environment::set_probe_jobs(unsigned int probe_jobs)
+    {
+	get_impl().set_probe_jobs(probe_jobs);
+    }
+
+
     std::ostream&
     operator<<(std::ostream& out, const Environment& environment)
     {
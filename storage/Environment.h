@@ -48,6 +48,31 @@ namespace storage
 	const std::string& get_mockup_filename() const;
 	void set_mockup_filename(const std::string& mockup_filename);
 
+	/**
+	 * If set the commands, actions and waits are recorded and written
+	 * as Chrome trace-event JSON to the file. The environment variable
+	 * LIBSTORAGE_TRACE is used if no filename is set.
+	 */
+	const std::string& get_trace_filename() const;
+	void set_trace_filename(const std::string& trace_filename);
+
+	/**
+	 * If enabled the command output of a standard probe is cached under
+	 * /run and reused by later probes while the devices are unchanged.
+	 * Also enabled by the environment variable LIBSTORAGE_PROBE_CACHE=1.
+	 */
+	bool get_probe_cache() const;
+	void set_probe_cache(bool probe_cache);
+
+	/**
+	 * Number of threads used to probe the disks. 1 probes serially, 0
+	 * uses one thread per CPU. The result does not depend on the number
+	 * of threads. Also set by the environment variable
+	 * LIBSTORAGE_PROBE_JOBS. The default is 1.
+	 */
+	unsigned int get_probe_jobs() const;
+	void set_probe_jobs(unsigned int probe_jobs);
+
 	friend std::ostream& operator<<(std::ostream& out, const Environment& environment);
 
     public:
@@ -9,7 +9,8 @@ namespace storage
 {
 
     Environment::Impl::Impl(bool read_only, ProbeMode probe_mode, TargetMode target_mode)
-	: read_only(read_only), probe_mode(probe_mode), target_mode(target_mode)
+	: read_only(read_only), probe_mode(probe_mode), target_mode(target_mode),
+	  probe_cache(false), probe_jobs(1)
     {
     }
 
@@ -40,6 +41,13 @@ namespace storage
     }
 
 
+    void
+    Environment::Impl::set_trace_filename(const string& trace_filename)
+    {
+	Impl::trace_filename = trace_filename;
+    }
+
+
     std::ostream&
     operator<<(std::ostream& out, const Environment::Impl& environment)
     {
@@ -33,6 +33,15 @@ namespace storage
 	const string& get_mockup_filename() const { return mockup_filename; }
 	void set_mockup_filename(const string& mockup_filename);
 
+	const string& get_trace_filename() const { return trace_filename; }
+	void set_trace_filename(const string& trace_filename);
+
+	bool get_probe_cache() const { return probe_cache; }
+	void set_probe_cache(bool probe_cache) { Impl::probe_cache = probe_cache; }
+
+	unsigned int get_probe_jobs() const { return probe_jobs; }
+	void set_probe_jobs(unsigned int probe_jobs) { Impl::probe_jobs = probe_jobs; }
+
 	friend std::ostream& operator<<(std::ostream& out, const Impl& environment);
 
     private:
@@ -43,6 +52,9 @@ namespace storage
 	string devicegraph_filename;
 	string arch_filename;
 	string mockup_filename;
+	string trace_filename;
+	bool probe_cache;
+	unsigned int probe_jobs;
 
     };
 
@@ -53,7 +53,7 @@ namespace storage
 
 
     EtcFstab::EtcFstab(const string& prefix, bool rootMounted)
-	: prefix(prefix)
+	: prefix(prefix), next_seq(0)
     {
 	y2mil("prefix:" << prefix << " rootMounted:" << rootMounted);
 	if (rootMounted)
@@ -75,10 +75,12 @@ EtcFstab::readFiles()
     y2mil("entries:" << co.size());
 
     AsciiFile fstab(prefix + "/fstab");
-    for (const string& line : fstab.lines())
+    const vector<string_ref> fstab_lines = fstab.views();
+    for (unsigned lineno = 0; lineno < fstab_lines.size(); ++lineno)
 	{
+	const string_ref& line = fstab_lines[lineno];
 	y2mil( "line:\"" << line << "\"" );
-	list<string> l = splitString( line );
+	list<string> l = splitString( line.to_string() );
 	list<string>::const_iterator i = l.begin();
 	if( l.begin()!=l.end() && i->find( '#' )!=0 )
 	    {
@@ -106,11 +108,15 @@ EtcFstab::readFiles()
 	    if( checkNormalFile(p->old.device) )
 		p->old.loop = true;
 	    p->nnew = p->old;
+	    p->lineno = lineno;
+	    p->seq = next_seq++;
 	    co.push_back( *p );
 	    delete p;
 	    }
 	}
 
+    rebuildIndex();
+
     // Support for /etc/cryptotab was dropped from boot.crypto in 2010, see
     // cryptsetup package.
 /*
@@ -150,28 +156,32 @@ EtcFstab::readFiles()
 */
 
     AsciiFile crypttab(prefix + "/crypttab");
-    for (const string& line : crypttab.lines())
+    for (const string_ref& line : crypttab.views())
 	{
 	y2mil( "line:\"" << line << "\"" );
-	list<string> l = splitString( line );
+	list<string> l = splitString( line.to_string() );
 	if( l.size()>=3 )
 	    {
 	    list<string>::const_iterator i = l.begin();
-	    list<Entry>::iterator e = co.begin();
+	    entry_iterator e;
 	    string dmdev = "/dev/mapper/" + *i;
 	    ++i;
 	    y2mil( "dmdev:" << dmdev );
-	    while( e!=co.end() && e->old.device!=dmdev )
-		++e;
-	    Entry *p = NULL;
-	    if( e==co.end() )
+	    if (findIndexed(device_index, dmdev, [&dmdev](const Entry& tmp) {
+		    return tmp.old.device == dmdev;
+		}, e))
 		{
-		co.push_back( Entry() );
-		p = &(co.back());
-		p->old.dentry = *i;
+		unindexEntry(e);
 		}
 	    else
-		p = &(*e);
+		{
+		Entry tmp;
+		tmp.old.dentry = *i;
+		tmp.seq = next_seq++;
+		co.push_back(tmp);
+		e = --co.end();
+		}
+	    Entry *p = &(*e);
 	    p->old.dmcrypt = p->old.crypttab = true;
 	    p->old.noauto = false;
 	    p->old.encr = ENC_LUKS;
@@ -194,6 +204,7 @@ EtcFstab::readFiles()
 		++i;
 		}
 	    p->nnew = p->old;
+	    indexEntry(e);
 	    y2mil( "after crtab " << p->nnew );
 	    }
 	}
@@ -268,38 +279,142 @@ FstabEntry::optUser() const
     return find( opts.begin(), opts.end(), "user" ) != opts.end();
     }
 
-bool
-EtcFstab::findDevice( const string& dev, FstabEntry& entry ) const
+    void
+    EtcFstab::appendEntry(const Entry& entry)
     {
-    list<Entry>::const_iterator i = co.begin();
-    while( i!=co.end() && i->nnew.device != dev )
-	++i;
-    if( i!=co.end() )
-	entry = i->nnew;
-    return( i!=co.end() );
+	co.push_back(entry);
+	co.back().seq = next_seq++;
+	indexEntry(--co.end());
     }
 
-bool
-EtcFstab::findDevice( const list<string>& dl, FstabEntry& entry ) const
+
+    void
+    EtcFstab::indexEntry(entry_iterator it)
     {
-    list<Entry>::const_iterator i = co.begin();
-    while( i!=co.end() &&
-           find( dl.begin(), dl.end(), i->nnew.device )==dl.end() )
-	++i;
-    if( i!=co.end() )
-	entry = i->nnew;
-    return( i!=co.end() );
+	device_index[it->nnew.device].push_back(it);
+	if (it->old.device != it->nnew.device)
+	    device_index[it->old.device].push_back(it);
+
+	dentry_index[it->old.dentry].push_back(it);
+
+	mount_index[it->nnew.mount].push_back(it);
+	if (it->old.mount != it->nnew.mount)
+	    mount_index[it->old.mount].push_back(it);
     }
 
-bool
-EtcFstab::findMount( const string& mount, FstabEntry& entry ) const
+
+    void
+    EtcFstab::unindex(Index& index, const string& key, entry_iterator it)
     {
-    list<Entry>::const_iterator i = co.begin();
-    while( i!=co.end() && i->nnew.mount != mount )
-	++i;
-    if( i!=co.end() )
-	entry = i->nnew;
-    return( i!=co.end() );
+	Index::iterator pos = index.find(key);
+	if (pos == index.end())
+	    return;
+
+	vector<entry_iterator>& its = pos->second;
+	its.erase(remove(its.begin(), its.end(), it), its.end());
+	if (its.empty())
+	    index.erase(pos);
+    }
+
+
+    void
+    EtcFstab::unindexEntry(entry_iterator it)
+    {
+	unindex(device_index, it->nnew.device, it);
+	unindex(device_index, it->old.device, it);
+
+	unindex(dentry_index, it->old.dentry, it);
+
+	unindex(mount_index, it->nnew.mount, it);
+	unindex(mount_index, it->old.mount, it);
+    }
+
+
+    void
+    EtcFstab::rebuildIndex()
+    {
+	device_index.clear();
+	dentry_index.clear();
+	mount_index.clear();
+
+	for (entry_iterator it = co.begin(); it != co.end(); ++it)
+	    indexEntry(it);
+    }
+
+
+    template <typename Pred>
+    bool
+    EtcFstab::findIndexed(const Index& index, const string& key, Pred pred,
+			  entry_iterator& ret) const
+    {
+	Index::const_iterator pos = index.find(key);
+	if (pos == index.end())
+	    return false;
+
+	bool found = false;
+
+	for (entry_iterator it : pos->second)
+	{
+	    if (pred(*it) && (!found || it->seq < ret->seq))
+	    {
+		ret = it;
+		found = true;
+	    }
+	}
+
+	return found;
+    }
+
+
+    bool
+    EtcFstab::findDevice(const string& dev, FstabEntry& entry) const
+    {
+	entry_iterator it;
+	if (!findIndexed(device_index, dev, [&dev](const Entry& e) {
+		    return e.nnew.device == dev;
+		}, it))
+	    return false;
+
+	entry = it->nnew;
+	return true;
+    }
+
+
+    bool
+    EtcFstab::findDevice(const list<string>& dl, FstabEntry& entry) const
+    {
+	bool found = false;
+	entry_iterator ret;
+
+	for (const string& dev : dl)
+	{
+	    entry_iterator it;
+	    if (findIndexed(device_index, dev, [&dev](const Entry& e) {
+			return e.nnew.device == dev;
+		    }, it) && (!found || it->seq < ret->seq))
+	    {
+		ret = it;
+		found = true;
+	    }
+	}
+
+	if (found)
+	    entry = ret->nnew;
+	return found;
+    }
+
+
+    bool
+    EtcFstab::findMount(const string& mount, FstabEntry& entry) const
+    {
+	entry_iterator it;
+	if (!findIndexed(mount_index, mount, [&mount](const Entry& e) {
+		    return e.nnew.mount == mount;
+		}, it))
+	    return false;
+
+	entry = it->nnew;
+	return true;
     }
 
 
@@ -362,12 +477,21 @@ EtcFstab::findMount( const string& mount, FstabEntry& entry ) const
 
 	y2mil("device:" << device << " dentries:" << dentries);
 
-	for (list<Entry>::iterator it = co.begin(); it != co.end(); ++it)
+	for (const string& dentry : dentries)
 	{
-	    if (dentries.find(it->old.dentry) != dentries.end())
+	    Index::const_iterator pos = dentry_index.find(dentry);
+	    if (pos == dentry_index.end())
+		continue;
+
+	    // copy since reindexing modifies the index
+	    const vector<entry_iterator> its = pos->second;
+
+	    for (entry_iterator it : its)
 	    {
 		y2mil("entry old:" << it->nnew);
+		unindexEntry(it);
 		it->nnew.device = it->old.device = device;
+		indexEntry(it);
 		y2mil("entry new:" << it->nnew);
 	    }
 	}
@@ -381,7 +505,7 @@ EtcFstab::findMount( const string& mount, FstabEntry& entry ) const
 	Entry e(Entry::ADD);
 	e.nnew = entry;
 	y2mil("e.nnew " << e.nnew);
-	co.push_back(e);
+	appendEntry(e);
 	return 0;
     }
 
@@ -390,24 +514,22 @@ EtcFstab::findMount( const string& mount, FstabEntry& entry ) const
     EtcFstab::updateEntry(const FstabKey& key, const FstabChange& entry)
     {
 	y2mil("device:" << key.device << " mount:" << key.mount);
-	list<Entry>::iterator it = co.begin();
-	bool found = false;
-	while (it != co.end() && !found)
-	{
-	    if (it->op == Entry::REMOVE ||
-		(it->op != Entry::ADD && (key.device != it->old.device || key.mount != it->old.mount)) ||
-		(it->op == Entry::ADD && (key.device != it->nnew.device || key.mount != it->nnew.mount)))
-		++it;
-	    else
-		found = true;
-	}
-	if (it != co.end())
+	entry_iterator it;
+	bool found = findIndexed(device_index, key.device, [&key](const Entry& e) -> bool {
+	    if (e.op == Entry::REMOVE)
+		return false;
+	    const FstabEntry& tmp = e.op == Entry::ADD ? e.nnew : e.old;
+	    return key.device == tmp.device && key.mount == tmp.mount;
+	}, it);
+	if (found)
 	{
+	    unindexEntry(it);
 	    if (it->op==Entry::NONE)
 		it->op = Entry::UPDATE;
 	    it->nnew = entry;
+	    indexEntry(it);
 	}
-	int ret = (it != co.end()) ? 0 : FSTAB_ENTRY_NOT_FOUND;
+	int ret = found ? 0 : FSTAB_ENTRY_NOT_FOUND;
 	y2mil("ret:" << ret);
 	return ret;
     }
@@ -418,74 +540,351 @@ EtcFstab::findMount( const string& mount, FstabEntry& entry ) const
     {
 	y2mil("device:" << key.device << " mount:" << key.mount);
 
-	for (list<Entry>::iterator it = co.begin(); it != co.end(); ++it)
+	entry_iterator it;
+	if (!findIndexed(device_index, key.device, [&key](const Entry& e) {
+		    return e.op != Entry::REMOVE && e.nnew.device == key.device &&
+			e.nnew.mount == key.mount;
+		}, it))
+	    return FSTAB_ENTRY_NOT_FOUND;
+
+	if (it->op != Entry::ADD)
 	{
-	    if (it->op != Entry::REMOVE && it->nnew.device == key.device &&
-		it->nnew.mount == key.mount)
-	    {
-		if (it->op != Entry::ADD)
-		    it->op = Entry::REMOVE;
-		else
-		    co.erase(it);
+	    it->op = Entry::REMOVE;
+	}
+	else
+	{
+	    unindexEntry(it);
+	    co.erase(it);
+	}
+
+	return 0;
+    }
+
+
+    struct EtcFstab::Line
+    {
+	Line(const string& text, unsigned long long order, int lineno)
+	    : text(text), order(order), lineno(lineno), removed(false) {}
+
+	string text;
+
+	// position in the file, only used for comparison
+	unsigned long long order;
+
+	// line number in the file as read or as saved, -1 if removed
+	int lineno;
+
+	bool removed;
+
+	list<Line>::iterator pos;
+    };
+
+
+    /*
+     * The lines of fstab or cryptotab while flushing. Lines are never
+     * moved or deleted, so inserting and removing lines does not change
+     * the position of other lines. Line numbers are only assigned again
+     * when the file is saved. The lines are indexed by device entry, by
+     * mount point and by the parent directories of the mount point, each
+     * sorted by the position in the file.
+     */
+    class EtcFstab::Lines : private boost::noncopyable
+    {
+    public:
+
+	Lines(const string& name, bool crypto);
+
+	const AsciiFile& file() const { return ascii_file; }
+
+	// line with the given line number of the file as read
+	Line* at(int lineno) const;
+
+	// the first line with the given device entry or mount point
+	Line* find_dentry(const string& dentry) const;
+	Line* find_mount(const string& mount) const;
+
+	// the first line with a mount point below the given mount point
+	Line* find_below(const string& mount) const;
+
+	// before may be nullptr to append the line
+	Line* insert(Line* before, const string& text);
+	Line* append(const string& text) { return insert(nullptr, text); }
+
+	void replace(Line* line, const string& text);
+	void remove(Line* line);
+
+	bool save();
+
+    private:
+
+	struct cmp_order
+	{
+	    bool operator()(const Line* lhs, const Line* rhs) const { return lhs->order < rhs->order; }
+	};
+
+	typedef std::unordered_map<string, set<Line*, cmp_order>> Index;
+
+	static const unsigned long long step = 1 << 20;
+
+	static Line* find(const Index& index, const string& key);
+
+	void index(Line* line);
+	void unindex(Line* line);
+
+	void renumber();
+
+	AsciiFile ascii_file;
+
+	const bool crypto;
+
+	list<Line> lines;
+
+	vector<Line*> original;
+
+	Index dentry_index;
+	Index mount_index;
+	Index below_index;
+
+    };
+
 
-		return 0;
+    EtcFstab::Lines::Lines(const string& name, bool crypto)
+	: ascii_file(name, crypto), crypto(crypto)
+    {
+	const vector<string_ref> views = ascii_file.views();
+
+	original.reserve(views.size());
+
+	for (const string_ref& view : views)
+	{
+	    lines.push_back(Line(view.to_string(), (original.size() + 1) * step, original.size()));
+	    lines.back().pos = std::prev(lines.end());
+	    original.push_back(&lines.back());
+	    index(&lines.back());
+	}
+    }
+
+
+    EtcFstab::Line*
+    EtcFstab::Lines::at(int lineno) const
+    {
+	if (lineno < 0 || (unsigned) lineno >= original.size() || original[lineno]->removed)
+	    return nullptr;
+
+	return original[lineno];
+    }
+
+
+    EtcFstab::Line*
+    EtcFstab::Lines::find(const Index& index, const string& key)
+    {
+	Index::const_iterator it = index.find(key);
+	if (it == index.end() || it->second.empty())
+	    return nullptr;
+
+	return *it->second.begin();
+    }
+
+
+    EtcFstab::Line*
+    EtcFstab::Lines::find_dentry(const string& dentry) const
+    {
+	return find(dentry_index, dentry);
+    }
+
+
+    EtcFstab::Line*
+    EtcFstab::Lines::find_mount(const string& mount) const
+    {
+	return find(mount_index, mount);
+    }
+
+
+    EtcFstab::Line*
+    EtcFstab::Lines::find_below(const string& mount) const
+    {
+	return find(below_index, boost::ends_with(mount, "/") ? mount : mount + "/");
+    }
+
+
+    EtcFstab::Line*
+    EtcFstab::Lines::insert(Line* before, const string& text)
+    {
+	list<Line>::iterator next = before ? before->pos : lines.end();
+
+	unsigned long long low = next == lines.begin() ? 0 : std::prev(next)->order;
+	unsigned long long high = next == lines.end() ? low + 2 * step : next->order;
+
+	if (high - low < 2)
+	{
+	    renumber();
+
+	    low = next == lines.begin() ? 0 : std::prev(next)->order;
+	    high = next == lines.end() ? low + 2 * step : next->order;
+	}
+
+	list<Line>::iterator it = lines.insert(next, Line(text, low + (high - low) / 2, -1));
+	it->pos = it;
+
+	index(&*it);
+
+	return &*it;
+    }
+
+
+    void
+    EtcFstab::Lines::replace(Line* line, const string& text)
+    {
+	unindex(line);
+	line->text = text;
+	index(line);
+    }
+
+
+    void
+    EtcFstab::Lines::remove(Line* line)
+    {
+	unindex(line);
+	line->removed = true;
+    }
+
+
+    bool
+    EtcFstab::Lines::save()
+    {
+	vector<string> tmp;
+	tmp.reserve(lines.size());
+
+	for (Line& line : lines)
+	{
+	    if (line.removed)
+	    {
+		line.lineno = -1;
+	    }
+	    else
+	    {
+		line.lineno = tmp.size();
+		tmp.push_back(line.text);
 	    }
 	}
 
-	return FSTAB_ENTRY_NOT_FOUND;
+	ascii_file.clear();
+	ascii_file.append(tmp);
+
+	return ascii_file.save();
     }
 
 
-    AsciiFile*
-    EtcFstab::findFile(const FstabEntry& e, AsciiFile*& fstab, AsciiFile*& cryptotab,
-		       int& lineno) const
+    void
+    EtcFstab::Lines::index(Line* line)
     {
-    y2mil("dentry:" << e.dentry << " mount:" << e.mount << " fstab:" << fstab <<
-	  " cryptotab:" << cryptotab);
-    AsciiFile* ret=NULL;
-    string reg;
-    if( e.cryptotab )
+	if (line->removed || boost::starts_with(boost::trim_left_copy(line->text), "#"))
+	    return;
+
+	const string dentry = extractNthWord(crypto ? 1 : 0, line->text);
+	if (!dentry.empty())
+	    dentry_index[dentry].insert(line);
+
+	const string mount = extractNthWord(crypto ? 2 : 1, line->text);
+	if (!mount.empty())
 	{
-	if( cryptotab==NULL )
-	    cryptotab = new AsciiFile( prefix + "/cryptotab", true );
-	ret = cryptotab;
-	reg = "[ \t]" + boost::replace_all_copy(fstabEncode(e.dentry), "\\", "\\\\") + "[ \t]";
+	    mount_index[mount].insert(line);
+
+	    for (string::size_type pos = mount.find('/'); pos != string::npos;
+		 pos = mount.find('/', pos + 1))
+		below_index[mount.substr(0, pos + 1)].insert(line);
 	}
-    else
+    }
+
+
+    void
+    EtcFstab::Lines::unindex(Line* line)
+    {
+	if (line->removed || boost::starts_with(boost::trim_left_copy(line->text), "#"))
+	    return;
+
+	const string dentry = extractNthWord(crypto ? 1 : 0, line->text);
+	if (!dentry.empty())
+	    dentry_index[dentry].erase(line);
+
+	const string mount = extractNthWord(crypto ? 2 : 1, line->text);
+	if (!mount.empty())
 	{
-	if( fstab==NULL )
-	    fstab = new AsciiFile( prefix + "/fstab" );
-	ret = fstab;
-	reg = "^[ \t]*" + boost::replace_all_copy(fstabEncode(e.dentry), "\\", "\\\\") + "[ \t]";
+	    mount_index[mount].erase(line);
+
+	    for (string::size_type pos = mount.find('/'); pos != string::npos;
+		 pos = mount.find('/', pos + 1))
+		below_index[mount.substr(0, pos + 1)].erase(line);
 	}
+    }
+
 
-    if (e.mount != "swap")
+    void
+    EtcFstab::Lines::renumber()
     {
-	reg = "[ \t]+" + boost::replace_all_copy(fstabEncode(e.mount), "\\", "\\\\") + "[ \t]";
+	// keeps the relative order so the indexes stay valid
+
+	unsigned long long order = 0;
+
+	for (Line& line : lines)
+	    line.order = (order += step);
     }
 
-	lineno = ret->find_if_idx(regex_matches(reg));
 
-    y2mil("fstab:" << fstab << " cryptotab:" << cryptotab << " lineno:" << lineno);
-    return ret;
+    EtcFstab::Lines*
+    EtcFstab::findFile(const FstabEntry& e, Lines*& fstab, Lines*& cryptotab, Line*& line) const
+    {
+	y2mil("dentry:" << e.dentry << " mount:" << e.mount << " fstab:" << fstab <<
+	      " cryptotab:" << cryptotab);
+
+	Lines* ret = nullptr;
+
+	if (e.cryptotab)
+	{
+	    if (cryptotab == nullptr)
+		cryptotab = new Lines(prefix + "/cryptotab", true);
+	    ret = cryptotab;
+	}
+	else
+	{
+	    if (fstab == nullptr)
+		fstab = new Lines(prefix + "/fstab", false);
+	    ret = fstab;
+	}
+
+	if (e.mount != "swap")
+	    line = ret->find_mount(fstabEncode(e.mount));
+	else
+	    line = ret->find_dentry(fstabEncode(e.dentry));
+
+	y2mil("fstab:" << fstab << " cryptotab:" << cryptotab << " lineno:" <<
+	      (line ? line->lineno : -1));
+	return ret;
     }
 
 
-int EtcFstab::findPrefix( const AsciiFile& tab, const string& mount ) const
+    EtcFstab::Lines*
+    EtcFstab::findEntryFile(const Entry& e, Lines*& fstab, Lines*& cryptotab, Line*& line) const
     {
-    bool crypto = tab.name().find( "/cryptotab" )!=string::npos;
-    y2mil("file:" << tab.name() << " mount:" << mount << " crypto:" << crypto);
-    string reg = "^[ \t]*[^ \t]+";
-    if( crypto )
-	reg += "[ \t]+[^ \t]+";
-    reg += "[ \t]+" + mount;
-    if( mount.length()>0 && mount[mount.length()-1] != '/' )
-	reg += "/";
-    int lineno = tab.find_if_idx(regex_matches(reg));
-    y2mil("reg:" << reg << " lineno:" << lineno);
-    return( lineno );
+	if (!e.old.cryptotab && e.lineno >= 0)
+	{
+	    if (fstab == nullptr)
+		fstab = new Lines(prefix + "/fstab", false);
+
+	    Line* tmp = fstab->at(e.lineno);
+	    if (tmp && fstabDecode(extractNthWord(1, tmp->text)) == e.old.mount)
+	    {
+		line = tmp;
+		return fstab;
+	    }
+
+	    y2war("line " << e.lineno << " does not match mount:" << e.old.mount);
+	}
+
+	return findFile(e.old, fstab, cryptotab, line);
     }
 
+
 bool EtcFstab::findCrtab( const FstabEntry& e, const AsciiFile& tab, 
                           int& lineno ) const
     {
@@ -733,13 +1132,17 @@ void EtcFstab::updateTabLine( list<string>(*fnc)(const FstabEntry&),
 int EtcFstab::flush()
     {
     int ret = 0;
-    AsciiFile *fstab = NULL;
-    AsciiFile *cryptotab = NULL;
-    AsciiFile *cur = NULL;
+    Lines *fstab = NULL;
+    Lines *cryptotab = NULL;
+    Lines *cur = NULL;
     AsciiFile crypttab( prefix + "/crypttab", true );
     if (!co.empty() && !checkDir(prefix))
 	createPath( prefix );
 
+    // lines of added and updated entries in fstab, the line numbers are
+    // only known after saving
+    std::unordered_map<const Entry*, const Line*> entry_lines;
+
     list<Entry>::iterator i = co.begin();
     while( i!=co.end() && ret==0 )
 	{
@@ -748,11 +1151,12 @@ int EtcFstab::flush()
 	    case Entry::REMOVE:
 	    {
 		y2mil("REMOVE:" << i->old.device << " " << i->old.mount);
+		Line* line = NULL;
 		int lineno;
-		cur = findFile( i->old, fstab, cryptotab, lineno );
-		if( lineno>=0 )
+		cur = findEntryFile( *i, fstab, cryptotab, line );
+		if( line )
 		{
-		    cur->remove( lineno, 1 );
+		    cur->remove( line );
 		    if( cur==fstab && i->old.crypttab && 
 		        findCrtab( i->old, crypttab, lineno ))
 			crypttab.remove( lineno, 1 );
@@ -771,36 +1175,44 @@ int EtcFstab::flush()
 	    case Entry::UPDATE:
 	    {
 		y2mil("UPDATE:" << i->nnew.device << " " << i->nnew.mount);
+		Line* line = NULL;
 		int lineno;
-		cur = findFile( i->old, fstab, cryptotab, lineno );
-		if( lineno<0 )
-		    cur = findFile( i->nnew, fstab, cryptotab, lineno );
-		if( lineno>=0 )
+		cur = findEntryFile( *i, fstab, cryptotab, line );
+		if( !line )
+		    cur = findFile( i->nnew, fstab, cryptotab, line );
+		if( line )
 		    {
-		    string line;
+		    string text;
+		    i->lineno = -1;
 		    if( i->old.cryptotab != i->nnew.cryptotab )
 			{
-			cur->remove( lineno, 1 );
-			cur = findFile( i->nnew, fstab, cryptotab, lineno );
-			line = createTabLine( i->nnew );
-			cur->append( line );
+			cur->remove( line );
+			cur = findFile( i->nnew, fstab, cryptotab, line );
+			text = createTabLine( i->nnew );
+			line = cur->append( text );
+			if( cur==fstab )
+			    entry_lines[&*i] = line;
 			}
 		    else if( !i->nnew.mount.empty() )
 			{
-			y2mil( "lineno:" << lineno );
+			y2mil( "lineno:" << line->lineno );
+			text = line->text;
 			updateTabLine( makeStringList,
-				       i->old, i->nnew, (*cur)[lineno] );
+				       i->old, i->nnew, text );
+			cur->replace( line, text );
+			if( cur==fstab )
+			    entry_lines[&*i] = line;
 			}
 		    else
 			{
-			cur->remove(lineno,1);
+			cur->remove( line );
 			}
 		    if( i->old.crypttab > i->nnew.crypttab && 
 		        findCrtab( i->old, crypttab, lineno ))
 			crypttab.remove( lineno, 1 );
 		    if( i->nnew.crypttab )
 			{
-			line = createCrtabLine( i->nnew );
+			text = createCrtabLine( i->nnew );
 			if( findCrtab( i->old, crypttab, lineno ) ||
 			    findCrtab( i->nnew, crypttab, lineno ))
 			    {
@@ -809,7 +1221,7 @@ int EtcFstab::flush()
 			                   i->old, i->nnew, crypttab[lineno] );
 			    }
 			else
-			    crypttab.append( line );
+			    crypttab.append( text );
 			}
 		    i->old = i->nnew;
 		    i->op = Entry::NONE;
@@ -817,9 +1229,11 @@ int EtcFstab::flush()
 		else if( findCrtab( i->nnew, crypttab, lineno ))
 		    {
 		    int oldln; 
-		    string line = createTabLine( i->nnew );
+		    string text = createTabLine( i->nnew );
 		    if (!i->nnew.mount.empty())
-			fstab->append( line );
+			{
+			entry_lines[&*i] = fstab->append( text );
+			}
 		    if( i->old.crypttab > i->nnew.crypttab && 
 		        findCrtab( i->old, crypttab, oldln ))
 			crypttab.remove( oldln, 1 );
@@ -836,46 +1250,57 @@ int EtcFstab::flush()
 
 	    case Entry::ADD:
 		{
+		Line* line = NULL;
 		int lineno;
 		y2mil("ADD:" << i->nnew.device << " " << i->nnew.mount);
-		cur = findFile( i->nnew, fstab, cryptotab, lineno );
-		string line = createTabLine( i->nnew );
+		cur = findFile( i->nnew, fstab, cryptotab, line );
+		string text = createTabLine( i->nnew );
 		string before_dev;
-		if( lineno<0 )
+		if( !line )
 		    {
-		    lineno = findPrefix( *cur, i->nnew.mount );
-		    if( lineno>=0 )
+		    Line* below = cur->find_below( fstabEncode( i->nnew.mount ) );
+		    if( below )
 			{
-			before_dev = extractNthWord( 0, (*cur)[lineno] );
+			before_dev = extractNthWord( 0, below->text );
 			if (!i->nnew.mount.empty())
-			    cur->insert( lineno, line );
+			    {
+			    line = cur->insert( below, text );
+			    if( cur==fstab )
+				entry_lines[&*i] = line;
+			    }
 			}
 		    else
 			{
 			if (!i->nnew.mount.empty())
-			    cur->append( line );
+			    {
+			    line = cur->append( text );
+			    if( cur==fstab )
+				entry_lines[&*i] = line;
+			    }
 			}
 		    }
 		else
 		    {
-		    y2war( "replacing line:" << (*cur)[lineno] );
-		    (*cur)[lineno] = line;
+		    y2war( "replacing line:" << line->text );
+		    cur->replace( line, text );
+		    if( cur==fstab )
+			entry_lines[&*i] = line;
 		    }
 		if( i->nnew.crypttab )
 		    {
-		    line = createCrtabLine( i->nnew );
+		    text = createCrtabLine( i->nnew );
 		    if( findCrtab( i->nnew, crypttab, lineno ))
 			{
-			crypttab[lineno] = line;
+			crypttab[lineno] = text;
 			}
 		    else if( !before_dev.empty() &&
 		             findCrtab( before_dev, crypttab, lineno ))
 			{
-			crypttab.insert( lineno, line );
+			crypttab.insert( lineno, text );
 			}
 		    else
 			{
-			crypttab.append( line );
+			crypttab.append( text );
 			}
 		    }
 		i->old = i->nnew;
@@ -888,9 +1313,19 @@ int EtcFstab::flush()
 		break;
 	    }
 	}
+    rebuildIndex();
     if( fstab != NULL )
 	{
 	fstab->save();
+
+	// renumber the entries once
+	for (Entry& entry : co)
+	    {
+	    std::unordered_map<const Entry*, const Line*>::const_iterator it = entry_lines.find(&entry);
+	    const Line* line = it != entry_lines.end() ? it->second : fstab->at(entry.lineno);
+	    entry.lineno = line ? line->lineno : -1;
+	    }
+
 	delete( fstab );
 	}
     if( cryptotab != NULL )
@@ -25,6 +25,9 @@
 
 #include <string>
 #include <list>
+#include <vector>
+#include <unordered_map>
+#include <boost/noncopyable.hpp>
 #include <boost/algorithm/string.hpp>
 
 #include "storage/StorageInterface.h"
@@ -36,6 +39,7 @@ namespace storage
 {
     using std::string;
     using std::list;
+    using std::vector;
 
 
     class AsciiFile;
@@ -112,7 +116,12 @@ namespace storage
     };
 
 
-    class EtcFstab
+    /*
+     * Entries are indexed by device, by the device entry as written in the
+     * file (UUID=, LABEL=, by-id, by-path, ...) and by mount point, so
+     * lookups do not depend on the number of entries.
+     */
+    class EtcFstab : private boost::noncopyable
     {
     public:
 
@@ -152,20 +161,46 @@ namespace storage
 	struct Entry
 	{
 	    enum Operation { NONE, ADD, UPDATE, REMOVE };
-	    Entry(Operation op = NONE) : op(op) {}
+	    Entry(Operation op = NONE) : op(op), seq(0), lineno(-1) {}
 	    Operation op;
 	    FstabEntry nnew;
 	    FstabEntry old;
+
+	    // position in co, used to return the first match of an index lookup
+	    unsigned seq;
+
+	    // line in fstab file or -1, assigned again after flushing
+	    int lineno;
 	};
 
 	friend EnumInfo<Entry::Operation>;
 
+	typedef list<Entry>::iterator entry_iterator;
+	typedef std::unordered_map<string, vector<entry_iterator>> Index;
+
 	void readFiles();
 
-	int findPrefix( const AsciiFile& tab, const string& mount ) const;
+	void appendEntry(const Entry& entry);
+
+	static void unindex(Index& index, const string& key, entry_iterator it);
 
-	AsciiFile* findFile( const FstabEntry& e, AsciiFile*& fstab,
-			     AsciiFile*& cryptotab, int& lineno ) const;
+	void indexEntry(entry_iterator it);
+	void unindexEntry(entry_iterator it);
+	void rebuildIndex();
+
+	template <typename Pred>
+	bool findIndexed(const Index& index, const string& key, Pred pred,
+			 entry_iterator& ret) const;
+
+	// lines of fstab and cryptotab while flushing, see EtcFstab.cc
+	struct Line;
+	class Lines;
+
+	Lines* findEntryFile(const Entry& e, Lines*& fstab, Lines*& cryptotab,
+			     Line*& line) const;
+
+	Lines* findFile(const FstabEntry& e, Lines*& fstab, Lines*& cryptotab,
+			Line*& line) const;
 
 	bool findCrtab( const FstabEntry& e, const AsciiFile& crtab,
 			int& lineno ) const;
@@ -197,6 +232,12 @@ namespace storage
 
 	string prefix;
 	list<Entry> co;
+
+	unsigned next_seq;
+
+	Index device_index;
+	Index dentry_index;
+	Index mount_index;
     };
 
 
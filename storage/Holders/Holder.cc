@@ -96,6 +96,10 @@ namespace storage
 	    throw runtime_error("holder already exists");
 
 	get_impl().set_devicegraph_and_edge(devicegraph, tmp.first);
+
+	if (devicegraph->get_impl().journal.is_recording())
+	    devicegraph->get_impl().journal.record_add_holder(devicegraph->get_impl().graph[tmp.first],
+							      source->get_sid(), target->get_sid());
     }
 
 
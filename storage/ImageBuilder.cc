@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <exception>
+#include <stdexcept>
+
+#include "storage/ImageBuilder.h"
+#include "storage/Storage.h"
+#include "storage/Environment.h"
+#include "storage/Devicegraph.h"
+#include "storage/Devices/Disk.h"
+#include "storage/Utils/AppUtil.h"
+
+
+namespace storage
+{
+    using namespace std;
+
+
+    void
+    ImageBuilder::build(const map<string, string>& filenames,
+			const CommitCallbacks* commit_callbacks) const
+    {
+	Environment environment(true, ProbeMode::NONE, TargetMode::IMAGE);
+
+	Storage storage(environment);
+
+	Devicegraph* staging = storage.get_staging();
+	devicegraph->copy(*staging);
+
+	for (Disk* disk : Disk::get_all(staging))
+	{
+	    map<string, string>::const_iterator it = filenames.find(disk->get_name());
+	    if (it == filenames.end())
+		throw runtime_error("no image filename for " + disk->get_name());
+
+	    disk->set_name(it->second);
+	}
+
+	storage.commit(commit_callbacks);
+    }
+
+
+    void
+    ImageBuilder::build(const vector<map<string, string>>& filenames, unsigned int jobs) const
+    {
+	if (jobs == 0)
+	    jobs = max(thread::hardware_concurrency(), 1U);
+
+	jobs = min<size_t>(jobs, filenames.size());
+
+	y2mil("building " << filenames.size() << " image sets with " << jobs << " jobs");
+
+	atomic<size_t> next(0);
+
+	mutex error_mutex;
+	exception_ptr error;
+
+	auto worker = [&]() {
+	    for (size_t i = next++; i < filenames.size(); i = next++)
+	    {
+		try
+		{
+		    build(filenames[i]);
+		}
+		catch (const exception& e)
+		{
+		    y2err("building image set " << i << " failed, " << e.what());
+
+		    lock_guard<mutex> lock(error_mutex);
+		    if (!error)
+			error = current_exception();
+		}
+	    }
+	};
+
+	vector<thread> threads;
+	for (unsigned int i = 0; i < jobs; ++i)
+	    threads.emplace_back(worker);
+
+	for (thread& t : threads)
+	    t.join();
+
+	if (error)
+	    rethrow_exception(error);
+    }
+
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#ifndef IMAGE_BUILDER_H
+#define IMAGE_BUILDER_H
+
+
+#include <string>
+#include <vector>
+#include <map>
+
+
+namespace storage
+{
+
+    class Devicegraph;
+    class CommitCallbacks;
+
+
+    /**
+     * Builds disk images from a devicegraph template. For every build the
+     * template is copied into the staging devicegraph of a new Storage
+     * with TargetMode::IMAGE, the disks are renamed to their image files
+     * and the copy is committed. Builds share no state, so several can
+     * run in parallel.
+     *
+     * Mount points and fstab entries of the template are ignored.
+     */
+    class ImageBuilder
+    {
+    public:
+
+	/**
+	 * The devicegraph must stay valid and unchanged while images are
+	 * built.
+	 */
+	ImageBuilder(const Devicegraph* devicegraph) : devicegraph(devicegraph) {}
+
+	/**
+	 * Builds one set of images. The filenames map the names of all
+	 * disks of the template to image files. Existing files are
+	 * overwritten.
+	 */
+	void build(const std::map<std::string, std::string>& filenames,
+		   const CommitCallbacks* commit_callbacks = nullptr) const;
+
+	/**
+	 * Builds several sets of images with up to jobs builds in parallel,
+	 * with 0 the number of CPUs is used. After all builds have finished
+	 * the exception of the first failed build is rethrown.
+	 */
+	void build(const std::vector<std::map<std::string, std::string>>& filenames,
+		   unsigned int jobs = 0) const;
+
+    private:
+
+	const Devicegraph* devicegraph;
+
+    };
+
+}
+
+#endif
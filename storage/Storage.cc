@@ -118,6 +118,20 @@ namespace storage
     }
 
 
+    void
+    Storage::publish_snapshot(const string& name)
+    {
+	get_impl().publish_snapshot(name);
+    }
+
+
+    std::shared_ptr<const Devicegraph>
+    Storage::get_snapshot(const string& name) const
+    {
+	return get_impl().get_snapshot(name);
+    }
+
+
     void
     Storage::check() const
     {
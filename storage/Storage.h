@@ -36,6 +36,10 @@ namespace storage
 	virtual void pre(const Action::Base* action) const {}
 	virtual void post(const Action::Base* action) const {}
 
+	// progress of a long running command of the current action, fraction
+	// is between 0 and 1 and never decreases for one command
+	virtual void progress(const std::string& message, double fraction) const {}
+
     };
 
 
@@ -69,6 +73,24 @@ namespace storage
 
 	const Devicegraph* get_probed() const;
 
+	/**
+	 * Publishes a frozen copy of the named devicegraph. Readers holding
+	 * an older snapshot keep it until they release it. The devicegraph
+	 * "probed" is published after probing and "staging" after commit.
+	 */
+	void publish_snapshot(const std::string& name);
+
+	/**
+	 * Returns the last published snapshot of the named devicegraph. The
+	 * snapshot is immutable and may be used from any thread while other
+	 * threads publish new snapshots. Publishing and all other functions
+	 * modifying the storage object must not be called concurrently.
+	 *
+	 * A snapshot keeps copies of the environment and arch and may outlive
+	 * the storage object. Its get_storage() returns nullptr.
+	 */
+	std::shared_ptr<const Devicegraph> get_snapshot(const std::string& name) const;
+
 	void check() const;
 
 	const std::string& get_rootprefix() const;
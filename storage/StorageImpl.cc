@@ -1,14 +1,27 @@
 
 
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <limits>
+
 #include "config.h"
 #include "storage/StorageImpl.h"
 #include "storage/DevicegraphImpl.h"
 #include "storage/Devices/DiskImpl.h"
 #include "storage/Devices/FilesystemImpl.h"
+#include "storage/Devices/PartitionTableImpl.h"
+#include "storage/Holders/HolderImpl.h"
 #include "storage/SystemInfo/SystemInfo.h"
+#include "storage/SystemInfo/ProcMountinfo.h"
 #include "storage/Actiongraph.h"
 #include "storage/Utils/AppUtil.h"
 #include "storage/Utils/Mockup.h"
+#include "storage/Utils/Enum.h"
+#include "storage/Utils/Tracer.h"
+#include "storage/Utils/ProbeCache.h"
+#include "storage/Utils/Remote.h"
 
 
 namespace storage
@@ -20,6 +33,17 @@ namespace storage
 	y2mil("constructed Storage with " << environment);
 	y2mil("libstorage version " VERSION);
 
+	string trace_filename = environment.get_trace_filename();
+	if (trace_filename.empty())
+	{
+	    const char* tmp = getenv("LIBSTORAGE_TRACE");
+	    if (tmp)
+		trace_filename = tmp;
+	}
+
+	if (!trace_filename.empty())
+	    Tracer::set_filename(trace_filename);
+
 	Devicegraph* probed = create_devicegraph("probed");
 
 	switch (environment.get_probe_mode())
@@ -32,6 +56,7 @@ namespace storage
 		Mockup::set_mode(Mockup::Mode::RECORD);
 		probe(probed);
 		Mockup::save(environment.get_mockup_filename());
+		probe_profile.save(environment.get_mockup_filename() + ".profile");
 	    } break;
 
 	    case ProbeMode::NONE: {
@@ -53,31 +78,148 @@ namespace storage
 	y2mil("probed devicegraph end");
 
 	copy_devicegraph("probed", "staging");
+
+	publish_snapshot("probed");
     }
 
 
     Storage::Impl::~Impl()
     {
+	Tracer::save();
+    }
+
+
+    static bool
+    probe_cache_requested()
+    {
+	const char* tmp = getenv("LIBSTORAGE_PROBE_CACHE");
+	return tmp && strcmp(tmp, "1") == 0;
+    }
+
+
+    static unsigned int
+    probe_jobs(const Environment& environment)
+    {
+	const char* tmp = getenv("LIBSTORAGE_PROBE_JOBS");
+	unsigned int jobs = tmp ? atoi(tmp) : environment.get_probe_jobs();
+
+	if (jobs == 0)
+	    jobs = max(thread::hardware_concurrency(), 1U);
+
+	return jobs;
+    }
+
+
+    /**
+     * Moves all devices and holders of other into devicegraph. The devices
+     * get new sids in the order of the vertices of other.
+     */
+    static void
+    merge_devicegraph(Devicegraph* devicegraph, Devicegraph* other)
+    {
+	Devicegraph::Impl& impl = devicegraph->get_impl();
+	Devicegraph::Impl& other_impl = other->get_impl();
+
+	sid_t sid = Device::Impl::allocate_sids(other_impl.num_devices());
+
+	map<Devicegraph::Impl::vertex_descriptor, Devicegraph::Impl::vertex_descriptor> vertices;
+
+	for (Devicegraph::Impl::vertex_descriptor other_vertex : other_impl.vertices())
+	{
+	    shared_ptr<Device> device = other_impl.graph[other_vertex];
+	    device->get_impl().set_sid(sid++);
+
+	    Devicegraph::Impl::vertex_descriptor vertex = boost::add_vertex(device, impl.graph);
+	    device->get_impl().set_devicegraph_and_vertex(devicegraph, vertex);
+
+	    // the cached free space refers to the old sids
+	    PartitionTable* partition_table = dynamic_cast<PartitionTable*>(device.get());
+	    if (partition_table)
+		partition_table->get_impl().invalidate_free_space();
+
+	    vertices[other_vertex] = vertex;
+	}
+
+	for (Devicegraph::Impl::edge_descriptor other_edge : other_impl.edges())
+	{
+	    shared_ptr<Holder> holder = other_impl.graph[other_edge];
+
+	    pair<Devicegraph::Impl::edge_descriptor, bool> tmp =
+		boost::add_edge(vertices[source(other_edge, other_impl.graph)],
+				vertices[target(other_edge, other_impl.graph)], holder, impl.graph);
+
+	    holder->get_impl().set_devicegraph_and_edge(devicegraph, tmp.first);
+	}
+
+	other_impl.clear();
     }
 
 
     void
     Storage::Impl::probe(Devicegraph* probed)
     {
+	probe_profile.clear();
+
+	ProbeProfile::Record record(probe_profile);
+	ProbeProfile::Scope probe_scope("probe");
+
+	// only real probes may use the cache, it must not mix with mockups
+	unique_ptr<ProbeCache> probe_cache;
+	if (environment.get_probe_mode() == ProbeMode::STANDARD && !get_remote_callbacks() &&
+	    (environment.get_probe_cache() || probe_cache_requested()))
+	    probe_cache.reset(new ProbeCache(PROBE_CACHE_FILE));
+
+	unique_ptr<ProbeCache::Record> probe_cache_record;
+	if (probe_cache)
+	    probe_cache_record.reset(new ProbeCache::Record(*probe_cache));
+
 	SystemInfo systeminfo;
+	systeminfo.prefetch_tools();
 
-	arch = systeminfo.getArch();
+	{
+	    ProbeProfile::Scope scope("arch");
+	    arch = systeminfo.getArch();
+	}
 
-	EtcFstab fstab("/etc");
+	unique_ptr<EtcFstab> fstab;
+
+	{
+	    ProbeProfile::Scope scope("fstab");
+	    fstab.reset(new EtcFstab("/etc"));
+	}
 
 	// TODO
 
-	for (const string& name : Disk::Impl::probe_disks(systeminfo))
+	vector<string> names;
+
 	{
-	    Disk* disk = Disk::create(probed, name);
-	    disk->get_impl().probe(systeminfo);
+	    ProbeProfile::Scope scope("disk discovery");
+	    names = Disk::Impl::probe_disks(systeminfo);
+	    systeminfo.prefetch_disks(names);
+	}
+
+	// the remote callbacks are not required to be thread-safe
+	unsigned int jobs = get_remote_callbacks() ? 1 : probe_jobs(environment);
+
+	if (jobs > 1 && names.size() > 1)
+	{
+	    ProbeProfile::Scope scope("disks");
+
+	    probe_disks(probed, systeminfo, names, jobs);
+	}
+	else
+	{
+	    for (const string& name : names)
+	    {
+		ProbeProfile::Scope scope("Disk " + name);
+
+		Disk* disk = Disk::create(probed, name);
+		disk->get_impl().probe(systeminfo);
+	    }
 	}
 
+	ProbeProfile::Scope filesystems_scope("filesystems");
+
 	for (Devicegraph::Impl::vertex_descriptor vertex : probed->get_impl().vertices())
 	{
 	    BlkDevice* blkdevice = dynamic_cast<BlkDevice*>(probed->get_impl().graph[vertex].get());
@@ -97,11 +239,77 @@ namespace storage
 			entry.fs_type != SWAP)
 			continue;
 
+		    ProbeProfile::Scope scope(toString(entry.fs_type) + " " + blkdevice->get_name());
+
 		    Filesystem* filesystem = blkdevice->create_filesystem(entry.fs_type);
-		    filesystem->get_impl().probe(systeminfo, fstab);
+		    filesystem->get_impl().probe(systeminfo, *fstab);
 		}
 	    }
 	}
+
+	if (probe_cache)
+	{
+	    y2mil("probe cache hits:" << probe_cache->get_hits() << " misses:" <<
+		  probe_cache->get_misses());
+	    probe_cache->save();
+	}
+    }
+
+
+    void
+    Storage::Impl::probe_disks(Devicegraph* probed, SystemInfo& systeminfo,
+			       const vector<string>& names, unsigned int jobs)
+    {
+	// Every disk is probed into a devicegraph of its own. Afterwards the
+	// devicegraphs are merged in the order of the names so that the sids
+	// and the devicegraph do not depend on the scheduling of the threads.
+
+	jobs = min<size_t>(jobs, names.size());
+
+	y2mil("probing " << names.size() << " disks with " << jobs << " jobs");
+
+	vector<unique_ptr<Devicegraph>> devicegraphs(names.size());
+	vector<exception_ptr> errors(names.size());
+
+	atomic<size_t> next(0);
+
+	auto worker = [&]() {
+	    for (size_t i = next++; i < names.size(); i = next++)
+	    {
+		try
+		{
+		    // the sids are replaced when merging, taking them from the
+		    // global counter would make the final sids differ from a
+		    // serial probe
+		    Device::Impl::SidReservation reservation(0, numeric_limits<sid_t>::max());
+
+		    devicegraphs[i].reset(new Devicegraph(&storage));
+
+		    Disk* disk = Disk::create(devicegraphs[i].get(), names[i]);
+		    disk->get_impl().probe(systeminfo);
+		}
+		catch (const exception& e)
+		{
+		    y2err("probing " << names[i] << " failed, " << e.what());
+		    errors[i] = current_exception();
+		}
+	    }
+	};
+
+	vector<thread> threads;
+	for (unsigned int i = 0; i < jobs; ++i)
+	    threads.emplace_back(worker);
+
+	for (thread& t : threads)
+	    t.join();
+
+	// report the same error as a serial probe
+	for (const exception_ptr& error : errors)
+	    if (error)
+		rethrow_exception(error);
+
+	for (const unique_ptr<Devicegraph>& devicegraph : devicegraphs)
+	    merge_devicegraph(probed, devicegraph.get());
     }
 
 
@@ -232,6 +440,43 @@ namespace storage
     }
 
 
+    void
+    Storage::Impl::publish_snapshot(const string& name)
+    {
+	const Devicegraph* devicegraph = static_cast<const Impl*>(this)->get_devicegraph(name);
+
+	// the snapshot may outlive the storage object
+	shared_ptr<Devicegraph> snapshot = make_shared<Devicegraph>();
+	devicegraph->copy(*snapshot);
+	snapshot->get_impl().freeze(environment, arch);
+
+	shared_ptr<const snapshots_t> old_snapshots = atomic_load(&snapshots);
+
+	shared_ptr<snapshots_t> new_snapshots = old_snapshots ?
+	    make_shared<snapshots_t>(*old_snapshots) : make_shared<snapshots_t>();
+	(*new_snapshots)[name] = snapshot;
+
+	atomic_store(&snapshots, shared_ptr<const snapshots_t>(new_snapshots));
+
+	y2mil("published snapshot of " << name);
+    }
+
+
+    shared_ptr<const Devicegraph>
+    Storage::Impl::get_snapshot(const string& name) const
+    {
+	shared_ptr<const snapshots_t> tmp = atomic_load(&snapshots);
+	if (!tmp)
+	    throw runtime_error("snapshot not found");
+
+	snapshots_t::const_iterator it = tmp->find(name);
+	if (it == tmp->end())
+	    throw runtime_error("snapshot not found");
+
+	return it->second;
+    }
+
+
     void
     Storage::Impl::check() const
     {
@@ -244,6 +489,18 @@ namespace storage
     }
 
 
+    const ProcMountinfo&
+    Storage::Impl::get_proc_mountinfo() const
+    {
+	if (!proc_mountinfo)
+	    proc_mountinfo.reset(new ProcMountinfo());
+	else
+	    proc_mountinfo->refresh();
+
+	return *proc_mountinfo;
+    }
+
+
     string
     Storage::Impl::prepend_rootprefix(const string& mountpoint) const
     {
@@ -271,9 +528,21 @@ namespace storage
     {
 	Actiongraph actiongraph(storage, get_probed(), get_staging());
 
-	actiongraph.commit(commit_callbacks);
+	try
+	{
+	    actiongraph.commit(commit_callbacks);
+	}
+	catch (...)
+	{
+	    Tracer::save();
+	    throw;
+	}
+
+	Tracer::save();
 
 	// TODO somehow update probed
+
+	publish_snapshot("staging");
     }
 
 }
@@ -3,16 +3,25 @@
 
 
 #include <map>
+#include <memory>
 
 #include "storage/Storage.h"
 #include "storage/Environment.h"
 #include "storage/SystemInfo/Arch.h"
+#include "storage/Utils/ProbeProfile.h"
 
 
 namespace storage
 {
     using std::string;
     using std::map;
+    using std::shared_ptr;
+    using std::unique_ptr;
+    using std::vector;
+
+
+    class ProcMountinfo;
+    class SystemInfo;
 
 
     class Storage::Impl
@@ -47,6 +56,9 @@ namespace storage
 
 	const Devicegraph* get_probed() const;
 
+	void publish_snapshot(const string& name);
+	shared_ptr<const Devicegraph> get_snapshot(const string& name) const;
+
 	void check() const;
 
 	const string& get_rootprefix() const { return rootprefix; }
@@ -57,10 +69,25 @@ namespace storage
 	std::list<std::string> get_commit_steps() const;
 	void commit(const CommitCallbacks* commit_callbacks);
 
+	/*
+	 * The current mount table. Opened on first use and kept open, only
+	 * parsed again when the kernel reports a change.
+	 */
+	const ProcMountinfo& get_proc_mountinfo() const;
+
+	/*
+	 * Time per probe phase, commands run and SystemInfo cache
+	 * statistics of the last probe.
+	 */
+	const ProbeProfile& get_probe_profile() const { return probe_profile; }
+
     private:
 
 	void probe(Devicegraph* probed);
 
+	void probe_disks(Devicegraph* probed, SystemInfo& systeminfo, const vector<string>& names,
+			 unsigned int jobs);
+
 	const Storage& storage;
 
 	const Environment environment;
@@ -69,8 +96,20 @@ namespace storage
 
 	map<string, Devicegraph> devicegraphs;
 
+	typedef map<string, shared_ptr<const Devicegraph>> snapshots_t;
+
+	/* The published snapshots. The map itself is never modified once
+	   published, publishing a snapshot replaces the whole map using the
+	   atomic shared_ptr functions so that readers never see a partially
+	   modified map and never block. */
+	shared_ptr<const snapshots_t> snapshots;
+
 	string rootprefix;
 
+	mutable unique_ptr<ProcMountinfo> proc_mountinfo;
+
+	ProbeProfile probe_profile;
+
     };
 
 }
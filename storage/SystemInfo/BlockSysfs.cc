@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#include <boost/algorithm/string.hpp>
+
+#include "storage/SystemInfo/BlockSysfs.h"
+#include "storage/Utils/AppUtil.h"
+#include "storage/Utils/SystemCmd.h"
+#include "storage/Utils/StorageDefines.h"
+#include "storage/Utils/StorageTmpl.h"
+
+
+namespace storage
+{
+    using namespace std;
+
+
+    BlockSysfs::BlockSysfs()
+    {
+	SystemCmd cmd(GREPBIN " --with-filename --no-messages ''"
+		      " " SYSFSDIR "/block/*/size " SYSFSDIR "/block/*/*/partition"
+		      " " SYSFSDIR "/block/*/*/size " SYSFSDIR "/block/*/slaves/*/dev"
+		      " " SYSFSDIR "/block/*/dm/name " SYSFSDIR "/block/*/dm/uuid");
+
+	// some globs never match, e.g. without any DM device, so grep fails
+	// even if it found something
+	if (cmd.retcode() > 2)
+	    throw runtime_error("grep for block devices failed");
+
+	parse(cmd.stdout());
+
+	y2mil(*this);
+    }
+
+
+    void
+    BlockSysfs::parse(const vector<string>& lines)
+    {
+	// "*/*/size" also matches files that are no partitions
+	map<string, unsigned long long> sub_sizes;
+
+	const string prefix = SYSFSDIR "/block/";
+
+	for (const string& line : lines)
+	{
+	    string::size_type colon = line.find(':');
+	    if (colon == string::npos || !boost::starts_with(line, prefix))
+	    {
+		y2err("unexpected input " << line);
+		continue;
+	    }
+
+	    const string value = boost::trim_copy(string(line, colon + 1), locale::classic());
+
+	    vector<string> path;
+	    boost::split(path, string(line, prefix.size(), colon - prefix.size()),
+			 boost::is_any_of("/"));
+
+	    for (string& tmp : path)
+		boost::replace_all(tmp, "!", "/");
+
+	    if (path.size() == 2 && path[1] == "size")
+	    {
+		unsigned long long sectors = 0;
+		value >> sectors;
+		data[path[0]].size_k = sectors / 2;
+	    }
+	    else if (path.size() == 3 && path[2] == "partition")
+	    {
+		data[path[1]].disk = path[0];
+	    }
+	    else if (path.size() == 3 && path[2] == "size")
+	    {
+		unsigned long long sectors = 0;
+		value >> sectors;
+		sub_sizes[path[1]] = sectors / 2;
+	    }
+	    else if (path.size() == 4 && path[1] == "slaves" && path[3] == "dev")
+	    {
+		data[path[0]].slaves.push_back(path[2]);
+	    }
+	    else if (path.size() == 3 && path[1] == "dm" && path[2] == "name")
+	    {
+		data[path[0]].dm_name = value;
+	    }
+	    else if (path.size() == 3 && path[1] == "dm" && path[2] == "uuid")
+	    {
+		data[path[0]].dm_uuid = value;
+	    }
+	}
+
+	for (map<string, Entry>::value_type& it : data)
+	{
+	    if (!it.second.disk.empty())
+	    {
+		map<string, unsigned long long>::const_iterator size = sub_sizes.find(it.first);
+		if (size != sub_sizes.end())
+		    it.second.size_k = size->second;
+	    }
+
+	    it.second.slaves.sort();
+	}
+    }
+
+
+    std::ostream& operator<<(std::ostream& s, const BlockSysfs& blocksysfs)
+    {
+	for (const BlockSysfs::value_type& it : blocksysfs)
+	    s << "data[" << it.first << "] -> " << it.second << endl;
+
+	return s;
+    }
+
+
+    std::ostream& operator<<(std::ostream& s, const BlockSysfs::Entry& entry)
+    {
+	s << "size_k:" << entry.size_k;
+
+	if (!entry.disk.empty())
+	    s << " disk:" << entry.disk;
+
+	if (!entry.dm_name.empty())
+	    s << " dm_name:" << entry.dm_name;
+
+	if (!entry.dm_uuid.empty())
+	    s << " dm_uuid:" << entry.dm_uuid;
+
+	if (!entry.slaves.empty())
+	    s << " slaves:" << entry.slaves;
+
+	return s;
+    }
+
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#ifndef BLOCK_SYSFS_H
+#define BLOCK_SYSFS_H
+
+
+#include <string>
+#include <list>
+#include <map>
+#include <vector>
+
+
+namespace storage
+{
+    using std::string;
+    using std::list;
+    using std::map;
+    using std::vector;
+
+
+    /**
+     * Probes all block devices at once: size, partitions, slaves and the
+     * name and uuid of device-mapper devices are read from /sys/block
+     * with a single grep. The keys are the kernel names, e.g. "sda1" or
+     * "dm-0", with '!' replaced by '/'.
+     */
+    class BlockSysfs
+    {
+    public:
+
+	BlockSysfs();
+
+	struct Entry
+	{
+	    Entry() : size_k(0) {}
+
+	    unsigned long long size_k;
+
+	    // only for partitions
+	    string disk;
+
+	    // only for device-mapper devices
+	    string dm_name;
+	    string dm_uuid;
+
+	    list<string> slaves;
+	};
+
+	typedef map<string, Entry>::value_type value_type;
+	typedef map<string, Entry>::const_iterator const_iterator;
+
+	const_iterator begin() const { return data.begin(); }
+	const_iterator end() const { return data.end(); }
+
+	size_t size() const { return data.size(); }
+
+	friend std::ostream& operator<<(std::ostream& s, const BlockSysfs& blocksysfs);
+	friend std::ostream& operator<<(std::ostream& s, const Entry& entry);
+
+    private:
+
+	void parse(const vector<string>& lines);
+
+	map<string, Entry> data;
+
+    };
+
+}
+
+#endif
@@ -56,20 +56,24 @@ namespace storage
 		keysize = extractNthWord(1, line);
 	}
 
+	encrypt_type = get_encrypt_type(type, cipher, keysize);
+    }
+
+
+    EncryptType
+    CmdCryptsetup::get_encrypt_type(const string& type, const string& cipher, const string& keysize)
+    {
 	if (type == "LUKS1")
-	    encrypt_type = ENC_LUKS;
+	    return ENC_LUKS;
 	else if (cipher == "twofish-cbc-plain")
-	    encrypt_type = ENC_TWOFISH;
+	    return ENC_TWOFISH;
 	else if (cipher == "twofish-cbc-null" && keysize == "192")
-	    encrypt_type = ENC_TWOFISH_OLD;
+	    return ENC_TWOFISH_OLD;
 	else if (cipher == "twofish-cbc-null" && keysize == "256")
-	    encrypt_type = ENC_TWOFISH256_OLD;
-	else
-	{
-	    encrypt_type = ENC_UNKNOWN;
-	    y2err("unknown encryption type:" << type << " cipher:" << cipher << " keysize:" <<
-		  keysize);
-	}
+	    return ENC_TWOFISH256_OLD;
+
+	y2err("unknown encryption type:" << type << " cipher:" << cipher << " keysize:" << keysize);
+	return ENC_UNKNOWN;
     }
 
 
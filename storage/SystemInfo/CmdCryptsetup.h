@@ -45,6 +45,15 @@ namespace storage
     public:
 
 	CmdCryptsetup(const string& name);
+	CmdCryptsetup(const string& name, EncryptType encrypt_type)
+	    : encrypt_type(encrypt_type), name(name) {}
+
+	/**
+	 * Determines the encryption type from the type, cipher and keysize
+	 * (in bits) as reported by cryptsetup status.
+	 */
+	static EncryptType get_encrypt_type(const string& type, const string& cipher,
+					    const string& keysize);
 
 	friend std::ostream& operator<<(std::ostream& s, const CmdCryptsetup& cmdcryptsetup);
 
@@ -45,6 +45,10 @@ namespace storage
 
 	CmdDmsetupInfo();
 
+	struct Entry;
+
+	CmdDmsetupInfo(const map<string, Entry>& data) : data(data) {}
+
 	struct Entry
 	{
 	    Entry() : mjr(0), mnr(0), segments(0), uuid() {}
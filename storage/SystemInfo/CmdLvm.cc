@@ -23,6 +23,7 @@
 #include <string>
 #include <list>
 #include <vector>
+#include <functional>
 #include <boost/algorithm/string.hpp>
 
 #include "storage/SystemInfo/CmdLvm.h"
@@ -30,6 +31,7 @@
 #include "storage/Utils/AppUtil.h"
 #include "storage/Utils/StorageDefines.h"
 #include "storage/Utils/StorageTmpl.h"
+#include "storage/Utils/JsonParser.h"
 
 
 namespace storage
@@ -74,6 +76,12 @@ namespace storage
     }
 
 
+    CmdVgdisplay::CmdVgdisplay()
+	: pe_size(0), num_pe(0), free_pe(0), read_only(false), lvm1(false)
+    {
+    }
+
+
     void
     CmdVgdisplay::parse(const vector<string>& lines)
     {
@@ -313,4 +321,269 @@ namespace storage
 	return s;
     }
 
+
+
+    /*
+     * Collects the rows of the output of "lvm fullreport --reportformat json"
+     * and passes them per volume group to CmdLvmFullreport. The output looks
+     * like {"report": [{"vg": [{...}], "pv": [{...}, ...], ...}, ...]}.
+     */
+    class FullreportHandler : public JsonHandler
+    {
+    public:
+
+	FullreportHandler(std::function<void(const CmdLvmFullreport::Report&)> callback)
+	    : callback(callback), depth(0) {}
+
+	virtual void start_object() override
+	{
+	    ++depth;
+	    if (depth == 2)
+		report.clear();
+	    else if (depth == 3)
+		row.clear();
+	}
+
+	virtual void end_object() override
+	{
+	    if (depth == 2)
+		callback(report);
+	    else if (depth == 3)
+		report[section].push_back(row);
+	    --depth;
+	}
+
+	virtual void key(const string& key) override
+	{
+	    if (depth == 2)
+		section = key;
+	    else if (depth == 3)
+		last_key = key;
+	}
+
+	virtual void value(const string& value) override
+	{
+	    if (depth == 3)
+		row[last_key] = value;
+	}
+
+    private:
+
+	const std::function<void(const CmdLvmFullreport::Report&)> callback;
+
+	int depth;
+
+	string section;
+	string last_key;
+
+	CmdLvmFullreport::Report report;
+	CmdLvmFullreport::Row row;
+
+    };
+
+
+    CmdLvmFullreport::CmdLvmFullreport()
+	: supported(false)
+    {
+	SystemCmd c(LVMBIN " fullreport --reportformat json --units k --nosuffix"
+		    " --configreport vg -o vg_name,vg_uuid,vg_attr,vg_fmt,vg_extent_size,"
+		    "vg_extent_count,vg_free_count"
+		    " --configreport pv -o pv_name,pv_uuid,pv_attr,pv_pe_count,pv_pe_alloc_count"
+		    " --configreport lv -o lv_name,lv_uuid,lv_attr,origin,pool_lv"
+		    " --configreport seg -o lv_uuid,seg_size_pe,chunk_size");
+	if (c.retcode() == 0 && !c.stdout().empty())
+	    parse(c.stdout());
+    }
+
+
+    void
+    CmdLvmFullreport::parse(const vector<string>& lines)
+    {
+	vgs.clear();
+
+	FullreportHandler handler(std::bind(&CmdLvmFullreport::add_report, this,
+					    std::placeholders::_1));
+
+	JsonParser parser(handler);
+
+	try
+	{
+	    parser.parse(lines);
+	    supported = true;
+	}
+	catch (const runtime_error& e)
+	{
+	    y2err("failed to parse lvm fullreport: " << e.what());
+	    vgs.clear();
+	}
+
+	y2mil(*this);
+    }
+
+
+    static string
+    get_value(const CmdLvmFullreport::Row& row, const string& key)
+    {
+	CmdLvmFullreport::Row::const_iterator it = row.find(key);
+	return it != row.end() ? it->second : "";
+    }
+
+
+    static char
+    get_attr(const CmdLvmFullreport::Row& row, const string& key, string::size_type i)
+    {
+	string attr = get_value(row, key);
+	return i < attr.size() ? attr[i] : '-';
+    }
+
+
+    void
+    CmdLvmFullreport::add_report(const Report& report)
+    {
+	Report::const_iterator vg_rows = report.find("vg");
+	if (vg_rows == report.end() || vg_rows->second.empty())
+	    return;
+
+	// the report of orphan physical volumes has an empty vg row
+	const Row& vg_row = vg_rows->second.front();
+	if (get_value(vg_row, "vg_name").empty())
+	    return;
+
+	CmdVgdisplay vg;
+
+	vg.name = get_value(vg_row, "vg_name");
+	vg.uuid = get_value(vg_row, "vg_uuid");
+	vg.status = get_attr(vg_row, "vg_attr", 1) == 'z' ? "resizable" : "";
+	vg.read_only = get_attr(vg_row, "vg_attr", 0) == 'r';
+	vg.lvm1 = get_value(vg_row, "vg_fmt") == "lvm1";
+
+	string tmp = get_value(vg_row, "vg_extent_size");
+	string::size_type pos = tmp.find('.');
+	if (pos != string::npos)
+	    tmp.erase(pos);
+	tmp >> vg.pe_size;
+
+	get_value(vg_row, "vg_extent_count") >> vg.num_pe;
+	get_value(vg_row, "vg_free_count") >> vg.free_pe;
+
+	// sum up the segments of each logical volume
+
+	map<string, unsigned long> num_les;
+	map<string, unsigned long long> chunk_sizes;
+
+	Report::const_iterator seg_rows = report.find("seg");
+	if (seg_rows != report.end())
+	{
+	    for (const Row& seg_row : seg_rows->second)
+	    {
+		string lv_uuid = get_value(seg_row, "lv_uuid");
+
+		unsigned long num_le = 0;
+		get_value(seg_row, "seg_size_pe") >> num_le;
+		num_les[lv_uuid] += num_le;
+
+		unsigned long long chunk_size = 0;
+		get_value(seg_row, "chunk_size") >> chunk_size;
+		chunk_sizes[lv_uuid] = chunk_size;
+	    }
+	}
+
+	Report::const_iterator lv_rows = report.find("lv");
+	if (lv_rows != report.end())
+	{
+	    for (const Row& lv_row : lv_rows->second)
+	    {
+		// skip hidden volumes, e.g. thin pool data and metadata, like
+		// vgdisplay does
+		char type = get_attr(lv_row, "lv_attr", 0);
+		string name = get_value(lv_row, "lv_name");
+		if (boost::starts_with(name, "[") || string("iIlTe").find(type) != string::npos)
+		    continue;
+
+		CmdVgdisplay::LvEntry lv_entry;
+		lv_entry.clear();
+
+		lv_entry.name = name;
+		lv_entry.uuid = get_value(lv_row, "lv_uuid");
+		lv_entry.status = get_attr(lv_row, "lv_attr", 4) == 'a' ? "available" : "NOT available";
+		lv_entry.origin = get_value(lv_row, "origin");
+		lv_entry.used_pool = get_value(lv_row, "pool_lv");
+		lv_entry.read_only = get_attr(lv_row, "lv_attr", 1) == 'r';
+		lv_entry.pool = type == 't';
+
+		if (lv_entry.pool)
+		    lv_entry.pool_chunk = chunk_sizes[lv_entry.uuid];
+
+		// vgdisplay reports the size of the origin as current LE of
+		// a snapshot and the size of the snapshot as COW-table LE
+		if (lv_entry.origin.empty())
+		    lv_entry.num_le = num_les[lv_entry.uuid];
+		else
+		    lv_entry.num_cow_le = num_les[lv_entry.uuid];
+
+		vg.lv_entries.push_back(lv_entry);
+	    }
+	}
+
+	for (CmdVgdisplay::LvEntry& lv_entry : vg.lv_entries)
+	{
+	    if (lv_entry.origin.empty())
+		continue;
+
+	    for (const CmdVgdisplay::LvEntry& tmp : vg.lv_entries)
+	    {
+		if (tmp.name == lv_entry.origin)
+		    lv_entry.num_le = tmp.num_le;
+	    }
+	}
+
+	Report::const_iterator pv_rows = report.find("pv");
+	if (pv_rows != report.end())
+	{
+	    for (const Row& pv_row : pv_rows->second)
+	    {
+		CmdVgdisplay::PvEntry pv_entry;
+		pv_entry.clear();
+
+		pv_entry.device = get_value(pv_row, "pv_name");
+		pv_entry.uuid = get_value(pv_row, "pv_uuid");
+		pv_entry.status = get_attr(pv_row, "pv_attr", 0) == 'a' ? "allocatable" : "NOT";
+
+		unsigned long alloc_pe = 0;
+		get_value(pv_row, "pv_pe_count") >> pv_entry.num_pe;
+		get_value(pv_row, "pv_pe_alloc_count") >> alloc_pe;
+		pv_entry.free_pe = pv_entry.num_pe - alloc_pe;
+
+		vg.pv_entries.push_back(pv_entry);
+	    }
+	}
+
+	vgs.push_back(vg);
+    }
+
+
+    const CmdVgdisplay*
+    CmdLvmFullreport::find_vg(const string& name) const
+    {
+	for (const CmdVgdisplay& vg : vgs)
+	{
+	    if (vg.name == name)
+		return &vg;
+	}
+
+	return nullptr;
+    }
+
+
+    std::ostream& operator<<(std::ostream& s, const CmdLvmFullreport& cmdlvmfullreport)
+    {
+	if (!cmdlvmfullreport.supported)
+	    s << "unsupported" << endl;
+
+	for (const CmdVgdisplay& vg : cmdlvmfullreport.vgs)
+	    s << vg;
+
+	return s;
+    }
+
 }
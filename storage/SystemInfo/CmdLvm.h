@@ -27,6 +27,7 @@
 #include <string>
 #include <vector>
 #include <list>
+#include <map>
 
 
 namespace storage
@@ -34,6 +35,7 @@ namespace storage
     using std::string;
     using std::vector;
     using std::list;
+    using std::map;
 
 
     class CmdVgs
@@ -104,10 +106,56 @@ namespace storage
 	list<LvEntry> lv_entries;
 	list<PvEntry> pv_entries;
 
+    private:
+
+	CmdVgdisplay();
+
+	void parse(const vector<string>& lines);
+
+	friend class CmdLvmFullreport;
+
+    };
+
+
+    /**
+     * Gets all volume groups with their logical and physical volumes and
+     * segments with a single "lvm fullreport" call. Avoids the rescan of all
+     * physical volumes per volume group that CmdVgdisplay causes. Older LVM
+     * versions do not support fullreport, in that case is_supported()
+     * returns false.
+     */
+    class CmdLvmFullreport
+    {
+    public:
+
+	CmdLvmFullreport();
+
+	bool is_supported() const { return supported; }
+
+	const list<CmdVgdisplay>& get_vgs() const { return vgs; }
+
+	const CmdVgdisplay* find_vg(const string& name) const;
+
+	friend std::ostream& operator<<(std::ostream& s, const CmdLvmFullreport& cmdlvmfullreport);
+
+	typedef map<string, string> Row;
+
+	/**
+	 * The rows of the subreports (vg, pv, lv, seg, pvseg) of one volume
+	 * group.
+	 */
+	typedef map<string, vector<Row>> Report;
+
     private:
 
 	void parse(const vector<string>& lines);
 
+	void add_report(const Report& report);
+
+	bool supported;
+
+	list<CmdVgdisplay> vgs;
+
     };
 
 }
@@ -50,6 +50,8 @@ namespace storage
 	    list<string> devices;
 	};
 
+	CmdMultipath(const map<string, Entry>& data) : data(data) {}
+
 	list<string> getEntries() const;
 
 	bool getEntry(const string& name, Entry& entry) const;
@@ -46,9 +46,15 @@ namespace storage
     void
     CmdUdevadmInfo::parse(const vector<string>& stdout)
     {
+	string path;
+	string name;
+
 	unsigned int major = 0;
 	unsigned int minor = 0;
 
+	vector<string> by_path_links;
+	vector<string> by_id_links;
+
 	for (const string& line : stdout)
 	{
 	    if (boost::starts_with(line, "P: "))
@@ -70,11 +76,17 @@ namespace storage
 		by_id_links.push_back(line.substr(14));
 	}
 
+	CmdUdevadmInfo::path = path;
+	CmdUdevadmInfo::name = name;
+
 	majorminor = makedev(major, minor);
 
 	sort(by_path_links.begin(), by_path_links.end());
 	sort(by_id_links.begin(), by_id_links.end());
 
+	CmdUdevadmInfo::by_path_links = by_path_links;
+	CmdUdevadmInfo::by_id_links = by_id_links;
+
 	y2mil(*this);
     }
 
@@ -87,10 +99,10 @@ namespace storage
 	  << cmdudevadminfo.get_major() << ":" << cmdudevadminfo.get_minor();
 
 	if (!cmdudevadminfo.by_path_links.empty())
-	    s << " by-path-links:" << cmdudevadminfo.by_path_links;
+	    s << " by-path-links:" << cmdudevadminfo.get_by_path_links();
 
 	if (!cmdudevadminfo.by_id_links.empty())
-	    s << " by-id-links:" << cmdudevadminfo.by_id_links;
+	    s << " by-id-links:" << cmdudevadminfo.get_by_id_links();
 
 	s << endl;
 
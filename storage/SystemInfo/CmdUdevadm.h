@@ -27,6 +27,8 @@
 #include <string>
 #include <vector>
 
+#include "storage/Utils/Interned.h"
+
 
 namespace storage
 {
@@ -59,13 +61,13 @@ namespace storage
 
 	string file;
 
-	string path;
-	string name;
+	Interned<string> path;
+	Interned<string> name;
 
 	dev_t majorminor;
 
-	vector<string> by_path_links;
-	vector<string> by_id_links;
+	Interned<vector<string>> by_path_links;
+	Interned<vector<string>> by_id_links;
 
     };
 
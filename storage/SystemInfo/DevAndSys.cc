@@ -28,6 +28,7 @@
 #include "storage/Utils/StorageTmpl.h"
 #include "storage/Utils/SystemCmd.h"
 #include "storage/Utils/Mockup.h"
+#include "storage/Utils/RemotePrefetch.h"
 #include "storage/Utils/StorageDefines.h"
 
 
@@ -115,7 +116,7 @@ namespace storage
 
 	if (get_remote_callbacks())
 	{
-	    const RemoteFile mockup_file = get_remote_callbacks()->get_file(path);
+	    const RemoteFile mockup_file = RemotePrefetch::get_file(path);
 	    content = mockup_file.content;
 	}
 	else
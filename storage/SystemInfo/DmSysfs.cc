@@ -0,0 +1,420 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/dm-ioctl.h>
+#include <boost/algorithm/string.hpp>
+
+#include "storage/SystemInfo/DmSysfs.h"
+#include "storage/Utils/AppUtil.h"
+#include "storage/Utils/Mockup.h"
+#include "storage/Utils/Remote.h"
+#include "storage/Utils/SystemCmd.h"
+#include "storage/Utils/StorageDefines.h"
+#include "storage/Utils/StorageTmpl.h"
+
+
+namespace storage
+{
+    using namespace std;
+
+
+    // replaces the key of a crypt table by zeros like dmsetup does, keys
+    // in the kernel keyring (":32:logon:...") are only references
+    static void
+    mask_key(const string& type, string& params)
+    {
+	if (type != "crypt")
+	    return;
+
+	string::size_type pos1 = params.find(' ');
+	if (pos1 == string::npos || params.compare(pos1 + 1, 1, ":") == 0)
+	    return;
+
+	string::size_type pos2 = params.find(' ', pos1 + 1);
+	if (pos2 == string::npos)
+	    pos2 = params.size();
+
+	fill(params.begin() + pos1 + 1, params.begin() + pos2, '0');
+    }
+
+
+    // clears a buffer that held unmasked keys, unlike fill() or memset()
+    // the compiler may not drop it although the buffer is freed afterwards
+    static void
+    wipe(vector<char>& buffer)
+    {
+	explicit_bzero(buffer.data(), buffer.size());
+    }
+
+
+    DmSysfs::DmSysfs()
+	: supported(false), cmddmsetupinfo(map<string, CmdDmsetupInfo::Entry>()),
+	  cmdmultipath(map<string, CmdMultipath::Entry>())
+    {
+	SystemCmd cmd(GREPBIN " --with-filename --no-messages ''"
+		      " " SYSFSDIR "/block/dm-*/dm/name " SYSFSDIR "/block/dm-*/dm/uuid"
+		      " " SYSFSDIR "/block/dm-*/dev " SYSFSDIR "/block/dm-*/slaves/*/dev"
+		      " " SYSFSDIR "/block/dm-*/slaves/*/device/vendor"
+		      " " SYSFSDIR "/block/dm-*/slaves/*/device/model");
+
+	// without any DM device the globs do not match and grep fails
+	if (cmd.retcode() != 0 && !(cmd.stdout().empty() && (cmd.retcode() == 1 ||
+							      cmd.retcode() == 2)))
+	    return;
+
+	parse_sysfs(cmd.stdout());
+
+	vector<string> lines;
+	if (!read_tables(lines))
+	    return;
+
+	parse_tables(lines);
+
+	supported = true;
+
+	map<string, CmdDmsetupInfo::Entry> dmsetup_data;
+	map<string, CmdMultipath::Entry> multipath_data;
+
+	for (const value_type& it : data)
+	{
+	    CmdDmsetupInfo::Entry dmsetup_entry;
+	    dmsetup_entry.mjr = it.second.mjr;
+	    dmsetup_entry.mnr = it.second.mnr;
+	    dmsetup_entry.segments = it.second.table.size();
+	    dmsetup_entry.uuid = it.second.uuid;
+	    dmsetup_data[it.first] = dmsetup_entry;
+
+	    if (!it.second.table.empty() && it.second.table.front().type == "multipath")
+	    {
+		CmdMultipath::Entry multipath_entry;
+		multipath_entry.devices = it.second.slaves;
+
+		if (!it.second.slaves.empty())
+		{
+		    const string slave = it.second.slaves.front().substr(5);
+		    map<string, pair<string, string>>::const_iterator info = slave_infos.find(slave);
+		    if (info != slave_infos.end())
+		    {
+			multipath_entry.vendor = info->second.first;
+			multipath_entry.model = info->second.second;
+		    }
+		}
+
+		multipath_data[it.first] = multipath_entry;
+	    }
+	}
+
+	cmddmsetupinfo = CmdDmsetupInfo(dmsetup_data);
+	cmdmultipath = CmdMultipath(multipath_data);
+
+	y2mil(*this);
+    }
+
+
+    void
+    DmSysfs::parse_sysfs(const vector<string>& lines)
+    {
+	struct Raw
+	{
+	    string name;
+	    Entry entry;
+	};
+
+	map<string, Raw> raws;
+
+	const string prefix = SYSFSDIR "/block/";
+
+	for (const string& line : lines)
+	{
+	    string::size_type colon = line.find(':');
+	    if (colon == string::npos || !boost::starts_with(line, prefix))
+	    {
+		y2err("unexpected input " << line);
+		continue;
+	    }
+
+	    const string value = boost::trim_copy(string(line, colon + 1), locale::classic());
+
+	    vector<string> path;
+	    boost::split(path, string(line, prefix.size(), colon - prefix.size()),
+			 boost::is_any_of("/"));
+
+	    Raw& raw = raws[path[0]];
+	    raw.entry.kernel_name = path[0];
+
+	    if (path.size() == 3 && path[1] == "dm" && path[2] == "name")
+	    {
+		raw.name = value;
+	    }
+	    else if (path.size() == 3 && path[1] == "dm" && path[2] == "uuid")
+	    {
+		raw.entry.uuid = value;
+	    }
+	    else if (path.size() == 2 && path[1] == "dev")
+	    {
+		string::size_type pos = value.find(':');
+		if (pos != string::npos)
+		{
+		    value.substr(0, pos) >> raw.entry.mjr;
+		    value.substr(pos + 1) >> raw.entry.mnr;
+		}
+	    }
+	    else if (path.size() == 4 && path[1] == "slaves" && path[3] == "dev")
+	    {
+		raw.entry.slaves.push_back("/dev/" + boost::replace_all_copy(path[2], "!", "/"));
+	    }
+	    else if (path.size() == 5 && path[1] == "slaves" && path[3] == "device")
+	    {
+		const string slave = boost::replace_all_copy(path[2], "!", "/");
+		if (path[4] == "vendor")
+		    slave_infos[slave].first = value;
+		else if (path[4] == "model")
+		    slave_infos[slave].second = value;
+	    }
+	}
+
+	for (map<string, Raw>::value_type& it : raws)
+	{
+	    if (it.second.name.empty())
+	    {
+		y2err("no name for " << it.first);
+		continue;
+	    }
+
+	    it.second.entry.slaves.sort();
+
+	    data[it.second.name] = it.second.entry;
+	}
+    }
+
+
+    void
+    DmSysfs::parse_tables(const vector<string>& lines)
+    {
+	for (const string& line : lines)
+	{
+	    // also skips "No devices found"
+	    string::size_type pos = line.find(": ");
+	    if (pos == string::npos)
+		continue;
+
+	    map<string, Entry>::iterator it = data.find(line.substr(0, pos));
+	    if (it == data.end())
+	    {
+		y2war("table for unknown device " << line.substr(0, pos));
+		continue;
+	    }
+
+	    Target target;
+
+	    string rest = line.substr(pos + 2);
+	    extractNthWord(0, rest) >> target.start;
+	    extractNthWord(1, rest) >> target.length;
+	    target.type = extractNthWord(2, rest);
+	    target.params = extractNthWord(3, rest, true);
+
+	    mask_key(target.type, target.params);
+
+	    it->second.table.push_back(target);
+	}
+    }
+
+
+    bool
+    DmSysfs::read_tables(vector<string>& lines) const
+    {
+	// the ioctls need root and cannot be recorded or played back
+	if (Mockup::get_mode() == Mockup::Mode::NONE && !get_remote_callbacks() &&
+	    read_tables_ioctl(lines))
+	    return true;
+
+	lines.clear();
+
+	SystemCmd cmd(DMSETUPBIN " table");
+	if (cmd.retcode() != 0)
+	    return false;
+
+	lines = cmd.stdout();
+	return true;
+    }
+
+
+    bool
+    DmSysfs::read_tables_ioctl(vector<string>& lines) const
+    {
+	int fd = open("/dev/mapper/control", O_RDWR | O_CLOEXEC);
+	if (fd < 0)
+	    return false;
+
+	vector<char> buffer(16 * 1024);
+
+	// runs the ioctl and enlarges the buffer until the result fits
+	auto run = [fd, &buffer](unsigned long request, const string& name, uint32_t flags) -> dm_ioctl* {
+	    while (true)
+	    {
+		fill(buffer.begin(), buffer.end(), 0);
+
+		dm_ioctl* dmi = reinterpret_cast<dm_ioctl*>(buffer.data());
+		dmi->version[0] = DM_VERSION_MAJOR;
+		dmi->data_size = buffer.size();
+		dmi->data_start = sizeof(dm_ioctl);
+		dmi->flags = flags;
+		strncpy(dmi->name, name.c_str(), DM_NAME_LEN - 1);
+
+		if (ioctl(fd, request, dmi) != 0)
+		    return nullptr;
+
+		if (!(dmi->flags & DM_BUFFER_FULL_FLAG))
+		    return dmi;
+
+		// resize() would free the old buffer without clearing it
+		vector<char> tmp(2 * buffer.size());
+		wipe(buffer);
+		buffer.swap(tmp);
+	    }
+	};
+
+	const dm_ioctl* dmi = run(DM_LIST_DEVICES, "", 0);
+	if (!dmi)
+	{
+	    y2err("DM_LIST_DEVICES failed, " << strerror(errno));
+	    close(fd);
+	    return false;
+	}
+
+	vector<string> names;
+
+	const char* begin = buffer.data() + dmi->data_start;
+	if (dmi->data_size > dmi->data_start)
+	{
+	    const dm_name_list* name_list = reinterpret_cast<const dm_name_list*>(begin);
+	    while (name_list->dev != 0)
+	    {
+		names.push_back(name_list->name);
+		if (name_list->next == 0)
+		    break;
+		name_list = reinterpret_cast<const dm_name_list*>(reinterpret_cast<const char*>(name_list) +
+								   name_list->next);
+	    }
+	}
+
+	for (const string& name : names)
+	{
+	    dmi = run(DM_TABLE_STATUS, name, DM_STATUS_TABLE_FLAG | DM_SECURE_DATA_FLAG);
+	    if (!dmi)
+	    {
+		// the device may have vanished in the meantime
+		y2war("DM_TABLE_STATUS failed for " << name << ", " << strerror(errno));
+		continue;
+	    }
+
+	    const char* data = buffer.data() + dmi->data_start;
+	    const dm_target_spec* spec = reinterpret_cast<const dm_target_spec*>(data);
+
+	    for (uint32_t i = 0; i < dmi->target_count; ++i)
+	    {
+		string type = spec->target_type;
+		string params = reinterpret_cast<const char*>(spec + 1);
+
+		mask_key(type, params);
+
+		lines.push_back(name + ": " + to_string(spec->sector_start) + " " +
+				to_string(spec->length) + " " + type + " " + params);
+
+		spec = reinterpret_cast<const dm_target_spec*>(data + spec->next);
+	    }
+	}
+
+	wipe(buffer);
+
+	close(fd);
+
+	return true;
+    }
+
+
+    bool
+    DmSysfs::get_encrypt_type(const string& name, EncryptType& encrypt_type) const
+    {
+	const_iterator it = data.find(name);
+	if (it == data.end() || it->second.table.empty() || it->second.table.front().type != "crypt")
+	    return false;
+
+	const string& uuid = it->second.uuid;
+	const string& params = it->second.table.front().params;
+
+	string type;
+	if (boost::starts_with(uuid, "CRYPT-LUKS1-"))
+	    type = "LUKS1";
+	else if (boost::starts_with(uuid, "CRYPT-LUKS2-"))
+	    type = "LUKS2";
+
+	const string cipher = extractNthWord(0, params);
+	const string key = extractNthWord(1, params);
+
+	// a key is either hex encoded or given as ":size:type:description"
+	unsigned int keysize = key.size() * 4;
+	if (boost::starts_with(key, ":"))
+	{
+	    unsigned int bytes = 0;
+	    key.substr(1, key.find(':', 1) - 1) >> bytes;
+	    keysize = bytes * 8;
+	}
+
+	encrypt_type = CmdCryptsetup::get_encrypt_type(type, cipher, to_string(keysize));
+	return true;
+    }
+
+
+    std::ostream& operator<<(std::ostream& s, const DmSysfs& dmsysfs)
+    {
+	for (const DmSysfs::value_type& it : dmsysfs)
+	    s << "data[" << it.first << "] -> " << it.second << endl;
+
+	return s;
+    }
+
+
+    std::ostream& operator<<(std::ostream& s, const DmSysfs::Entry& entry)
+    {
+	s << "kernel_name:" << entry.kernel_name << " mjr:" << entry.mjr << " mnr:" << entry.mnr;
+
+	if (!entry.uuid.empty())
+	    s << " uuid:" << entry.uuid;
+
+	// the parameters are not logged since they may contain (masked) keys
+	s << " targets:<";
+	for (size_t i = 0; i < entry.table.size(); ++i)
+	    s << (i == 0 ? "" : " ") << entry.table[i].type;
+	s << ">";
+
+	if (!entry.slaves.empty())
+	    s << " slaves:" << entry.slaves;
+
+	return s;
+    }
+
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#ifndef DM_SYSFS_H
+#define DM_SYSFS_H
+
+
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+
+#include "storage/SystemInfo/CmdDmsetup.h"
+#include "storage/SystemInfo/CmdMultipath.h"
+#include "storage/SystemInfo/CmdCryptsetup.h"
+
+
+namespace storage
+{
+    using std::string;
+    using std::vector;
+    using std::list;
+    using std::map;
+
+
+    /**
+     * Probes all device-mapper devices at once: name, uuid, major and
+     * minor number and the slaves are read from /sys/block/dm-* with a
+     * single grep, the tables of all devices with DM ioctls or, for
+     * mockups, remote probes and non-root users, a single dmsetup table.
+     *
+     * Replaces dmsetup info, multipath -ll and one cryptsetup status per
+     * mapping. Keys of crypt tables are never stored.
+     */
+    class DmSysfs
+    {
+    public:
+
+	DmSysfs();
+
+	struct Target
+	{
+	    Target() : start(0), length(0) {}
+
+	    unsigned long long start;
+	    unsigned long long length;
+	    string type;
+	    string params;
+	};
+
+	struct Entry
+	{
+	    Entry() : mjr(0), mnr(0) {}
+
+	    string kernel_name;
+	    unsigned long mjr;
+	    unsigned long mnr;
+	    string uuid;
+	    vector<Target> table;
+	    list<string> slaves;
+	};
+
+	/**
+	 * False if sysfs or the tables could not be read, the caller should
+	 * fall back to the command line tools.
+	 */
+	bool is_supported() const { return supported; }
+
+	typedef map<string, Entry>::value_type value_type;
+	typedef map<string, Entry>::const_iterator const_iterator;
+
+	const_iterator begin() const { return data.begin(); }
+	const_iterator end() const { return data.end(); }
+
+	const CmdDmsetupInfo& get_cmddmsetupinfo() const { return cmddmsetupinfo; }
+	const CmdMultipath& get_cmdmultipath() const { return cmdmultipath; }
+
+	/**
+	 * Returns false if name is no crypt mapping.
+	 */
+	bool get_encrypt_type(const string& name, EncryptType& encrypt_type) const;
+
+	friend std::ostream& operator<<(std::ostream& s, const DmSysfs& dmsysfs);
+	friend std::ostream& operator<<(std::ostream& s, const Entry& entry);
+
+    private:
+
+	void parse_sysfs(const vector<string>& lines);
+	void parse_tables(const vector<string>& lines);
+
+	bool read_tables(vector<string>& lines) const;
+	bool read_tables_ioctl(vector<string>& lines) const;
+
+	bool supported;
+
+	map<string, Entry> data;
+
+	// vendor and model of the slaves
+	map<string, std::pair<string, string>> slave_infos;
+
+	CmdDmsetupInfo cmddmsetupinfo;
+	CmdMultipath cmdmultipath;
+
+    };
+
+}
+
+#endif
@@ -38,6 +38,49 @@ namespace storage
     using namespace std;
 
 
+    // sets the container fields of entry from the super (metadata) string
+    static void
+    parse_container(ProcMdstat::Entry& entry)
+    {
+	if (!entry.is_container && boost::starts_with(entry.super, "external:"))
+	{
+	    string::size_type pos1 = entry.super.find_first_of("/");
+	    string::size_type pos2 = entry.super.find_last_of("/");
+
+	    if (pos1 != string::npos && pos2 != string::npos && pos1 != pos2)
+	    {
+		entry.has_container = true;
+		entry.container_name = string(entry.super, pos1 + 1, pos2 - pos1 - 1);
+		entry.container_member = string(entry.super, pos2 + 1);
+	    }
+	}
+    }
+
+
+    // maps the raid5 and raid6 layout number (algorithm) to the parity
+    static MdParity
+    algorithm_to_parity(unsigned alg)
+    {
+	switch (alg)
+	{
+	    case 0: return LEFT_ASYMMETRIC;
+	    case 1: return RIGHT_ASYMMETRIC;
+	    case 2: return LEFT_SYMMETRIC;
+	    case 3: return RIGHT_SYMMETRIC;
+	    case 4: return PAR_FIRST;
+	    case 5: return PAR_LAST;
+	    case 16: return LEFT_ASYMMETRIC_6;
+	    case 17: return RIGHT_ASYMMETRIC_6;
+	    case 18: return LEFT_SYMMETRIC_6;
+	    case 19: return RIGHT_SYMMETRIC_6;
+	    case 20: return PAR_FIRST_6;
+	}
+
+	y2war("unknown parity " << alg);
+	return PAR_DEFAULT;
+    }
+
+
     ProcMdstat::ProcMdstat()
     {
 	AsciiFile mdstat("/proc/mdstat");
@@ -158,18 +201,7 @@ namespace storage
 	    string::size_type pos2 = line2.find_first_of(app_ws, pos1);
 	    entry.super = string(line2, pos1, pos2 - pos1);
 
-	    if (!entry.is_container && boost::starts_with(entry.super, "external:"))
-	    {
-		string::size_type pos1 = entry.super.find_first_of("/");
-		string::size_type pos2 = entry.super.find_last_of("/");
-
-		if (pos1 != string::npos && pos2 != string::npos && pos1 != pos2)
-		{
-		    entry.has_container = true;
-		    entry.container_name = string(entry.super, pos1 + 1, pos2 - pos1 - 1);
-		    entry.container_member = string(entry.super, pos2 + 1);
-		}
-	    }
+	    parse_container(entry);
 	}
 
 	entry.md_parity = PAR_DEFAULT;
@@ -180,45 +212,7 @@ namespace storage
 	    pos = line2.find_first_of( app_ws, pos );
 	    pos = line2.find_first_not_of( app_ws, pos );
 	    line2.substr( pos ) >> alg;
-	    switch( alg )
-	    {
-		case 0:
-		    entry.md_parity = LEFT_ASYMMETRIC;
-		    break;
-		case 1:
-		    entry.md_parity = RIGHT_ASYMMETRIC;
-		    break;
-		case 2:
-		    entry.md_parity = LEFT_SYMMETRIC;
-		    break;
-		case 3:
-		    entry.md_parity = RIGHT_SYMMETRIC;
-		    break;
-		case 4:
-		    entry.md_parity = PAR_FIRST;
-		    break;
-		case 5:
-		    entry.md_parity = PAR_LAST;
-		    break;
-		case 16:
-		    entry.md_parity = LEFT_ASYMMETRIC_6;
-		    break;
-		case 17:
-		    entry.md_parity = RIGHT_ASYMMETRIC_6;
-		    break;
-		case 18:
-		    entry.md_parity = LEFT_SYMMETRIC_6;
-		    break;
-		case 19:
-		    entry.md_parity = RIGHT_SYMMETRIC_6;
-		    break;
-		case 20:
-		    entry.md_parity = PAR_FIRST_6;
-		    break;
-		default:
-		    y2war("unknown parity " << line2.substr(pos));
-		    break;
-	    }
+	    entry.md_parity = algorithm_to_parity(alg);
 	}
 	pos = line2.find( "-copies" );
 	if( pos != string::npos )
@@ -346,6 +340,225 @@ namespace storage
     }
 
 
+    MdSysfs::MdSysfs()
+	: supported(false), procmdstat(map<string, ProcMdstat::Entry>())
+    {
+	static const char* array_attributes[] = {
+	    "level", "raid_disks", "chunk_size", "layout", "metadata_version", "array_state", "uuid"
+	};
+
+	static const char* member_attributes[] = { "state", "slot", "size" };
+
+	// the shell expands the globs, files missing on older kernels are
+	// silently skipped
+	string cmd_line = GREPBIN " --with-filename --no-messages ''";
+	for (const char* attribute : array_attributes)
+	    cmd_line += " " SYSFSDIR "/block/md*/md/" + string(attribute);
+	for (const char* attribute : member_attributes)
+	    cmd_line += " " SYSFSDIR "/block/md*/md/dev-*/" + string(attribute);
+	cmd_line += " " SYSFSDIR "/block/md*/size";
+
+	SystemCmd cmd(cmd_line);
+
+	// without any MD array the globs do not match and grep fails
+	supported = cmd.retcode() == 0 || (cmd.stdout().empty() && (cmd.retcode() == 1 ||
+								    cmd.retcode() == 2));
+	if (supported)
+	    parse(cmd.stdout());
+    }
+
+
+    void
+    MdSysfs::parse(const vector<string>& lines)
+    {
+	struct Array
+	{
+	    Array() : size(0) {}
+
+	    map<string, string> attributes;
+	    map<string, map<string, string>> members;
+	    unsigned long long size;
+	};
+
+	map<string, Array> arrays;
+
+	const string prefix = SYSFSDIR "/block/";
+
+	for (const string& line : lines)
+	{
+	    string::size_type colon = line.find(':');
+	    if (colon == string::npos || !boost::starts_with(line, prefix))
+	    {
+		y2err("unexpected input " << line);
+		continue;
+	    }
+
+	    const string path(line, prefix.size(), colon - prefix.size());
+	    const string value(line, colon + 1);
+
+	    string::size_type slash = path.find('/');
+	    if (slash == string::npos)
+		continue;
+
+	    Array& array = arrays[path.substr(0, slash)];
+
+	    const string rest(path, slash + 1);
+
+	    if (rest == "size")
+	    {
+		value >> array.size;
+	    }
+	    else if (boost::starts_with(rest, "md/dev-"))
+	    {
+		string::size_type pos = rest.find('/', 7);
+		if (pos != string::npos)
+		    array.members[rest.substr(7, pos - 7)][rest.substr(pos + 1)] = value;
+	    }
+	    else if (boost::starts_with(rest, "md/"))
+	    {
+		array.attributes[rest.substr(3)] = value;
+	    }
+	}
+
+	map<string, ProcMdstat::Entry> data;
+
+	for (map<string, Array>::value_type& it : arrays)
+	{
+	    const string& name = it.first;
+	    Array& array = it.second;
+
+	    ProcMdstat::Entry entry;
+
+	    const string& level = array.attributes["level"];
+	    if (boost::starts_with(level, "raid"))
+	    {
+		entry.md_type = toValueWithFallback(level, RAID_UNK);
+		if (entry.md_type == RAID_UNK)
+		    y2war("unknown raid type " << level);
+	    }
+	    else
+	    {
+		entry.is_container = true;
+	    }
+
+	    // like /proc/mdstat, which does not mention the default metadata
+	    const string& metadata = array.attributes["metadata_version"];
+	    if (metadata == "none")
+		entry.super = "non-persistent";
+	    else if (metadata != "0.90")
+		entry.super = metadata;
+
+	    parse_container(entry);
+
+	    unsigned long chunk_size = 0;
+	    array.attributes["chunk_size"] >> chunk_size;
+	    if (entry.md_type == RAID0 || entry.md_type == RAID5 || entry.md_type == RAID6 ||
+		entry.md_type == RAID10)
+		entry.chunk_k = chunk_size / 1024;
+
+	    unsigned layout = 0;
+	    array.attributes["layout"] >> layout;
+	    if (entry.md_type == RAID5 || entry.md_type == RAID6)
+	    {
+		entry.md_parity = algorithm_to_parity(layout);
+	    }
+	    else if (entry.md_type == RAID10)
+	    {
+		unsigned near = layout & 0xff;
+		unsigned far = (layout >> 8) & 0xff;
+		bool offset = layout & 0x10000;
+
+		if (near > 1)
+		    entry.md_parity = near == 3 ? PAR_NEAR_3 : PAR_NEAR_2;
+		else if (far > 1 && offset)
+		    entry.md_parity = far == 3 ? PAR_OFFSET_3 : PAR_OFFSET_2;
+		else if (far > 1)
+		    entry.md_parity = far == 3 ? PAR_FAR_3 : PAR_FAR_2;
+	    }
+
+	    MdArrayState array_state = toValueWithFallback(array.attributes["array_state"], UNKNOWN);
+	    entry.inactive = array_state == INACTIVE || array_state == CLEAR;
+	    entry.readonly = entry.inactive || array_state == READONLY || array_state == READ_AUTO;
+
+	    // active members ordered by slot, spares by name
+	    map<unsigned long, string> devices;
+	    unsigned long long members_size_k = 0;
+
+	    for (map<string, map<string, string>>::value_type& member : array.members)
+	    {
+		string device = "/dev/" + boost::replace_all_copy(member.first, "!", "/");
+
+		unsigned long long size_k = 0;
+		member.second["size"] >> size_k;
+		members_size_k += size_k;
+
+		const string& slot = member.second["slot"];
+		if (boost::contains(member.second["state"], "spare") || slot.empty() || slot == "none")
+		{
+		    entry.spares.push_back(device);
+		}
+		else
+		{
+		    unsigned long tmp = 0;
+		    slot >> tmp;
+		    devices[tmp] = device;
+		}
+	    }
+
+	    for (const map<unsigned long, string>::value_type& device : devices)
+		entry.devices.push_back(device.second);
+
+	    // an inactive array has no size, /proc/mdstat shows the sum of the
+	    // members instead
+	    entry.size_k = entry.inactive ? members_size_k : array.size / 2;
+
+	    data[name] = entry;
+
+	    // sysfs shows the uuid like 35dd06d4-b4e9-e248-9262-c3ad02b61654
+	    // while mdadm uses 35dd06d4:b4e9e248:9262c3ad:02b61654
+	    string uuid = boost::erase_all_copy(array.attributes["uuid"], "-");
+	    if (uuid.size() == 32 && !entry.is_container && !entry.has_container)
+	    {
+		for (int i = 3; i > 0; --i)
+		    uuid.insert(8 * i, ":");
+
+		Detail& detail = details[name];
+		detail.uuid = uuid;
+		detail.metadata = metadata;
+	    }
+	}
+
+	procmdstat = ProcMdstat(data);
+
+	y2mil(*this);
+    }
+
+
+    bool
+    MdSysfs::get_detail(const string& name, string& uuid, string& metadata) const
+    {
+	map<string, Detail>::const_iterator it = details.find(name);
+	if (it == details.end())
+	    return false;
+
+	uuid = it->second.uuid;
+	metadata = it->second.metadata;
+	return true;
+    }
+
+
+    std::ostream& operator<<(std::ostream& s, const MdSysfs& mdsysfs)
+    {
+	s << mdsysfs.procmdstat;
+
+	for (const map<string, MdSysfs::Detail>::value_type& it : mdsysfs.details)
+	    s << "detail[" << it.first << "] -> uuid:" << it.second.uuid << " metadata:"
+	      << it.second.metadata << endl;
+
+	return s;
+    }
+
+
     MdadmExamine::MdadmExamine(const list<string>& devices)
 	: devices(devices)
     {
@@ -44,6 +44,10 @@ namespace storage
 
 	ProcMdstat();
 
+	struct Entry;
+
+	ProcMdstat(const map<string, Entry>& data) : data(data) {}
+
 	struct Entry
 	{
 	    Entry() : md_type(RAID_UNK), md_parity(PAR_DEFAULT), size_k(0), chunk_k(0),
@@ -98,6 +102,9 @@ namespace storage
     public:
 
 	MdadmDetail(const string& device);
+	MdadmDetail(const string& device, const string& uuid, const string& devname,
+		    const string& metadata)
+	    : uuid(uuid), devname(devname), metadata(metadata), device(device) {}
 
 	string uuid;
 	string devname;
@@ -114,6 +121,57 @@ namespace storage
     };
 
 
+    /**
+     * Reads level, raid_disks, chunk_size, layout, metadata_version,
+     * array_state, uuid and the state, slot and size of the members of all
+     * MD arrays from /sys/block/mdX/md with a single grep, instead of
+     * parsing /proc/mdstat and running mdadm --detail per array.
+     *
+     * The devname and, for containers and their members, the uuid and
+     * metadata are not available in sysfs, see get_detail().
+     */
+    class MdSysfs
+    {
+    public:
+
+	MdSysfs();
+
+	/**
+	 * False if the sysfs could not be read, the caller should fall back
+	 * to ProcMdstat and MdadmDetail.
+	 */
+	bool is_supported() const { return supported; }
+
+	const ProcMdstat& get_procmdstat() const { return procmdstat; }
+
+	/**
+	 * Gets the uuid (in mdadm format) and metadata of the array name,
+	 * e.g. "md0". Returns false if sysfs does not provide them, so for
+	 * containers, their members and kernels without the uuid attribute.
+	 */
+	bool get_detail(const string& name, string& uuid, string& metadata) const;
+
+	friend std::ostream& operator<<(std::ostream& s, const MdSysfs& mdsysfs);
+
+    private:
+
+	void parse(const vector<string>& lines);
+
+	bool supported;
+
+	ProcMdstat procmdstat;
+
+	struct Detail
+	{
+	    string uuid;
+	    string metadata;
+	};
+
+	map<string, Detail> details;
+
+    };
+
+
     class MdadmExamine
     {
     public:
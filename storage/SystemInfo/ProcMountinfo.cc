@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "storage/Utils/AppUtil.h"
+#include "storage/Utils/AsciiFile.h"
+#include "storage/Utils/Mockup.h"
+#include "storage/Utils/Remote.h"
+#include "storage/SystemInfo/ProcMountinfo.h"
+
+
+#define PROC_MOUNTINFO "/proc/self/mountinfo"
+
+
+namespace storage
+{
+    using namespace std;
+
+
+    ProcMountinfo::ProcMountinfo()
+	: fd(-1)
+    {
+	if (Mockup::get_mode() != Mockup::Mode::PLAYBACK && !get_remote_callbacks())
+	{
+	    fd = open(PROC_MOUNTINFO, O_RDONLY | O_CLOEXEC);
+	    if (fd < 0)
+		y2err("opening " PROC_MOUNTINFO " failed, errno:" << errno);
+	}
+
+	read();
+    }
+
+
+    ProcMountinfo::~ProcMountinfo()
+    {
+	if (fd >= 0)
+	    close(fd);
+    }
+
+
+    bool
+    ProcMountinfo::refresh(int timeout)
+    {
+	if (fd < 0)
+	    return false;
+
+	struct pollfd pfd;
+	pfd.fd = fd;
+	pfd.events = POLLPRI;
+	pfd.revents = 0;
+
+	int ret;
+	while ((ret = poll(&pfd, 1, timeout)) < 0 && errno == EINTR)
+	    ;
+
+	if (ret <= 0 || !(pfd.revents & POLLPRI))
+	    return false;
+
+	y2mil("mount table changed");
+
+	read();
+
+	return true;
+    }
+
+
+    void
+    ProcMountinfo::read()
+    {
+	// older mockups do not include the file, then nothing is considered
+	// mounted as before
+	if (Mockup::get_mode() == Mockup::Mode::PLAYBACK && !Mockup::has_file(PROC_MOUNTINFO))
+	{
+	    y2mil("no mockup for " PROC_MOUNTINFO);
+	    parse({});
+	    return;
+	}
+
+	AsciiFile file(PROC_MOUNTINFO);
+
+	parse(file.views());
+    }
+
+
+    // Decodes the octal escapes the kernel uses for space, tab, newline
+    // and backslash.
+    static string
+    decode(string_ref s)
+    {
+	string ret;
+	ret.reserve(s.size());
+
+	for (size_t i = 0; i < s.size(); ++i)
+	{
+	    if (s[i] == '\\' && i + 3 < s.size() && isdigit(s[i + 1]) && isdigit(s[i + 2]) &&
+		isdigit(s[i + 3]))
+	    {
+		ret += (char)((s[i + 1] - '0') * 64 + (s[i + 2] - '0') * 8 + (s[i + 3] - '0'));
+		i += 3;
+	    }
+	    else
+	    {
+		ret += s[i];
+	    }
+	}
+
+	return ret;
+    }
+
+
+    static vector<string_ref>
+    split_fields(string_ref line)
+    {
+	vector<string_ref> ret;
+
+	size_t pos = 0;
+	while (pos < line.size())
+	{
+	    size_t end = pos;
+	    while (end < line.size() && line[end] != ' ')
+		++end;
+	    if (end > pos)
+		ret.push_back(line.substr(pos, end - pos));
+	    pos = end + 1;
+	}
+
+	return ret;
+    }
+
+
+    void
+    ProcMountinfo::parse(const vector<string_ref>& lines)
+    {
+	entries.clear();
+	device_index.clear();
+	mountpoint_index.clear();
+
+	entries.reserve(lines.size());
+
+	for (const string_ref& line : lines)
+	{
+	    // 36 35 98:0 /mnt1 /mnt/parent rw,noatime master:1 - ext3 /dev/root rw,errors=continue
+
+	    const vector<string_ref> fields = split_fields(line);
+
+	    vector<string_ref>::const_iterator sep = find(fields.begin(), fields.end(), "-");
+	    if (fields.size() < 6 || sep == fields.end() || fields.end() - sep < 3)
+	    {
+		y2war("invalid line:" << line);
+		continue;
+	    }
+
+	    Entry entry;
+
+	    entry.mount_id = atoi(fields[0].to_string().c_str());
+	    entry.parent_id = atoi(fields[1].to_string().c_str());
+
+	    unsigned int major = 0, minor = 0;
+	    string major_minor = fields[2].to_string();
+	    if (sscanf(major_minor.c_str(), "%u:%u", &major, &minor) != 2)
+		y2war("invalid major:minor:" << major_minor);
+	    entry.majorminor = gnu_dev_makedev(major, minor);
+
+	    entry.root = decode(fields[3]);
+	    entry.mountpoint = decode(fields[4]);
+	    entry.options = fields[5].to_string();
+	    entry.fs_type = decode(sep[1]);
+	    entry.device = decode(sep[2]);
+
+	    device_index[entry.device].push_back(entries.size());
+
+	    // later entries are mounted on top of earlier ones
+	    mountpoint_index[entry.mountpoint] = entries.size();
+
+	    entries.push_back(entry);
+	}
+
+	y2mil("entries:" << entries.size());
+    }
+
+
+    vector<string>
+    ProcMountinfo::get_mountpoints(const string& device) const
+    {
+	vector<string> ret;
+
+	map<string, vector<size_t>>::const_iterator it = device_index.find(device);
+	if (it != device_index.end())
+	{
+	    for (size_t i : it->second)
+		ret.push_back(entries[i].mountpoint);
+	}
+
+	return ret;
+    }
+
+
+    string
+    ProcMountinfo::get_device(const string& mountpoint) const
+    {
+	map<string, size_t>::const_iterator it = mountpoint_index.find(mountpoint);
+	if (it == mountpoint_index.end())
+	    return "";
+
+	return entries[it->second].device;
+    }
+
+
+    bool
+    ProcMountinfo::is_mounted(const string& device, const string& mountpoint) const
+    {
+	map<string, vector<size_t>>::const_iterator it = device_index.find(device);
+	if (it == device_index.end())
+	    return false;
+
+	for (size_t i : it->second)
+	{
+	    if (entries[i].mountpoint == mountpoint)
+		return true;
+	}
+
+	return false;
+    }
+
+
+    std::ostream&
+    operator<<(std::ostream& s, const ProcMountinfo& procmountinfo)
+    {
+	for (const ProcMountinfo::Entry& entry : procmountinfo.entries)
+	{
+	    s << "mount-id:" << entry.mount_id << " parent-id:" << entry.parent_id << " major:"
+	      << entry.get_major() << " minor:" << entry.get_minor() << " root:" << entry.root
+	      << " mountpoint:" << entry.mountpoint << " fs-type:" << entry.fs_type
+	      << " device:" << entry.device << endl;
+	}
+
+	return s;
+    }
+
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#ifndef PROC_MOUNTINFO_H
+#define PROC_MOUNTINFO_H
+
+
+#include <sys/types.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <boost/noncopyable.hpp>
+#include <boost/utility/string_ref.hpp>
+
+
+namespace storage
+{
+    using std::string;
+    using std::vector;
+    using std::map;
+    using boost::string_ref;
+
+
+    /*
+     * The mount table of /proc/self/mountinfo. The file is kept open and
+     * polled for POLLPRI, which the kernel signals whenever the mount
+     * table changes, so that the table is only parsed again after a
+     * change.
+     */
+    class ProcMountinfo : private boost::noncopyable
+    {
+    public:
+
+	struct Entry
+	{
+	    Entry() : mount_id(0), parent_id(0), majorminor(0) {}
+
+	    unsigned int get_major() const { return gnu_dev_major(majorminor); }
+	    unsigned int get_minor() const { return gnu_dev_minor(majorminor); }
+
+	    unsigned mount_id;
+	    unsigned parent_id;
+	    dev_t majorminor;
+	    string root;
+	    string mountpoint;
+	    string options;
+	    string fs_type;
+	    string device;
+	};
+
+	ProcMountinfo();
+	~ProcMountinfo();
+
+	/*
+	 * Waits up to timeout milliseconds (-1 waits forever) for a change
+	 * of the mount table and parses it again if it changed. Returns
+	 * whether the mount table was parsed again.
+	 */
+	bool refresh(int timeout = 0);
+
+	const vector<Entry>& get_entries() const { return entries; }
+
+	vector<string> get_mountpoints(const string& device) const;
+
+	// device of the topmost mount at mountpoint
+	string get_device(const string& mountpoint) const;
+
+	bool is_mounted(const string& device, const string& mountpoint) const;
+
+	friend std::ostream& operator<<(std::ostream& s, const ProcMountinfo& procmountinfo);
+
+    protected:
+
+	void read();
+	void parse(const vector<string_ref>& lines);
+
+	int fd;
+
+	vector<Entry> entries;
+
+	map<string, vector<size_t>> device_index;
+	map<string, size_t> mountpoint_index;
+
+    };
+
+}
+
+#endif
@@ -20,8 +20,11 @@
  */
 
 
+#include <boost/algorithm/string.hpp>
+
 #include "storage/Utils/StorageDefines.h"
 #include "storage/Utils/SystemCmd.h"
+#include "storage/Utils/RemotePrefetch.h"
 #include "storage/SystemInfo/SystemInfo.h"
 
 
@@ -37,6 +40,217 @@ namespace storage
     SystemInfo::~SystemInfo()
     {
 	y2deb("destructed SystemInfo");
+
+	RemotePrefetch::clear();
+    }
+
+
+    void
+    SystemInfo::prefetch(const vector<string>& commands, const vector<string>& files)
+    {
+	RemotePrefetch::prefetch(commands, files);
+    }
+
+
+    void
+    SystemInfo::prefetch_tools()
+    {
+	// must match the commands of the SystemInfo classes, a mismatch only
+	// costs a round trip
+	const vector<string> commands = {
+	    UNAMEBIN " -m",
+	    TESTBIN " -d '/sys/firmware/efi/vars'",
+	    LSBIN " -1 --sort=none " + quote(SYSFSDIR "/block"),
+	    BLKIDBIN " -c '/dev/null'",
+	    LSSCSIBIN " --transport"
+	};
+
+	const vector<string> files = {
+	    "/proc/partitions", "/proc/mounts", "/proc/swaps", "/etc/fstab", "/etc/crypttab"
+	};
+
+	prefetch(commands, files);
+    }
+
+
+    void
+    SystemInfo::prefetch_udevadm_infos(const vector<string>& devices)
+    {
+	vector<string> commands;
+
+	for (const string& device : devices)
+	    commands.push_back(UDEVADMBIN " info " + quote(device));
+
+	prefetch(commands, {});
+    }
+
+
+    void
+    SystemInfo::prefetch_disks(const vector<string>& disks)
+    {
+	vector<string> commands;
+	vector<string> files;
+
+	for (const string& disk : disks)
+	{
+	    commands.push_back(PARTEDBIN " -s " + quote(disk) + " unit cyl print unit s print");
+
+	    const CmdUdevadmInfo& udevadminfo = getCmdUdevadmInfo(disk);
+	    files.push_back(SYSFSDIR + udevadminfo.get_path() + "/queue/rotational");
+	}
+
+	prefetch(commands, files);
+    }
+
+
+    const ProcMdstat&
+    SystemInfo::getProcMdstat()
+    {
+	// sysfs provides the same data, fall back to /proc/mdstat if it
+	// cannot be read, e.g. for mockups recorded without it
+
+	try
+	{
+	    const MdSysfs& md_sysfs = mdsysfs.get();
+	    if (md_sysfs.is_supported())
+		return md_sysfs.get_procmdstat();
+	}
+	catch (const exception& e)
+	{
+	    y2war("md sysfs failed: " << e.what());
+	}
+
+	return procmdstat.get();
+    }
+
+
+    const MdadmDetail&
+    SystemInfo::getMdadmDetail(const string& device)
+    {
+	// sysfs provides everything but the devname for arrays with internal
+	// metadata, so mdadm is only run for containers and their members
+
+	lock_guard<mutex> lock(sysfs_mdadmdetails_mutex);
+
+	map<string, MdadmDetail>::const_iterator it = sysfs_mdadmdetails.find(device);
+	if (it != sysfs_mdadmdetails.end())
+	    return it->second;
+
+	try
+	{
+	    const MdSysfs& md_sysfs = mdsysfs.get();
+
+	    string name = boost::starts_with(device, "/dev/") ? device.substr(5) : device;
+
+	    string uuid, metadata;
+	    if (md_sysfs.is_supported() && md_sysfs.get_detail(name, uuid, metadata))
+	    {
+		string devname;
+
+		// /dev/md only exists if some array has a name
+		try
+		{
+		    const MdLinks& md_links = mdlinks.get();
+		    MdLinks::const_iterator link = md_links.find(name);
+		    if (link != md_links.end() && !link->second.empty())
+			devname = link->second.front();
+		}
+		catch (const exception& e)
+		{
+		}
+
+		MdadmDetail detail(device, uuid, devname, metadata);
+		y2mil(detail);
+
+		return sysfs_mdadmdetails.emplace(device, detail).first->second;
+	    }
+	}
+	catch (const exception& e)
+	{
+	    y2war("md sysfs failed: " << e.what());
+	}
+
+	return mdadmdetails.get(device);
+    }
+
+
+    const DmSysfs*
+    SystemInfo::getDmSysfs()
+    {
+	// dmsetup, multipath and cryptsetup are used if the tables cannot
+	// be read, e.g. for mockups recorded without them
+
+	try
+	{
+	    const DmSysfs& dm_sysfs = dmsysfs.get();
+	    if (dm_sysfs.is_supported())
+		return &dm_sysfs;
+	}
+	catch (const exception& e)
+	{
+	    y2war("dm sysfs failed: " << e.what());
+	}
+
+	return nullptr;
+    }
+
+
+    const CmdDmsetupInfo&
+    SystemInfo::getCmdDmsetupInfo()
+    {
+	const DmSysfs* dm_sysfs = getDmSysfs();
+	if (dm_sysfs)
+	    return dm_sysfs->get_cmddmsetupinfo();
+
+	return cmddmsetupinfo.get();
+    }
+
+
+    const CmdMultipath&
+    SystemInfo::getCmdMultipath()
+    {
+	const DmSysfs* dm_sysfs = getDmSysfs();
+	if (dm_sysfs)
+	    return dm_sysfs->get_cmdmultipath();
+
+	return cmdmultipath.get();
+    }
+
+
+    const CmdCryptsetup&
+    SystemInfo::getCmdCryptsetup(const string& name)
+    {
+	lock_guard<mutex> lock(sysfs_cmdcryptsetups_mutex);
+
+	map<string, CmdCryptsetup>::const_iterator it = sysfs_cmdcryptsetups.find(name);
+	if (it != sysfs_cmdcryptsetups.end())
+	    return it->second;
+
+	const DmSysfs* dm_sysfs = getDmSysfs();
+
+	EncryptType encrypt_type;
+	if (dm_sysfs && dm_sysfs->get_encrypt_type(name, encrypt_type))
+	    return sysfs_cmdcryptsetups.emplace(name, CmdCryptsetup(name, encrypt_type)).first->second;
+
+	return cmdcryptsetups.get(name);
+    }
+
+
+    const CmdVgdisplay&
+    SystemInfo::getCmdVgdisplay(const string& name)
+    {
+	// a single lvm fullreport replaces one vgdisplay call per volume
+	// group, fall back to vgdisplay for LVM versions without fullreport
+
+	const CmdLvmFullreport& fullreport = cmdlvmfullreport.get();
+	if (fullreport.is_supported())
+	{
+	    const CmdVgdisplay* vg = fullreport.find_vg(name);
+	    if (vg)
+		return *vg;
+	}
+
+	return vgdisplays.get(name);
     }
 
 }
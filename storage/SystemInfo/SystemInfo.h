@@ -24,9 +24,11 @@
 #define SYSTEM_INFO_H
 
 
+#include <mutex>
 #include <boost/noncopyable.hpp>
 
 #include "storage/SystemInfo/Arch.h"
+#include "storage/SystemInfo/BlockSysfs.h"
 #include "storage/SystemInfo/ProcParts.h"
 #include "storage/SystemInfo/ProcMounts.h"
 #include "storage/SystemInfo/ProcMdstat.h"
@@ -35,6 +37,7 @@
 #include "storage/SystemInfo/CmdParted.h"
 #include "storage/SystemInfo/CmdDasdview.h"
 #include "storage/SystemInfo/CmdDmsetup.h"
+#include "storage/SystemInfo/DmSysfs.h"
 #include "storage/SystemInfo/CmdCryptsetup.h"
 #include "storage/SystemInfo/CmdDmraid.h"
 #include "storage/SystemInfo/CmdMultipath.h"
@@ -42,12 +45,14 @@
 #include "storage/SystemInfo/CmdLvm.h"
 #include "storage/SystemInfo/CmdUdevadm.h"
 #include "storage/SystemInfo/DevAndSys.h"
+#include "storage/Utils/ProbeProfile.h"
 
 
 namespace storage
 {
     using std::map;
     using std::list;
+    using std::vector;
 
 
     class SystemInfo : private boost::noncopyable
@@ -64,41 +69,72 @@ namespace storage
 	const MdLinks& getMdLinks() { return mdlinks.get(); }
 	const ProcParts& getProcParts() { return procparts.get(); }
 	const ProcMounts& getProcMounts() { return procmounts.get(); }
-	const ProcMdstat& getProcMdstat() { return procmdstat.get(); }
-	const MdadmDetail& getMdadmDetail(const string& device) { return mdadmdetails.get(device); }
+	const ProcMdstat& getProcMdstat();
+	const MdadmDetail& getMdadmDetail(const string& device);
 	const MdadmExamine& getMdadmExamine(const list<string>& devices) { return mdadmexamines.get(devices); }
 	const Blkid& getBlkid() { return blkid.get(); }
+	const BlockSysfs& getBlockSysfs() { return blocksysfs.get(); }
 	const Lsscsi& getLsscsi() { return lsscsi.get(); }
 	const Parted& getParted(const string& device) { return parteds.get(device); }
 	const Dasdview& getDasdview(const string& device) { return dasdviews.get(device); }
-	const CmdDmsetupInfo& getCmdDmsetupInfo() { return cmddmsetupinfo.get(); }
-	const CmdCryptsetup& getCmdCryptsetup(const string& name) { return cmdcryptsetups.get(name); }
+	const CmdDmsetupInfo& getCmdDmsetupInfo();
+	const CmdCryptsetup& getCmdCryptsetup(const string& name);
 	const CmdDmraid& getCmdDmraid() { return cmddmraid.get(); }
-	const CmdMultipath& getCmdMultipath() { return cmdmultipath.get(); }
+	const CmdMultipath& getCmdMultipath();
 	const CmdBtrfsShow& getCmdBtrfsShow() { return cmdbtrfsshow.get(); }
 	const CmdVgs& getCmdVgs() { return cmdvgs.get(); }
-	const CmdVgdisplay& getCmdVgdisplay(const string& name) { return vgdisplays.get(name); }
+	const CmdLvmFullreport& getCmdLvmFullreport() { return cmdlvmfullreport.get(); }
+	const CmdVgdisplay& getCmdVgdisplay(const string& name);
 	const MajorMinor& getMajorMinor(const string& device) { return majorminors.get(device); }
 	const CmdUdevadmInfo& getCmdUdevadmInfo(const string& file) { return cmdudevadminfos.get(file); }
 
+	/* With remote callbacks the probe requests the commands and files it
+	   knows it will need in batches, see RemotePrefetch. Without remote
+	   callbacks these functions do nothing. */
+
+	void prefetch(const vector<string>& commands, const vector<string>& files);
+
+	// the commands run once per probe and the files in /proc and /etc
+	void prefetch_tools();
+
+	void prefetch_udevadm_infos(const vector<string>& devices);
+
+	// parted and the sysfs attributes of disks, requires the udevadm info
+	// of the disks
+	void prefetch_disks(const vector<string>& disks);
+
     private:
 
+	// nullptr if the DM devices cannot be probed via sysfs
+	const DmSysfs* getDmSysfs();
+
 	/* LazyObject and LazyObjects cache the object and a potential
 	   exception during object construction. HelperBase does the common
-	   part. */
+	   part. The objects are constructed only once even if several threads
+	   request them, see Environment::set_probe_jobs(). */
 
 	template <class Object, typename... Args>
-	class HelperBase
+	class HelperBase : private boost::noncopyable
 	{
 	public:
 
 	    const Object& get(Args... args)
 	    {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		ProbeProfile* profile = ProbeProfile::get_current();
+
 		if (e)
+		{
+		    if (profile)
+			profile->record_lookup(typeid(Object), true, 0.0);
 		    rethrow_exception(e);
+		}
 
 		if (!object)
 		{
+		    StopWatch stopwatch;
+
 		    try
 		    {
 			object.reset(new Object(args...));
@@ -106,8 +142,17 @@ namespace storage
 		    catch (exception)
 		    {
 			e = current_exception();
+			if (profile)
+			    profile->record_lookup(typeid(Object), false, stopwatch.read());
 			rethrow_exception(e);
 		    }
+
+		    if (profile)
+			profile->record_lookup(typeid(Object), false, stopwatch.read());
+		}
+		else if (profile)
+		{
+		    profile->record_lookup(typeid(Object), true, 0.0);
 		}
 
 		return *object;
@@ -115,13 +160,15 @@ namespace storage
 
 	private:
 
+	    std::mutex mutex;
+
 	    shared_ptr<Object> object;
 	    exception_ptr e;
 
 	};
 
 	template <class Object>
-	class LazyObject : public HelperBase<Object>, private boost::noncopyable
+	class LazyObject : public HelperBase<Object>
 	{
 	};
 
@@ -134,14 +181,26 @@ namespace storage
 
 	    const Object& get(const Key& k)
 	    {
-		typename map<Key, Helper>::iterator pos = data.lower_bound(k);
-		if (pos == data.end() || typename map<Key, Helper>::key_compare()(k, pos->first))
-		    pos = data.insert(pos, typename map<Key, Helper>::value_type(k, Helper()));
-		return pos->second.get(k);
+		Helper* helper;
+
+		{
+		    std::lock_guard<std::mutex> lock(mutex);
+
+		    typename map<Key, Helper>::iterator pos = data.lower_bound(k);
+		    if (pos == data.end() || typename map<Key, Helper>::key_compare()(k, pos->first))
+			pos = data.emplace_hint(pos, std::piecewise_construct, std::forward_as_tuple(k),
+						std::forward_as_tuple());
+		    helper = &pos->second;
+		}
+
+		// the map lock is not held while the object is constructed
+		return helper->get(k);
 	    }
 
 	private:
 
+	    std::mutex mutex;
+
 	    map<Key, Helper> data;
 
 	};
@@ -153,18 +212,26 @@ namespace storage
 	LazyObject<ProcParts> procparts;
 	LazyObject<ProcMounts> procmounts;
 	LazyObject<ProcMdstat> procmdstat;
+	LazyObject<MdSysfs> mdsysfs;
 	LazyObjects<MdadmDetail> mdadmdetails;
+	map<string, MdadmDetail> sysfs_mdadmdetails;
+	std::mutex sysfs_mdadmdetails_mutex;
 	LazyObjects<MdadmExamine, list<string>> mdadmexamines;
 	LazyObject<Blkid> blkid;
+	LazyObject<BlockSysfs> blocksysfs;
 	LazyObject<Lsscsi> lsscsi;
 	LazyObjects<Parted> parteds;
 	LazyObjects<Dasdview> dasdviews;
+	LazyObject<DmSysfs> dmsysfs;
 	LazyObject<CmdDmsetupInfo> cmddmsetupinfo;
 	LazyObjects<CmdCryptsetup> cmdcryptsetups;
+	map<string, CmdCryptsetup> sysfs_cmdcryptsetups;
+	std::mutex sysfs_cmdcryptsetups_mutex;
 	LazyObject<CmdDmraid> cmddmraid;
 	LazyObject<CmdMultipath> cmdmultipath;
 	LazyObject<CmdBtrfsShow> cmdbtrfsshow;
 	LazyObject<CmdVgs> cmdvgs;
+	LazyObject<CmdLvmFullreport> cmdlvmfullreport;
 	LazyObjects<CmdVgdisplay> vgdisplays;
 	LazyObjects<MajorMinor> majorminors;
 	LazyObjects<CmdUdevadmInfo> cmdudevadminfos;
@@ -31,7 +31,9 @@
 #include <sys/utsname.h>
 #include <dirent.h>
 #include <string>
+#include <vector>
 #include <iostream>
+#include <mutex>
 #include <boost/algorithm/string.hpp>
 #include <boost/io/ios_state.hpp>
 
@@ -355,6 +357,10 @@ bool isNfsDev( const string& dev )
     }
 
 
+    // the log callbacks need not be thread-safe
+    static std::mutex log_mutex;
+
+
     void
     logStreamClose( LogLevel level, const char* file, unsigned line,
 		    const char* func, ostringstream* stream )
@@ -362,6 +368,8 @@ bool isNfsDev( const string& dev )
 	CallbackLogDo pfc = getLogDoCallback();
 	if (pfc != NULL)
 	{
+	    std::lock_guard<std::mutex> lock(log_mutex);
+
 	    string content = stream->str();
 	    string::size_type pos1 = 0;
 	    while (true)
@@ -507,6 +515,37 @@ string afterLast(const string& s, const string& pat )
     }
 
 
+    static vector<uint32_t>
+    make_crc32_table()
+    {
+	vector<uint32_t> table(256);
+
+	for (uint32_t i = 0; i < 256; ++i)
+	{
+	    uint32_t c = i;
+	    for (int j = 0; j < 8; ++j)
+		c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+	    table[i] = c;
+	}
+
+	return table;
+    }
+
+
+    uint32_t
+    crc32(const void* data, size_t size)
+    {
+	static const vector<uint32_t> table = make_crc32_table();
+
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+	uint32_t crc = 0xffffffff;
+	for (size_t i = 0; i < size; ++i)
+	    crc = table[(crc ^ bytes[i]) & 0xff] ^ (crc >> 8);
+	return crc ^ 0xffffffff;
+    }
+
+
     string
     sformat(const string& format, va_list ap)
     {
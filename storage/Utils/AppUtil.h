@@ -26,6 +26,7 @@
 #include <libintl.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <stdint.h>
 #include <sstream>
 #include <locale>
 #include <string>
@@ -77,6 +78,12 @@ std::map<string,string> makeMap( const std::list<string>& l,
 
     bool mkdtemp(string& path);
 
+    /**
+     * CRC-32 as used by GPT. Unlike std::hash the value is the same in
+     * every process and library version.
+     */
+    uint32_t crc32(const void* data, size_t size);
+
     string normalizeDevice(const string& dev);
     list<string> normalizeDevices(const list<string>& devs);
     string undevDevice(const string& dev);
@@ -21,12 +21,18 @@
 
 
 #include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
 #include <unistd.h>
-#include <fstream>
+#include <sys/stat.h>
+#include <sys/uio.h>
 
 #include "storage/Utils/AppUtil.h"
 #include "storage/Utils/AsciiFile.h"
 #include "storage/Utils/Mockup.h"
+#include "storage/Utils/RemotePrefetch.h"
 #include "storage/Utils/StorageTypes.h"
 
 
@@ -37,7 +43,8 @@ namespace storage
 
 AsciiFile::AsciiFile(const char* Name_Cv, bool remove_empty)
     : Name_C(Name_Cv),
-      remove_empty(remove_empty)
+      remove_empty(remove_empty),
+      copied(false)
 {
     reload();
 }
@@ -45,19 +52,80 @@ AsciiFile::AsciiFile(const char* Name_Cv, bool remove_empty)
 
 AsciiFile::AsciiFile(const string& Name_Cv, bool remove_empty)
     : Name_C(Name_Cv),
-      remove_empty(remove_empty)
+      remove_empty(remove_empty),
+      copied(false)
 {
     reload();
 }
 
 
+    static bool
+    read_file(const string& name, string& buffer)
+    {
+	int fd = open(name.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+	    return false;
+
+	// files in /proc report a size of zero, so read until end of file
+	struct stat st;
+	if (fstat(fd, &st) == 0 && st.st_size > 0)
+	    buffer.reserve(st.st_size);
+
+	char tmp[65536];
+
+	while (true)
+	{
+	    ssize_t n = read(fd, tmp, sizeof(tmp));
+	    if (n < 0 && errno == EINTR)
+		continue;
+	    if (n < 0)
+	    {
+		y2err("reading " << name << " failed, errno:" << errno);
+		close(fd);
+		buffer.clear();
+		return false;
+	    }
+	    if (n == 0)
+		break;
+	    buffer.append(tmp, n);
+	}
+
+	close(fd);
+
+	return true;
+    }
+
+
+    static vector<string>
+    to_strings(const vector<string_ref>& views)
+    {
+	vector<string> ret;
+	ret.reserve(views.size());
+
+	for (const string_ref& view : views)
+	    ret.push_back(view.to_string());
+
+	return ret;
+    }
+
+
     bool
     AsciiFile::reload()
     {
+	Buffer_C.reset();
+	Views_C.clear();
+	Lines_C.clear();
+	copied = false;
+
 	if (Mockup::get_mode() == Mockup::Mode::PLAYBACK)
 	{
 	    const Mockup::File& mockup_file = Mockup::get_file(Name_C);
-	    Lines_C = mockup_file.content;
+
+	    string buffer;
+	    for (const string& line : mockup_file.content)
+		buffer += line + '\n';
+
+	    set_buffer(std::move(buffer));
 	    return true;
 	}
 
@@ -65,53 +133,128 @@ AsciiFile::AsciiFile(const string& Name_Cv, bool remove_empty)
 
 	if (get_remote_callbacks())
 	{
-	    const RemoteFile remote_file = get_remote_callbacks()->get_file(Name_C);
+	    const RemoteFile remote_file = RemotePrefetch::get_file(Name_C);
 	    Lines_C = remote_file.content;
+	    copied = true;
 	    ret = true;
 	}
 	else
 	{
 	    y2mil("loading file " << Name_C);
-	    clear();
-
-	    ifstream File_Ci(Name_C);
-	    classic(File_Ci);
-	    string Line_Ci;
 
-	    ret = File_Ci.good();
-	    File_Ci.unsetf(ifstream::skipws);
-	    getline( File_Ci, Line_Ci );
-	    while( File_Ci.good() )
-	    {
-		Lines_C.push_back( Line_Ci );
-		getline( File_Ci, Line_Ci );
-	    }
+	    string buffer;
+	    ret = read_file(Name_C, buffer);
+	    set_buffer(std::move(buffer));
 	}
 
 	if (Mockup::get_mode() == Mockup::Mode::RECORD)
 	{
-	    Mockup::set_file(Name_C, Lines_C);
+	    Mockup::set_file(Name_C, copied ? Lines_C : to_strings(Views_C));
 	}
 
 	return ret;
     }
 
 
+    void
+    AsciiFile::set_buffer(string&& buffer)
+    {
+	Buffer_C = std::make_shared<const string>(std::move(buffer));
+	Views_C.clear();
+
+	const string& tmp = *Buffer_C;
+	string::size_type pos = 0;
+	while (pos < tmp.size())
+	{
+	    string::size_type end = tmp.find('\n', pos);
+	    if (end == string::npos)
+		end = tmp.size();
+	    Views_C.push_back(string_ref(tmp.data() + pos, end - pos));
+	    pos = end + 1;
+	}
+    }
+
+
+    void
+    AsciiFile::copy_lines() const
+    {
+	if (copied)
+	    return;
+
+	Lines_C = to_strings(Views_C);
+	copied = true;
+    }
+
+
+    vector<string_ref>
+    AsciiFile::views() const
+    {
+	if (!copied)
+	    return Views_C;
+
+	return vector<string_ref>(Lines_C.begin(), Lines_C.end());
+    }
+
+
+    static bool
+    write_lines(int fd, const vector<string_ref>& lines)
+    {
+	static char newline = '\n';
+
+	vector<struct iovec> iov;
+	iov.reserve(2 * lines.size());
+
+	for (const string_ref& line : lines)
+	{
+	    iov.push_back({ const_cast<char*>(line.data()), line.size() });
+	    iov.push_back({ &newline, 1 });
+	}
+
+	struct iovec* pos = iov.data();
+	size_t left = iov.size();
+
+	while (left > 0)
+	{
+	    ssize_t n = writev(fd, pos, min<size_t>(left, IOV_MAX));
+	    if (n < 0 && errno == EINTR)
+		continue;
+	    if (n <= 0)
+		return false;
+
+	    // skip what has been written, writev may write partially
+	    size_t done = n;
+	    while (left > 0 && done >= pos->iov_len)
+	    {
+		done -= pos->iov_len;
+		++pos;
+		--left;
+	    }
+	    if (done > 0)
+	    {
+		pos->iov_base = static_cast<char*>(pos->iov_base) + done;
+		pos->iov_len -= done;
+	    }
+	}
+
+	return true;
+    }
+
+
 bool
 AsciiFile::save()
 {
     if (Mockup::get_mode() == Mockup::Mode::PLAYBACK)
     {
-	Mockup::set_file(Name_C, Lines_C);
+	Mockup::set_file(Name_C, copied ? Lines_C : to_strings(Views_C));
 	return true;
     }
 
     if (Mockup::get_mode() == Mockup::Mode::RECORD)
     {
-	Mockup::set_file(Name_C, Lines_C);
+	Mockup::set_file(Name_C, copied ? Lines_C : to_strings(Views_C));
     }
 
-    if (remove_empty && Lines_C.empty())
+    if (remove_empty && numLines() == 0)
     {
 	y2mil("deleting file " << Name_C);
 
@@ -124,15 +267,57 @@ AsciiFile::save()
     {
 	y2mil("saving file " << Name_C);
 
-	ofstream file(Name_C);
-	classic(file);
+	// Write to a temporary file in the same directory and rename it over
+	// the original so that readers never see a partially written file.
+	// A symbolic link is kept by replacing its target. Owner and mode
+	// of an existing file are kept.
+
+	string real_name = Name_C;
+
+	struct stat st;
+	bool exists = stat(Name_C.c_str(), &st) == 0;
+
+	if (exists)
+	{
+	    char* tmp = realpath(Name_C.c_str(), nullptr);
+	    if (!tmp)
+	    {
+		y2err("resolving " << Name_C << " failed, errno:" << errno);
+		return false;
+	    }
+
+	    real_name = tmp;
+	    free(tmp);
+	}
+
+	string tmp_name = real_name + ".XXXXXX";
+	int fd = mkstemp(&tmp_name[0]);
+	if (fd < 0)
+	{
+	    y2err("creating temporary file for " << real_name << " failed, errno:" << errno);
+	    return false;
+	}
+
+	bool ok = true;
 
-	for (vector<string>::const_iterator it = Lines_C.begin(); it != Lines_C.end(); ++it)
-	    file << *it << std::endl;
+	if (exists)
+	    ok = fchown(fd, st.st_uid, st.st_gid) == 0 && fchmod(fd, st.st_mode & 07777) == 0;
+	else
+	    ok = fchmod(fd, 0644) == 0;
+
+	ok = ok && write_lines(fd, views());
+
+	ok = ok && fsync(fd) == 0;
+	ok = close(fd) == 0 && ok;
+	ok = ok && rename(tmp_name.c_str(), real_name.c_str()) == 0;
 
-	file.close();
+	if (!ok)
+	{
+	    y2err("saving file " << real_name << " failed, errno:" << errno);
+	    unlink(tmp_name.c_str());
+	}
 
-	return file.good();
+	return ok;
     }
 }
 
@@ -141,13 +326,14 @@ AsciiFile::save()
     AsciiFile::logContent() const
     {
 	y2mil("content of " << Name_C);
-	for (vector<string>::const_iterator it = Lines_C.begin(); it != Lines_C.end(); ++it)
-	    y2mil(*it);
+	for (const string_ref& line : views())
+	    y2mil(line);
     }
 
 
 void AsciiFile::append( const string& Line_Cv )
     {
+    copy_lines();
     string::size_type Idx_ii;
     string Line_Ci = Line_Cv;
 
@@ -187,11 +373,13 @@ void
 AsciiFile::clear()
 {
     Lines_C.clear();
+    copied = true;
 }
 
 
 void AsciiFile::remove( unsigned int Start_iv, unsigned int Cnt_iv )
     {
+    copy_lines();
     Start_iv = max( 0u, Start_iv );
     if( Start_iv < Lines_C.size() )
 	{
@@ -209,6 +397,7 @@ void AsciiFile::remove( unsigned int Start_iv, unsigned int Cnt_iv )
 
 void AsciiFile::insert( unsigned int Before_iv, const string& Line_Cv )
     {
+    copy_lines();
     unsigned int Idx_ii = Lines_C.size();
     if( Before_iv>=Idx_ii )
 	{
@@ -246,12 +435,14 @@ void AsciiFile::insert( unsigned int Before_iv, const string& Line_Cv )
 
 const string& AsciiFile::operator [] ( unsigned int Idx_iv ) const
     {
+    copy_lines();
     assert( Idx_iv < Lines_C.size( ) );
     return Lines_C[Idx_iv];
     }
 
 string& AsciiFile::operator [] ( unsigned int Idx_iv )
     {
+    copy_lines();
     assert( Idx_iv < Lines_C.size( ) );
     return Lines_C[Idx_iv];
     }
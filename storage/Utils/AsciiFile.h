@@ -26,15 +26,27 @@
 
 #include <string>
 #include <vector>
+#include <memory>
 #include <algorithm>
+#include <boost/utility/string_ref.hpp>
 
 
 namespace storage
 {
     using std::string;
     using std::vector;
-
-
+    using boost::string_ref;
+
+
+    /*
+     * The file is read at once into a single buffer and the lines are kept
+     * as views into that buffer. Only when the lines are accessed for
+     * modification they are copied into strings. In Mockup playback the
+     * content of the mockup file is copied into the buffer, so the views
+     * stay valid when the mockup file is replaced.
+     *
+     * A last line without a trailing newline is also read.
+     */
     class AsciiFile
     {
     public:
@@ -65,25 +77,41 @@ namespace storage
 	template <class Pred>
 	int find_if_idx(Pred pred) const
 	{
-	    vector<string>::const_iterator it = std::find_if(Lines_C.begin(), Lines_C.end(), pred);
-	    if (it == Lines_C.end())
+	    const vector<string>& tmp = lines();
+	    vector<string>::const_iterator it = std::find_if(tmp.begin(), tmp.end(), pred);
+	    if (it == tmp.end())
 		return -1;
-	    return std::distance(Lines_C.begin(), it);
+	    return std::distance(tmp.begin(), it);
 	}
 
-	unsigned numLines() const { return Lines_C.size(); }
+	unsigned numLines() const { return copied ? Lines_C.size() : Views_C.size(); }
+
+	/*
+	 * Views of the lines without copying them. The views are valid until
+	 * the file is modified or reloaded.
+	 */
+	vector<string_ref> views() const;
 
-	vector<string>& lines() { return Lines_C; }
-	const vector<string>& lines() const { return Lines_C; }
+	vector<string>& lines() { copy_lines(); return Lines_C; }
+	const vector<string>& lines() const { copy_lines(); return Lines_C; }
 
     protected:
 
 	void removeLastIf(string& Text_Cr, char Char_cv) const;
 
+	void set_buffer(string&& buffer);
+	void copy_lines() const;
+
 	const string Name_C;
 	const bool remove_empty;
 
-	vector<string> Lines_C;
+	// content of the file as read, referenced by Views_C
+	std::shared_ptr<const string> Buffer_C;
+	vector<string_ref> Views_C;
+
+	// copies of the lines, valid once copied is set
+	mutable vector<string> Lines_C;
+	mutable bool copied;
 
     };
 
@@ -0,0 +1,639 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <list>
+#include <algorithm>
+#include <stdexcept>
+
+#include "storage/Utils/AsyncCmd.h"
+#include "storage/Utils/SystemCmd.h"
+#include "storage/Utils/OutputProcessor.h"
+#include "storage/Utils/Mockup.h"
+#include "storage/Utils/Remote.h"
+#include "storage/Utils/ProbeCache.h"
+#include "storage/Utils/AppUtil.h"
+
+
+extern char** environ;
+
+
+namespace storage
+{
+    using namespace std;
+
+
+    struct AsyncCmd::Child
+    {
+	Child(const string& cmd)
+	    : cmd(cmd), timeout_ms(0), max_lines(0), output_processor(nullptr), pid(-1),
+	      pidfd(-1), exited(false), killed(false), cancel_requested(false)
+	{
+	    fds[0] = fds[1] = -1;
+	}
+
+	const string cmd;
+
+	unsigned long timeout_ms;
+	unsigned long max_lines;
+	OutputProcessor* output_processor;
+
+	pid_t pid;
+
+	// read ends of stdout and stderr, -1 when closed
+	int fds[2];
+	int pidfd;
+
+	// incomplete last line of stdout and stderr
+	string partial[2];
+
+	bool exited;
+	int status;
+	bool killed;
+
+	atomic<bool> cancel_requested;
+
+	chrono::steady_clock::time_point start_time;
+
+	Result result;
+	promise<Result> result_promise;
+
+	// tags for epoll, stdout, stderr and pidfd
+	struct Watch
+	{
+	    Child* child;
+	    int what;
+	} watches[3];
+    };
+
+
+    /**
+     * The event loop shared by all AsyncCmds. The thread is started with
+     * the first command and ends when no command is left.
+     */
+    class CmdLoop : private boost::noncopyable
+    {
+    public:
+
+	static CmdLoop& instance();
+
+	void add(const shared_ptr<AsyncCmd::Child>& child);
+
+	void wakeup();
+
+    private:
+
+	CmdLoop();
+
+	void run();
+
+	void register_child(AsyncCmd::Child* child);
+	void read_output(AsyncCmd::Child* child, int what);
+	void close_output(AsyncCmd::Child* child, int what);
+	void reap(AsyncCmd::Child* child);
+	void finish(AsyncCmd::Child* child);
+	void kill_child(AsyncCmd::Child* child);
+
+	int epoll_fd;
+	int event_fd;
+
+	mutex pending_mutex;
+	list<shared_ptr<AsyncCmd::Child>> pending;
+	bool running;
+
+	// only used by the loop thread
+	list<shared_ptr<AsyncCmd::Child>> children;
+
+    };
+
+
+    CmdLoop&
+    CmdLoop::instance()
+    {
+	// never destroyed, the thread might still run during exit
+	static CmdLoop* cmd_loop = new CmdLoop();
+	return *cmd_loop;
+    }
+
+
+    CmdLoop::CmdLoop()
+	: epoll_fd(epoll_create1(EPOLL_CLOEXEC)), event_fd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)),
+	  running(false)
+    {
+	if (epoll_fd < 0 || event_fd < 0)
+	    throw runtime_error("creating event loop failed");
+
+	struct epoll_event event;
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.ptr = nullptr;
+	if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, event_fd, &event) != 0)
+	    throw runtime_error("creating event loop failed");
+    }
+
+
+    void
+    CmdLoop::add(const shared_ptr<AsyncCmd::Child>& child)
+    {
+	lock_guard<mutex> lock(pending_mutex);
+
+	pending.push_back(child);
+
+	if (running)
+	{
+	    wakeup();
+	}
+	else
+	{
+	    running = true;
+	    thread(&CmdLoop::run, this).detach();
+	}
+    }
+
+
+    void
+    CmdLoop::wakeup()
+    {
+	uint64_t one = 1;
+	if (write(event_fd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+	    y2err("write eventfd failed errno:" << errno << " (" << strerror(errno) << ")");
+    }
+
+
+    void
+    CmdLoop::register_child(AsyncCmd::Child* child)
+    {
+	for (int what = 0; what < 3; ++what)
+	{
+	    int fd = what < 2 ? child->fds[what] : child->pidfd;
+	    if (fd < 0)
+		continue;
+
+	    child->watches[what] = { child, what };
+
+	    struct epoll_event event;
+	    memset(&event, 0, sizeof(event));
+	    event.events = EPOLLIN;
+	    event.data.ptr = &child->watches[what];
+	    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0)
+		y2err("epoll_ctl failed errno:" << errno << " (" << strerror(errno) << ")");
+	}
+    }
+
+
+    void
+    CmdLoop::read_output(AsyncCmd::Child* child, int what)
+    {
+	char buffer[4096];
+
+	while (child->fds[what] >= 0)
+	{
+	    ssize_t n = read(child->fds[what], buffer, sizeof(buffer));
+
+	    if (n < 0 && errno == EINTR)
+		continue;
+
+	    if (n < 0 && errno == EAGAIN)
+		break;
+
+	    if (n <= 0)
+	    {
+		close_output(child, what);
+		break;
+	    }
+
+	    if (child->output_processor)
+		child->output_processor->process(string(buffer, n), what == 1);
+
+	    vector<string>& lines = what == 0 ? child->result.stdout : child->result.stderr;
+
+	    string& partial = child->partial[what];
+	    partial.append(buffer, n);
+
+	    string::size_type pos1 = 0;
+	    for (string::size_type pos2; (pos2 = partial.find('\n', pos1)) != string::npos; pos1 = pos2 + 1)
+		lines.push_back(partial.substr(pos1, pos2 - pos1));
+	    partial.erase(0, pos1);
+	}
+    }
+
+
+    void
+    CmdLoop::close_output(AsyncCmd::Child* child, int what)
+    {
+	epoll_ctl(epoll_fd, EPOLL_CTL_DEL, child->fds[what], nullptr);
+	close(child->fds[what]);
+	child->fds[what] = -1;
+
+	vector<string>& lines = what == 0 ? child->result.stdout : child->result.stderr;
+
+	if (!child->partial[what].empty())
+	{
+	    lines.push_back(child->partial[what]);
+	    child->partial[what].clear();
+	}
+    }
+
+
+    void
+    CmdLoop::reap(AsyncCmd::Child* child)
+    {
+	int ret = waitpid(child->pid, &child->status, WNOHANG);
+	if (ret == 0)
+	    return;
+
+	if (ret < 0)
+	{
+	    y2err("waitpid failed errno:" << errno << " (" << strerror(errno) << ")");
+	    child->status = -1;
+	}
+
+	child->exited = true;
+
+	if (child->pidfd >= 0)
+	{
+	    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, child->pidfd, nullptr);
+	    close(child->pidfd);
+	    child->pidfd = -1;
+	}
+    }
+
+
+    void
+    CmdLoop::kill_child(AsyncCmd::Child* child)
+    {
+	if (child->exited || child->killed)
+	    return;
+
+	int r = kill(child->pid, SIGKILL);
+	y2mil("kill pid:" << child->pid << " ret:" << r);
+
+	child->killed = true;
+    }
+
+
+    void
+    CmdLoop::finish(AsyncCmd::Child* child)
+    {
+	// grandchildren may keep the pipes open, take what is there
+	for (int what = 0; what < 2; ++what)
+	{
+	    read_output(child, what);
+	    if (child->fds[what] >= 0)
+		close_output(child, what);
+	}
+
+	AsyncCmd::Result& result = child->result;
+
+	if (child->status != -1 && WIFEXITED(child->status))
+	{
+	    result.exit_code = WEXITSTATUS(child->status);
+	    if (result.exit_code == 126)
+		y2err("command \"" << child->cmd << "\" not executable");
+	    else if (result.exit_code == 127)
+		y2err("command \"" << child->cmd << "\" not found");
+	}
+	else
+	{
+	    result.exit_code = -127;
+	    if (!child->killed)
+		y2err("command \"" << child->cmd << "\" failed");
+	}
+
+	result.duration = chrono::duration<double>(chrono::steady_clock::now() -
+						   child->start_time).count();
+
+	y2mil("async command \"" << child->cmd << "\" returns:" << result.exit_code << " time:" <<
+	      result.duration << "s timed-out:" << result.timed_out << " exceeded-lines:" <<
+	      result.exceeded_lines << " cancelled:" << result.cancelled);
+
+	if (child->output_processor)
+	    child->output_processor->finish();
+
+	child->result_promise.set_value(result);
+    }
+
+
+    void
+    CmdLoop::run()
+    {
+	while (true)
+	{
+	    {
+		lock_guard<mutex> lock(pending_mutex);
+
+		for (const shared_ptr<AsyncCmd::Child>& child : pending)
+		{
+		    register_child(child.get());
+		    children.push_back(child);
+		}
+		pending.clear();
+
+		if (children.empty())
+		{
+		    running = false;
+		    return;
+		}
+	    }
+
+	    // sleep until the next deadline, without pidfd poll for the
+	    // children
+
+	    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+
+	    int timeout = -1;
+
+	    for (const shared_ptr<AsyncCmd::Child>& child : children)
+	    {
+		if (child->pidfd < 0 && !child->exited)
+		    timeout = timeout < 0 ? 10 : min(timeout, 10);
+
+		if (child->timeout_ms > 0 && !child->killed)
+		{
+		    chrono::steady_clock::time_point deadline = child->start_time +
+			chrono::milliseconds(child->timeout_ms);
+
+		    long long ms = chrono::duration_cast<chrono::milliseconds>(deadline - now).count();
+		    ms = max(0LL, ms + 1);
+		    timeout = timeout < 0 ? (int)(ms) : min(timeout, (int)(ms));
+		}
+	    }
+
+	    struct epoll_event events[16];
+	    int n = epoll_wait(epoll_fd, events, 16, timeout);
+	    if (n < 0 && errno != EINTR)
+		y2err("epoll_wait failed errno:" << errno << " (" << strerror(errno) << ")");
+
+	    for (int i = 0; i < n; ++i)
+	    {
+		if (!events[i].data.ptr)
+		{
+		    uint64_t value;
+		    while (read(event_fd, &value, sizeof(value)) > 0)
+			;
+		    continue;
+		}
+
+		AsyncCmd::Child::Watch* watch = (AsyncCmd::Child::Watch*)(events[i].data.ptr);
+
+		if (watch->what < 2)
+		    read_output(watch->child, watch->what);
+		else
+		    reap(watch->child);
+	    }
+
+	    now = chrono::steady_clock::now();
+
+	    for (list<shared_ptr<AsyncCmd::Child>>::iterator it = children.begin(); it != children.end(); )
+	    {
+		AsyncCmd::Child* child = it->get();
+
+		if (!child->exited && child->pidfd < 0)
+		    reap(child);
+
+		if (!child->killed && !child->exited)
+		{
+		    if (child->cancel_requested)
+		    {
+			child->result.cancelled = true;
+			kill_child(child);
+		    }
+		    else if (child->timeout_ms > 0 &&
+			     now >= child->start_time + chrono::milliseconds(child->timeout_ms))
+		    {
+			child->result.timed_out = true;
+			kill_child(child);
+		    }
+		    else if (child->max_lines > 0 && child->result.stdout.size() +
+			     child->result.stderr.size() > child->max_lines)
+		    {
+			child->result.exceeded_lines = true;
+			kill_child(child);
+		    }
+		}
+
+		if (child->exited)
+		{
+		    finish(child);
+		    it = children.erase(it);
+		}
+		else
+		{
+		    ++it;
+		}
+	    }
+	}
+    }
+
+
+    AsyncCmd::AsyncCmd(const string& cmd)
+	: child(make_shared<Child>(cmd))
+    {
+    }
+
+
+    AsyncCmd::~AsyncCmd()
+    {
+	if (future.valid())
+	{
+	    cancel();
+	    future.wait();
+	}
+    }
+
+
+    const string&
+    AsyncCmd::get_cmd() const
+    {
+	return child->cmd;
+    }
+
+
+    void
+    AsyncCmd::set_timeout(unsigned long timeout_ms)
+    {
+	child->timeout_ms = timeout_ms;
+    }
+
+
+    void
+    AsyncCmd::set_max_lines(unsigned long max_lines)
+    {
+	child->max_lines = max_lines;
+    }
+
+
+    void
+    AsyncCmd::set_output_processor(OutputProcessor* output_processor)
+    {
+	child->output_processor = output_processor;
+    }
+
+
+    static void
+    close_pipe(int fds[2])
+    {
+	for (int i = 0; i < 2; ++i)
+	    if (fds[i] >= 0)
+		close(fds[i]);
+    }
+
+
+    std::shared_future<AsyncCmd::Result>
+    AsyncCmd::start()
+    {
+	if (future.valid())
+	    throw runtime_error("command already started");
+
+	future = child->result_promise.get_future().share();
+
+	y2mil("AsyncCmd Executing:\"" << child->cmd << "\"");
+
+	child->start_time = chrono::steady_clock::now();
+
+	if (Mockup::get_mode() != Mockup::Mode::NONE || get_remote_callbacks() ||
+	    ProbeCache::get_current())
+	{
+	    SystemCmd cmd;
+	    cmd.setOutputProcessor(child->output_processor);
+	    cmd.execute(child->cmd);
+
+	    child->result.stdout = cmd.stdout();
+	    child->result.stderr = cmd.stderr();
+	    child->result.exit_code = cmd.retcode();
+	    child->exited = true;
+	    child->result_promise.set_value(child->result);
+
+	    return future;
+	}
+
+	int sout[2] = { -1, -1 };
+	int serr[2] = { -1, -1 };
+
+	if (pipe2(sout, O_CLOEXEC) != 0 || pipe2(serr, O_CLOEXEC) != 0)
+	{
+	    close_pipe(sout);
+	    close_pipe(serr);
+	    future = std::shared_future<Result>();
+	    throw runtime_error("pipe creation failed");
+	}
+
+	// everything the child needs is prepared before fork since only
+	// async-signal-safe functions may be called in the child of a
+	// threaded process
+
+	vector<string> env_strings = { "LC_ALL=C", "LANGUAGE=C" };
+	for (char** p = environ; *p; ++p)
+	    if (strncmp(*p, "LC_ALL=", 7) != 0 && strncmp(*p, "LANGUAGE=", 9) != 0)
+		env_strings.push_back(*p);
+
+	vector<char*> envp;
+	for (string& env_string : env_strings)
+	    envp.push_back(&env_string[0]);
+	envp.push_back(nullptr);
+
+	const char* shell = access("/bin/sh", X_OK) == 0 ? "/bin/sh" : "/bin/bash";
+	const char* argv[] = { shell, "-c", child->cmd.c_str(), nullptr };
+
+	int max_fd = getdtablesize();
+
+	pid_t pid = fork();
+	if (pid == 0)
+	{
+	    if (dup2(sout[1], STDOUT_FILENO) < 0 || dup2(serr[1], STDERR_FILENO) < 0)
+		_exit(127);
+
+	    int null_fd = open("/dev/null", O_RDONLY);
+	    if (null_fd >= 0)
+		dup2(null_fd, STDIN_FILENO);
+
+	    for (int fd = 3; fd < max_fd; ++fd)
+		close(fd);
+
+	    execve(shell, (char* const*)(argv), envp.data());
+	    _exit(127);
+	}
+
+	close(sout[1]);
+	close(serr[1]);
+
+	if (pid < 0)
+	{
+	    close(sout[0]);
+	    close(serr[0]);
+	    future = std::shared_future<Result>();
+	    throw runtime_error("fork failed");
+	}
+
+	fcntl(sout[0], F_SETFL, O_NONBLOCK);
+	fcntl(serr[0], F_SETFL, O_NONBLOCK);
+
+	child->pid = pid;
+	child->fds[0] = sout[0];
+	child->fds[1] = serr[0];
+
+#ifdef SYS_pidfd_open
+	child->pidfd = syscall(SYS_pidfd_open, pid, 0);
+#endif
+
+	if (child->output_processor)
+	    child->output_processor->reset();
+
+	CmdLoop::instance().add(child);
+
+	return future;
+    }
+
+
+    void
+    AsyncCmd::cancel()
+    {
+	if (!future.valid() || future.wait_for(chrono::seconds(0)) == future_status::ready)
+	    return;
+
+	child->cancel_requested = true;
+	CmdLoop::instance().wakeup();
+    }
+
+
+    const AsyncCmd::Result&
+    AsyncCmd::wait() const
+    {
+	if (!future.valid())
+	    throw runtime_error("command not started");
+
+	return future.get();
+    }
+
+}
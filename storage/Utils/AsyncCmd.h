@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#ifndef ASYNC_CMD_H
+#define ASYNC_CMD_H
+
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <future>
+#include <boost/noncopyable.hpp>
+
+
+namespace storage
+{
+    using std::string;
+    using std::vector;
+
+
+    class OutputProcessor;
+
+
+    /**
+     * Runs a command without blocking the caller. All running commands are
+     * multiplexed in one epoll based event loop running in a background
+     * thread, child termination is noticed via pidfd. The result is
+     * delivered through a future.
+     *
+     * With mockups, remote callbacks or the probe cache active the command
+     * is run synchronously with SystemCmd during start() so that all
+     * commands see the same data.
+     *
+     * A set OutputProcessor is fed with the output as it arrives, from the
+     * thread of the event loop.
+     */
+    class AsyncCmd : private boost::noncopyable
+    {
+    public:
+
+	struct Result
+	{
+	    Result() : stdout(), stderr(), exit_code(0), timed_out(false), exceeded_lines(false),
+		       cancelled(false), duration(0.0) {}
+
+	    vector<string> stdout;
+	    vector<string> stderr;
+
+	    // like SystemCmd, -127 if killed by a signal
+	    int exit_code;
+
+	    bool timed_out;
+	    bool exceeded_lines;
+	    bool cancelled;
+
+	    // in seconds
+	    double duration;
+	};
+
+	AsyncCmd(const string& cmd);
+
+	/**
+	 * Cancels the command if still running and waits for it.
+	 */
+	~AsyncCmd();
+
+	const string& get_cmd() const;
+
+	/**
+	 * The command is killed if it runs longer than timeout_ms
+	 * milliseconds. Zero means no timeout.
+	 */
+	void set_timeout(unsigned long timeout_ms);
+
+	/**
+	 * The command is killed if it outputs more than max_lines lines on
+	 * stdout and stderr. Zero means no limit.
+	 */
+	void set_max_lines(unsigned long max_lines);
+
+	void set_output_processor(OutputProcessor* output_processor);
+
+	/**
+	 * Starts the command. Throws runtime_error if the command could
+	 * not be started or was already started.
+	 */
+	std::shared_future<Result> start();
+
+	/**
+	 * Kills the command if still running. The result is available as
+	 * usual afterwards.
+	 */
+	void cancel();
+
+	/**
+	 * Waits for the command and returns its result.
+	 */
+	const Result& wait() const;
+
+	struct Child;
+
+    private:
+
+	std::shared_ptr<Child> child;
+
+	std::shared_future<Result> future;
+
+    };
+
+}
+
+
+#endif
@@ -0,0 +1,402 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <random>
+#include <algorithm>
+#include <stdexcept>
+
+#include "storage/Utils/DiskImage.h"
+#include "storage/Utils/AppUtil.h"
+#include "storage/Devices/Partition.h"
+
+
+namespace storage
+{
+    using namespace std;
+
+
+    static void
+    put_le(vector<unsigned char>& data, size_t pos, unsigned long long value, size_t bytes)
+    {
+	for (size_t i = 0; i < bytes; ++i)
+	    data[pos + i] = (value >> (8 * i)) & 0xff;
+    }
+
+
+    // writes the GUID in the mixed endian on-disk format
+    static void
+    put_guid(vector<unsigned char>& data, size_t pos, const string& guid)
+    {
+	string hex;
+	for (char c : guid)
+	    if (c != '-')
+		hex += c;
+
+	if (hex.size() != 32)
+	    throw runtime_error("invalid guid " + guid);
+
+	unsigned char bytes[16];
+	for (int i = 0; i < 16; ++i)
+	    bytes[i] = stoul(hex.substr(2 * i, 2), nullptr, 16);
+
+	static const int order[16] = { 3, 2, 1, 0, 5, 4, 7, 6, 8, 9, 10, 11, 12, 13, 14, 15 };
+	for (int i = 0; i < 16; ++i)
+	    data[pos + i] = bytes[order[i]];
+    }
+
+
+    static void
+    put_random_guid(vector<unsigned char>& data, size_t pos, mt19937& generator)
+    {
+	for (int i = 0; i < 16; ++i)
+	    data[pos + i] = generator() & 0xff;
+
+	// version 4 and RFC 4122 variant
+	data[pos + 7] = (data[pos + 7] & 0x0f) | 0x40;
+	data[pos + 8] = (data[pos + 8] & 0x3f) | 0x80;
+    }
+
+
+    static const char*
+    gpt_type_guid(unsigned int id)
+    {
+	switch (id)
+	{
+	    case ID_SWAP: return "0657FD6D-A4AB-43C4-84E5-0933C84B4F4F";
+	    case ID_LVM: return "E6D6D379-F507-44C2-A23C-238F2A3DF928";
+	    case ID_RAID: return "A19D880F-05FC-4D3B-A006-743F0F84911E";
+	    case ID_GPT_BOOT: return "C12A7328-F81F-11D2-BA4B-00A0C93EC93B";
+	    case ID_GPT_BIOS: return "21686148-6449-6E6F-744E-656564454649";
+	    case ID_PPC_PREP: case ID_GPT_PREP: return "9E1A2D38-C612-4316-AA26-8B49521E5A8B";
+	    case ID_GPT_MSFTRES: return "E3C9E316-0B5C-4DB8-817D-F92DF00215AE";
+	    case ID_DOS12: case ID_DOS16: case ID_DOS32: case ID_NTFS:
+		return "EBD0A0A2-B9E5-4433-87C0-68B6B72699C7";
+	    case ID_APPLE_HFS: return "48465300-0000-11AA-AA11-00306543ECAC";
+	    case ID_APPLE_UFS: return "55465300-0000-11AA-AA11-00306543ECAC";
+	    default: return "0FC63DAF-8483-4772-8E79-3D69D8477DE4";
+	}
+    }
+
+
+    // CHS address for a geometry with 255 heads and 63 sectors, addresses
+    // beyond cylinder 1023 are saturated as usual
+    static void
+    put_chs(vector<unsigned char>& data, size_t pos, unsigned long long lba)
+    {
+	unsigned long long c = lba / (255 * 63);
+	unsigned int h = (lba / 63) % 255;
+	unsigned int s = lba % 63 + 1;
+
+	if (c > 1023)
+	{
+	    c = 1023;
+	    h = 254;
+	    s = 63;
+	}
+
+	data[pos] = h;
+	data[pos + 1] = (s & 0x3f) | ((c >> 2) & 0xc0);
+	data[pos + 2] = c & 0xff;
+    }
+
+
+    static void
+    put_mbr_entry(vector<unsigned char>& data, size_t pos, unsigned int type, bool boot,
+		  unsigned long long start, unsigned long long length)
+    {
+	if (start + length > 0xffffffffULL)
+	    throw runtime_error("partition beyond 2 TiB on msdos");
+
+	data[pos] = boot ? 0x80 : 0x00;
+	put_chs(data, pos + 1, start);
+	data[pos + 4] = type;
+	put_chs(data, pos + 5, start + length - 1);
+	put_le(data, pos + 8, start, 4);
+	put_le(data, pos + 12, length, 4);
+    }
+
+
+    void
+    DiskImage::create(unsigned long long size) const
+    {
+	int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (fd < 0)
+	    throw runtime_error("creating image " + filename + " failed, " + strerror(errno));
+
+	int ret = ftruncate(fd, size);
+	int error = errno;
+	close(fd);
+
+	if (ret != 0)
+	    throw runtime_error("resizing image " + filename + " failed, " + strerror(error));
+    }
+
+
+    unsigned long long
+    DiskImage::get_size() const
+    {
+	struct stat st;
+	if (stat(filename.c_str(), &st) != 0)
+	    throw runtime_error("stat for image " + filename + " failed, " + strerror(errno));
+
+	return st.st_size;
+    }
+
+
+    void
+    DiskImage::write(unsigned long long offset, const vector<unsigned char>& data) const
+    {
+	int fd = open(filename.c_str(), O_WRONLY | O_CLOEXEC);
+	if (fd < 0)
+	    throw runtime_error("opening image " + filename + " failed, " + strerror(errno));
+
+	ssize_t ret = pwrite(fd, data.data(), data.size(), offset);
+	int error = errno;
+	close(fd);
+
+	if (ret != (ssize_t)(data.size()))
+	    throw runtime_error("writing image " + filename + " failed, " + strerror(error));
+    }
+
+
+    void
+    DiskImage::write_msdos(const vector<Entry>& entries) const
+    {
+	vector<unsigned char> mbr(sector_size, 0);
+
+	random_device random;
+	put_le(mbr, 440, random(), 4);
+
+	mbr[510] = 0x55;
+	mbr[511] = 0xaa;
+
+	const Entry* extended = nullptr;
+	vector<const Entry*> logicals;
+
+	for (const Entry& entry : entries)
+	{
+	    if (entry.id > 0xff)
+		throw runtime_error("partition id " + to_string(entry.id) + " not supported on msdos");
+
+	    switch (entry.type)
+	    {
+		case PRIMARY:
+		case EXTENDED:
+		    if (entry.number < 1 || entry.number > 4)
+			throw runtime_error("invalid primary partition number " + to_string(entry.number));
+		    put_mbr_entry(mbr, 446 + 16 * (entry.number - 1), entry.type == EXTENDED ?
+				  ID_EXTENDED : entry.id, entry.boot, entry.start, entry.length);
+		    if (entry.type == EXTENDED)
+			extended = &entry;
+		    break;
+
+		default:
+		    logicals.push_back(&entry);
+		    break;
+	    }
+	}
+
+	write(0, mbr);
+
+	if (logicals.empty())
+	    return;
+
+	if (!extended)
+	    throw runtime_error("logical partitions without extended partition");
+
+	sort(logicals.begin(), logicals.end(), [](const Entry* a, const Entry* b) {
+	    return a->number < b->number;
+	});
+
+	// the chain of EBRs, each describes its logical partition and
+	// links to the next EBR relative to the start of the extended
+	// partition
+
+	vector<unsigned long long> ebrs;
+	for (size_t i = 0; i < logicals.size(); ++i)
+	    ebrs.push_back(i == 0 ? extended->start : logicals[i]->start - alignment);
+
+	for (size_t i = 0; i < logicals.size(); ++i)
+	{
+	    vector<unsigned char> ebr(sector_size, 0);
+	    ebr[510] = 0x55;
+	    ebr[511] = 0xaa;
+
+	    const Entry& logical = *logicals[i];
+	    if (logical.start <= ebrs[i])
+		throw runtime_error("no space for EBR of partition " + to_string(logical.number));
+
+	    put_mbr_entry(ebr, 446, logical.id, logical.boot, logical.start - ebrs[i], logical.length);
+
+	    if (i + 1 < logicals.size())
+	    {
+		const Entry& next = *logicals[i + 1];
+		put_mbr_entry(ebr, 462, 0x05, false, ebrs[i + 1] - extended->start,
+			      next.start + next.length - ebrs[i + 1]);
+	    }
+
+	    write(ebrs[i] * sector_size, ebr);
+	}
+    }
+
+
+    void
+    DiskImage::write_gpt(const vector<Entry>& entries) const
+    {
+	const unsigned long long last = get_size() / sector_size - 1;
+	if (last < 2 * gpt_backup_sectors + 1)
+	    throw runtime_error("image " + filename + " too small for gpt");
+
+	const unsigned int num_entries = 128;
+	const unsigned int entry_size = 128;
+
+	mt19937 generator((random_device())());
+
+	vector<unsigned char> mbr(sector_size, 0);
+	put_mbr_entry(mbr, 446, 0xee, false, 1, min(last, 0xfffffffeULL));
+	mbr[510] = 0x55;
+	mbr[511] = 0xaa;
+
+	vector<unsigned char> array(num_entries * entry_size, 0);
+
+	for (const Entry& entry : entries)
+	{
+	    if (entry.number < 1 || entry.number > num_entries)
+		throw runtime_error("invalid partition number " + to_string(entry.number));
+
+	    if (entry.start < 2 + array.size() / sector_size ||
+		entry.start + entry.length > last - gpt_backup_sectors + 1)
+		throw runtime_error("partition " + to_string(entry.number) + " outside usable area");
+
+	    size_t pos = (entry.number - 1) * entry_size;
+	    put_guid(array, pos, gpt_type_guid(entry.id));
+	    put_random_guid(array, pos + 16, generator);
+	    put_le(array, pos + 32, entry.start, 8);
+	    put_le(array, pos + 40, entry.start + entry.length - 1, 8);
+
+	    // legacy BIOS bootable
+	    if (entry.boot)
+		put_le(array, pos + 48, 1ULL << 2, 8);
+	}
+
+	const uint32_t array_crc = crc32(array.data(), array.size());
+
+	vector<unsigned char> disk_guid(16);
+	put_random_guid(disk_guid, 0, generator);
+
+	auto header = [&](unsigned long long current, unsigned long long backup,
+			  unsigned long long array_lba) {
+	    vector<unsigned char> data(sector_size, 0);
+	    memcpy(data.data(), "EFI PART", 8);
+	    put_le(data, 8, 0x00010000, 4);
+	    put_le(data, 12, 92, 4);
+	    put_le(data, 24, current, 8);
+	    put_le(data, 32, backup, 8);
+	    put_le(data, 40, 2 + array.size() / sector_size, 8);
+	    put_le(data, 48, last - gpt_backup_sectors, 8);
+	    copy(disk_guid.begin(), disk_guid.end(), data.begin() + 56);
+	    put_le(data, 72, array_lba, 8);
+	    put_le(data, 80, num_entries, 4);
+	    put_le(data, 84, entry_size, 4);
+	    put_le(data, 88, array_crc, 4);
+	    put_le(data, 16, crc32(data.data(), 92), 4);
+	    return data;
+	};
+
+	write(0, mbr);
+	write(1 * sector_size, header(1, last, 2));
+	write(2 * sector_size, array);
+	write((last - gpt_backup_sectors + 1) * sector_size, array);
+	write(last * sector_size, header(last, 1, last - gpt_backup_sectors + 1));
+    }
+
+
+    void
+    DiskImage::copy_from(const string& src, unsigned long long offset) const
+    {
+	int fd_src = open(src.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd_src < 0)
+	    throw runtime_error("opening " + src + " failed, " + strerror(errno));
+
+	int fd_dest = open(filename.c_str(), O_WRONLY | O_CLOEXEC);
+	if (fd_dest < 0)
+	{
+	    int error = errno;
+	    close(fd_src);
+	    throw runtime_error("opening image " + filename + " failed, " + strerror(error));
+	}
+
+	vector<char> buffer(1024 * 1024);
+
+	string error;
+
+	off_t pos = 0;
+	while (error.empty())
+	{
+	    off_t data = lseek(fd_src, pos, SEEK_DATA);
+	    if (data < 0)
+	    {
+		// ENXIO: no data after pos
+		if (errno != ENXIO)
+		    error = string("seeking data failed, ") + strerror(errno);
+		break;
+	    }
+
+	    off_t hole = lseek(fd_src, data, SEEK_HOLE);
+	    if (hole < 0)
+	    {
+		error = string("seeking hole failed, ") + strerror(errno);
+		break;
+	    }
+
+	    for (pos = data; pos < hole; )
+	    {
+		ssize_t n = pread(fd_src, buffer.data(), min<off_t>(buffer.size(), hole - pos), pos);
+		if (n <= 0)
+		{
+		    error = string("reading failed, ") + (n < 0 ? strerror(errno) : "short read");
+		    break;
+		}
+
+		if (pwrite(fd_dest, buffer.data(), n, offset + pos) != n)
+		{
+		    error = string("writing failed, ") + strerror(errno);
+		    break;
+		}
+
+		pos += n;
+	    }
+	}
+
+	close(fd_dest);
+	close(fd_src);
+
+	if (!error.empty())
+	    throw runtime_error("copying " + src + " to image " + filename + " failed, " + error);
+    }
+
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#ifndef DISK_IMAGE_H
+#define DISK_IMAGE_H
+
+
+#include <string>
+#include <vector>
+
+#include "storage/StorageInterface.h"
+
+
+namespace storage
+{
+    using std::string;
+    using std::vector;
+    using namespace storage_legacy;
+
+
+    /**
+     * A disk image file for TargetMode::IMAGE. Partition tables are
+     * written directly into the file and filesystems created elsewhere
+     * are copied in, so neither loop devices nor udev are involved.
+     * Sectors always have 512 bytes. Errors throw runtime_error.
+     */
+    class DiskImage
+    {
+    public:
+
+	static const unsigned int sector_size = 512;
+
+	/**
+	 * Partitions start at multiples of 1 MiB. The EBR of a logical
+	 * partition is the first sector of the 1 MiB in front of it, only
+	 * the first EBR is at the start of the extended partition.
+	 */
+	static const unsigned long long alignment = 2048;
+
+	/**
+	 * Sectors at the end of the disk used by the backup GPT.
+	 */
+	static const unsigned long long gpt_backup_sectors = 33;
+
+	struct Entry
+	{
+	    Entry(unsigned int number, PartitionType type, unsigned long long start,
+		  unsigned long long length, unsigned int id, bool boot)
+		: number(number), type(type), start(start), length(length), id(id), boot(boot) {}
+
+	    unsigned int number;
+	    PartitionType type;
+	    unsigned long long start;
+	    unsigned long long length;
+	    unsigned int id;
+	    bool boot;
+	};
+
+	DiskImage(const string& filename) : filename(filename) {}
+
+	const string& get_filename() const { return filename; }
+
+	/**
+	 * Creates the file as sparse file of the given size in bytes. An
+	 * existing file is truncated first so the image reads as zeros.
+	 */
+	void create(unsigned long long size) const;
+
+	unsigned long long get_size() const;
+
+	void write_msdos(const vector<Entry>& entries) const;
+
+	/**
+	 * Writes protective MBR, primary and backup GPT. Disk and partition
+	 * GUIDs are random.
+	 */
+	void write_gpt(const vector<Entry>& entries) const;
+
+	/**
+	 * Copies the file src to offset without writing its holes.
+	 */
+	void copy_from(const string& src, unsigned long long offset) const;
+
+    private:
+
+	void write(unsigned long long offset, const vector<unsigned char>& data) const;
+
+	const string filename;
+
+    };
+
+}
+
+#endif
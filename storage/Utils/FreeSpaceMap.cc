@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#include <iostream>
+
+#include "storage/Utils/FreeSpaceMap.h"
+#include "storage/Utils/StorageTmpl.h"
+
+
+namespace storage
+{
+    using namespace std;
+
+
+    FreeSpaceMap::FreeSpaceMap()
+	: bounds(), overlapping(false)
+    {
+    }
+
+
+    void
+    FreeSpaceMap::reset(const Region& bounds)
+    {
+	FreeSpaceMap::bounds = bounds;
+	used.clear();
+	rebuild();
+    }
+
+
+    void
+    FreeSpaceMap::rebuild()
+    {
+	free_by_start.clear();
+	free_by_length.clear();
+	overlapping = false;
+
+	if (!bounds.empty())
+	    insert_free(bounds.get_start(), bounds.get_start() + bounds.get_length());
+
+	for (const multimap<unsigned long long, unsigned long long>::value_type& tmp : used)
+	{
+	    if (!subtract(Region(tmp.first, tmp.second)))
+		overlapping = true;
+	}
+    }
+
+
+    void
+    FreeSpaceMap::insert_free(unsigned long long start, unsigned long long end)
+    {
+	free_by_start[start] = end;
+	free_by_length.insert(make_pair(end - start, start));
+    }
+
+
+    void
+    FreeSpaceMap::erase_free(map<unsigned long long, unsigned long long>::iterator it)
+    {
+	free_by_length.erase(make_pair(it->second - it->first, it->first));
+	free_by_start.erase(it);
+    }
+
+
+    bool
+    FreeSpaceMap::subtract(const Region& region)
+    {
+	if (bounds.empty() || !bounds.intersect(region))
+	    return true;
+
+	Region tmp = bounds.intersection(region);
+	unsigned long long start = tmp.get_start();
+	unsigned long long end = tmp.get_start() + tmp.get_length();
+
+	map<unsigned long long, unsigned long long>::iterator it = free_by_start.upper_bound(start);
+	if (it != free_by_start.begin() && prev(it)->second > start)
+	    --it;
+
+	unsigned long long covered = 0;
+
+	while (it != free_by_start.end() && it->first < end)
+	{
+	    unsigned long long free_start = it->first;
+	    unsigned long long free_end = it->second;
+
+	    map<unsigned long long, unsigned long long>::iterator next_it = next(it);
+	    erase_free(it);
+	    it = next_it;
+
+	    if (free_start < start)
+		insert_free(free_start, start);
+	    if (free_end > end)
+		insert_free(end, free_end);
+
+	    covered += min(free_end, end) - max(free_start, start);
+	}
+
+	return covered == end - start;
+    }
+
+
+    void
+    FreeSpaceMap::add_used(const Region& region)
+    {
+	if (region.empty())
+	    return;
+
+	used.insert(make_pair(region.get_start(), region.get_length()));
+
+	if (!subtract(region))
+	    overlapping = true;
+    }
+
+
+    void
+    FreeSpaceMap::remove_used(const Region& region)
+    {
+	if (region.empty())
+	    return;
+
+	pair<multimap<unsigned long long, unsigned long long>::iterator,
+	     multimap<unsigned long long, unsigned long long>::iterator> range =
+	    used.equal_range(region.get_start());
+
+	multimap<unsigned long long, unsigned long long>::iterator it = range.first;
+	while (it != range.second && it->second != region.get_length())
+	    ++it;
+
+	if (it == range.second)
+	    throw logic_error("used region not found");
+
+	used.erase(it);
+
+	if (overlapping)
+	{
+	    rebuild();
+	    return;
+	}
+
+	if (bounds.empty() || !bounds.intersect(region))
+	    return;
+
+	Region tmp = bounds.intersection(region);
+	unsigned long long start = tmp.get_start();
+	unsigned long long end = tmp.get_start() + tmp.get_length();
+
+	// merge with the free regions directly before and after
+
+	map<unsigned long long, unsigned long long>::iterator after = free_by_start.find(end);
+	if (after != free_by_start.end())
+	{
+	    end = after->second;
+	    erase_free(after);
+	}
+
+	map<unsigned long long, unsigned long long>::iterator before = free_by_start.lower_bound(start);
+	if (before != free_by_start.begin() && prev(before)->second == start)
+	{
+	    --before;
+	    start = before->first;
+	    erase_free(before);
+	}
+
+	insert_free(start, end);
+    }
+
+
+    vector<Region>
+    FreeSpaceMap::get_free_regions() const
+    {
+	vector<Region> ret;
+	ret.reserve(free_by_start.size());
+
+	for (const map<unsigned long long, unsigned long long>::value_type& tmp : free_by_start)
+	    ret.push_back(Region(tmp.first, tmp.second - tmp.first));
+
+	return ret;
+    }
+
+
+    bool
+    FreeSpaceMap::get_largest_free_region(Region& region) const
+    {
+	if (free_by_length.empty())
+	    return false;
+
+	const pair<unsigned long long, unsigned long long>& tmp = *free_by_length.rbegin();
+	region = Region(tmp.second, tmp.first);
+	return true;
+    }
+
+
+    bool
+    FreeSpaceMap::get_best_fit_region(unsigned long long length, Region& region) const
+    {
+	set<pair<unsigned long long, unsigned long long>>::const_iterator it =
+	    free_by_length.lower_bound(make_pair(length, 0));
+	if (it == free_by_length.end())
+	    return false;
+
+	region = Region(it->second, it->first);
+	return true;
+    }
+
+
+    std::ostream&
+    operator<<(std::ostream& s, const FreeSpaceMap& free_space_map)
+    {
+	s << "bounds:" << free_space_map.bounds << " free:" << free_space_map.get_free_regions();
+
+	if (free_space_map.overlapping)
+	    s << " overlapping";
+
+	return s;
+    }
+
+}
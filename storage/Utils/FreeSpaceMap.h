@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#ifndef FREE_SPACE_MAP_H
+#define FREE_SPACE_MAP_H
+
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "storage/Utils/Region.h"
+
+
+namespace storage
+{
+    using std::map;
+    using std::multimap;
+    using std::set;
+    using std::vector;
+    using std::pair;
+
+
+    /**
+     * Keeps track of the free space within some bounds given the used
+     * regions. Adding and removing a used region as well as looking up the
+     * largest free region or the best fitting free region is O(log n).
+     *
+     * Used regions may exceed the bounds. Overlapping used regions are
+     * allowed but removing a used region then rebuilds the whole map.
+     */
+    class FreeSpaceMap
+    {
+    public:
+
+	FreeSpaceMap();
+
+	void reset(const Region& bounds);
+
+	const Region& get_bounds() const { return bounds; }
+
+	void add_used(const Region& region);
+	void remove_used(const Region& region);
+
+	/**
+	 * Returns the free regions sorted by start.
+	 */
+	vector<Region> get_free_regions() const;
+
+	bool get_largest_free_region(Region& region) const;
+
+	/**
+	 * Finds the smallest free region with at least the given length.
+	 */
+	bool get_best_fit_region(unsigned long long length, Region& region) const;
+
+	friend std::ostream& operator<<(std::ostream& s, const FreeSpaceMap& free_space_map);
+
+    private:
+
+	void rebuild();
+
+	void insert_free(unsigned long long start, unsigned long long end);
+	void erase_free(map<unsigned long long, unsigned long long>::iterator it);
+
+	bool subtract(const Region& region);
+
+	Region bounds;
+
+	// used regions as start and length
+	multimap<unsigned long long, unsigned long long> used;
+
+	// free regions as start and end (exclusive)
+	map<unsigned long long, unsigned long long> free_by_start;
+
+	// free regions as length and start
+	set<pair<unsigned long long, unsigned long long>> free_by_length;
+
+	bool overlapping;
+
+    };
+
+}
+
+
+#endif
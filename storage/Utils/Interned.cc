@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#include <mutex>
+#include <unordered_map>
+#include <boost/functional/hash.hpp>
+
+#include "storage/Utils/Interned.h"
+
+
+namespace storage
+{
+    using namespace std;
+
+
+    namespace
+    {
+
+	// hash and compare the values, not the pointers
+	template <typename Type>
+	struct ValueHash
+	{
+	    size_t operator()(const Type* value) const { return boost::hash<Type>()(*value); }
+	};
+
+
+	template <typename Type>
+	struct ValueEqual
+	{
+	    bool operator()(const Type* lhs, const Type* rhs) const { return *lhs == *rhs; }
+	};
+
+
+	template <typename Type>
+	struct Table
+	{
+	    std::mutex mutex;
+
+	    typedef unordered_map<const Type*, weak_ptr<const Type>, ValueHash<Type>,
+				  ValueEqual<Type>> Values;
+
+	    // the values are owned by the shared_ptrs of the Interned objects
+	    Values values;
+	};
+
+
+	template <typename Type>
+	Table<Type>&
+	get_table()
+	{
+	    // intentionally leaked, devices in static devicegraphs may still
+	    // refer to the values during exit
+	    static Table<Type>* table = new Table<Type>();
+	    return *table;
+	}
+
+
+	template <typename Type>
+	void
+	release(const Type* value)
+	{
+	    Table<Type>& table = get_table<Type>();
+
+	    {
+		lock_guard<std::mutex> lock(table.mutex);
+
+		// the value may have been replaced by a new one in the meantime,
+		// see Interned::intern()
+		typename Table<Type>::Values::iterator it = table.values.find(value);
+		if (it != table.values.end() && it->first == value)
+		    table.values.erase(it);
+	    }
+
+	    delete value;
+	}
+
+    }
+
+
+    template <typename Type>
+    shared_ptr<const Type>
+    Interned<Type>::intern(const Type& value)
+    {
+	Table<Type>& table = get_table<Type>();
+
+	lock_guard<std::mutex> lock(table.mutex);
+
+	typename Table<Type>::Values::iterator it = table.values.find(&value);
+	if (it != table.values.end())
+	{
+	    shared_ptr<const Type> ret = it->second.lock();
+	    if (ret)
+		return ret;
+
+	    // the last Interned of the old value is being destroyed,
+	    // release() will not find it anymore
+	    table.values.erase(it);
+	}
+
+	shared_ptr<const Type> ret(new Type(value), release<Type>);
+	table.values.emplace(ret.get(), ret);
+	return ret;
+    }
+
+
+    template <typename Type>
+    const shared_ptr<const Type>&
+    Interned<Type>::empty_value()
+    {
+	static const shared_ptr<const Type> empty = intern(Type());
+	return empty;
+    }
+
+
+    template <typename Type>
+    size_t
+    Interned<Type>::table_size()
+    {
+	Table<Type>& table = get_table<Type>();
+
+	lock_guard<std::mutex> lock(table.mutex);
+
+	return table.values.size();
+    }
+
+
+    template class Interned<string>;
+    template class Interned<vector<string>>;
+    template class Interned<list<string>>;
+
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#ifndef INTERNED_H
+#define INTERNED_H
+
+
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <ostream>
+
+
+namespace storage
+{
+    using std::string;
+    using std::vector;
+    using std::list;
+
+
+    /**
+     * A value stored once in a process-wide table (an atom table). Copies
+     * only copy a reference counted pointer and equality is a pointer
+     * comparison. A value is removed from the table when the last Interned
+     * referring to it is destroyed.
+     *
+     * Instantiated for string, vector<string> and list<string>. The table
+     * is thread-safe.
+     */
+    template <typename Type>
+    class Interned
+    {
+    public:
+
+	Interned() : value(empty_value()) {}
+	Interned(const Type& value) : value(intern(value)) {}
+
+	const Type& get() const { return *value; }
+	operator const Type&() const { return *value; }
+
+	bool empty() const { return value->empty(); }
+
+	bool operator==(const Interned& rhs) const { return value == rhs.value; }
+	bool operator!=(const Interned& rhs) const { return value != rhs.value; }
+
+	// same order as for the values themselves
+	bool operator<(const Interned& rhs) const { return *value < *rhs.value; }
+
+	/**
+	 * The number of distinct values in the table. Values whose last
+	 * Interned is just being destroyed may still be counted.
+	 */
+	static size_t table_size();
+
+    private:
+
+	static std::shared_ptr<const Type> intern(const Type& value);
+	static const std::shared_ptr<const Type>& empty_value();
+
+	std::shared_ptr<const Type> value;
+
+    };
+
+
+    inline std::ostream&
+    operator<<(std::ostream& s, const Interned<string>& interned)
+    {
+	return s << interned.get();
+    }
+
+
+    extern template class Interned<string>;
+    extern template class Interned<vector<string>>;
+    extern template class Interned<list<string>>;
+
+}
+
+#endif
@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#include <stdio.h>
+#include <ctype.h>
+#include <stdexcept>
+#include <algorithm>
+#include <boost/algorithm/string.hpp>
+
+#include "storage/Utils/JsonParser.h"
+
+
+namespace storage
+{
+    using namespace std;
+
+
+    string
+    json_quote(const string& s)
+    {
+	string ret = "\"";
+
+	for (char c : s)
+	{
+	    switch (c)
+	    {
+		case '"': ret += "\\\""; break;
+		case '\\': ret += "\\\\"; break;
+		case '\b': ret += "\\b"; break;
+		case '\f': ret += "\\f"; break;
+		case '\n': ret += "\\n"; break;
+		case '\r': ret += "\\r"; break;
+		case '\t': ret += "\\t"; break;
+
+		default:
+		    if ((unsigned char)(c) < 0x20)
+		    {
+			char tmp[8];
+			snprintf(tmp, sizeof(tmp), "\\u%04x", (unsigned char)(c));
+			ret += tmp;
+		    }
+		    else
+		    {
+			ret += c;
+		    }
+		    break;
+	    }
+	}
+
+	return ret + "\"";
+    }
+
+
+    void
+    JsonParser::parse(const string& text)
+    {
+	pos = text.data();
+	end = text.data() + text.size();
+
+	skip_ws();
+	parse_value();
+	skip_ws();
+
+	if (pos != end)
+	    throw runtime_error("json: trailing garbage");
+    }
+
+
+    void
+    JsonParser::parse(const vector<string>& lines)
+    {
+	parse(boost::join(lines, "\n"));
+    }
+
+
+    void
+    JsonParser::skip_ws()
+    {
+	while (pos != end && (*pos == ' ' || *pos == '\t' || *pos == '\n' || *pos == '\r'))
+	    ++pos;
+    }
+
+
+    char
+    JsonParser::peek()
+    {
+	if (pos == end)
+	    throw runtime_error("json: unexpected end of input");
+
+	return *pos;
+    }
+
+
+    void
+    JsonParser::expect(char c)
+    {
+	if (peek() != c)
+	    throw runtime_error(string("json: expected '") + c + "'");
+
+	++pos;
+    }
+
+
+    void
+    JsonParser::parse_value()
+    {
+	switch (peek())
+	{
+	    case '{':
+		parse_object();
+		break;
+
+	    case '[':
+		parse_array();
+		break;
+
+	    case '"':
+		handler.value(parse_string());
+		break;
+
+	    default:
+		handler.value(parse_literal());
+		break;
+	}
+    }
+
+
+    void
+    JsonParser::parse_object()
+    {
+	expect('{');
+	handler.start_object();
+
+	skip_ws();
+	if (peek() != '}')
+	{
+	    while (true)
+	    {
+		skip_ws();
+		handler.key(parse_string());
+		skip_ws();
+		expect(':');
+		skip_ws();
+		parse_value();
+		skip_ws();
+
+		if (peek() != ',')
+		    break;
+		++pos;
+	    }
+	}
+
+	expect('}');
+	handler.end_object();
+    }
+
+
+    void
+    JsonParser::parse_array()
+    {
+	expect('[');
+	handler.start_array();
+
+	skip_ws();
+	if (peek() != ']')
+	{
+	    while (true)
+	    {
+		skip_ws();
+		parse_value();
+		skip_ws();
+
+		if (peek() != ',')
+		    break;
+		++pos;
+	    }
+	}
+
+	expect(']');
+	handler.end_array();
+    }
+
+
+    string
+    JsonParser::parse_string()
+    {
+	expect('"');
+
+	string ret;
+
+	while (peek() != '"')
+	{
+	    char c = *pos++;
+
+	    if (c != '\\')
+	    {
+		ret += c;
+		continue;
+	    }
+
+	    switch (c = peek())
+	    {
+		case 'b': ret += '\b'; break;
+		case 'f': ret += '\f'; break;
+		case 'n': ret += '\n'; break;
+		case 'r': ret += '\r'; break;
+		case 't': ret += '\t'; break;
+
+		case 'u':
+		{
+		    // only code points below 0x80 are needed so far
+		    if (end - pos < 5)
+			throw runtime_error("json: truncated escape");
+		    if (!all_of(pos + 1, pos + 5, [](char x) { return isxdigit((unsigned char)(x)); }))
+			throw runtime_error("json: invalid escape");
+		    unsigned long code = stoul(string(pos + 1, pos + 5), nullptr, 16);
+		    ret += code < 0x80 ? (char)(code) : '?';
+		    pos += 4;
+		} break;
+
+		default: ret += c; break;
+	    }
+
+	    ++pos;
+	}
+
+	++pos;
+
+	return ret;
+    }
+
+
+    string
+    JsonParser::parse_literal()
+    {
+	const char* start = pos;
+
+	while (pos != end && *pos != ',' && *pos != '}' && *pos != ']' && *pos != ' ' &&
+	       *pos != '\t' && *pos != '\n' && *pos != '\r')
+	    ++pos;
+
+	if (pos == start)
+	    throw runtime_error("json: value expected");
+
+	return string(start, pos);
+    }
+
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#ifndef JSON_PARSER_H
+#define JSON_PARSER_H
+
+
+#include <string>
+#include <vector>
+
+
+namespace storage
+{
+    using std::string;
+    using std::vector;
+
+
+    /**
+     * Callbacks for JsonParser. Scalar values (strings, numbers, true,
+     * false and null) are all delivered as strings.
+     */
+    class JsonHandler
+    {
+    public:
+
+	virtual ~JsonHandler() {}
+
+	virtual void start_object() {}
+	virtual void end_object() {}
+	virtual void start_array() {}
+	virtual void end_array() {}
+	virtual void key(const string& key) {}
+	virtual void value(const string& value) {}
+
+    };
+
+
+    /**
+     * Returns s quoted and escaped for JSON output.
+     */
+    string json_quote(const string& s);
+
+
+    /**
+     * A small event based JSON parser. No document tree is built, the
+     * handler is called while the input is consumed. Throws runtime_error
+     * on malformed input.
+     */
+    class JsonParser
+    {
+    public:
+
+	JsonParser(JsonHandler& handler) : handler(handler) {}
+
+	void parse(const string& text);
+	void parse(const vector<string>& lines);
+
+    private:
+
+	void parse_value();
+	void parse_object();
+	void parse_array();
+	string parse_string();
+	string parse_literal();
+
+	void skip_ws();
+	char peek();
+	void expect(char c);
+
+	JsonHandler& handler;
+
+	const char* pos;
+	const char* end;
+
+    };
+
+}
+
+
+#endif
@@ -94,6 +94,8 @@ namespace storage
     const Mockup::Command&
     Mockup::get_command(const string& name)
     {
+	std::lock_guard<std::mutex> lock(mutex);
+
 	map<string, Command>::const_iterator it = commands.find(name);
 	if (it == commands.end())
 	    throw std::runtime_error("no mockup found for command '" + name + "'");
@@ -105,13 +107,26 @@ namespace storage
     void
     Mockup::set_command(const string& name, const Command& command)
     {
+	std::lock_guard<std::mutex> lock(mutex);
+
 	commands[name] = command;
     }
 
 
+    bool
+    Mockup::has_file(const string& name)
+    {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	return files.find(name) != files.end();
+    }
+
+
     const Mockup::File&
     Mockup::get_file(const string& name)
     {
+	std::lock_guard<std::mutex> lock(mutex);
+
 	map<string, File>::const_iterator it = files.find(name);
 	if (it == files.end())
 	    throw std::runtime_error("no mockup found for file '" + name + "'");
@@ -123,6 +138,8 @@ namespace storage
     void
     Mockup::set_file(const string& name, const File& file)
     {
+	std::lock_guard<std::mutex> lock(mutex);
+
 	files[name] = file;
     }
 
@@ -132,4 +149,6 @@ namespace storage
     map<string, Mockup::Command> Mockup::commands;
     map<string, Mockup::File> Mockup::files;
 
+    std::mutex Mockup::mutex;
+
 }
@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <mutex>
 
 #include "storage/Utils/Remote.h"
 
@@ -37,6 +38,7 @@ namespace storage
 	static const Command& get_command(const string& name);
 	static void set_command(const string& name, const Command& command);
 
+	static bool has_file(const string& name);
 	static const File& get_file(const string& name);
 	static void set_file(const string& name, const File& file);
 
@@ -47,6 +49,9 @@ namespace storage
 	static map<string, Command> commands;
 	static map<string, File> files;
 
+	// protects commands and files, the probe may run several threads
+	static std::mutex mutex;
+
     };
 
 }
@@ -161,4 +161,156 @@ DasdfmtProgressBar::process(const string& val, bool stderr)
 	}
     }
 
+
+
+    thread_local FractionProgress::Callback FractionProgress::current;
+
+
+    FractionProgress::FractionProgress(const string& message)
+	: message(message), callback(current), fraction(-1.0)
+    {
+    }
+
+
+    void
+    FractionProgress::reset()
+    {
+	fraction = -1.0;
+	set_fraction(0.0);
+    }
+
+
+    void
+    FractionProgress::set_fraction(double fraction)
+    {
+	fraction = min(max(fraction, 0.0), 1.0);
+
+	if (fraction <= FractionProgress::fraction)
+	    return;
+
+	FractionProgress::fraction = fraction;
+
+	if (callback)
+	    callback(message, fraction);
+    }
+
+
+    FractionProgress::Record::Record(const Callback& callback)
+	: previous(current)
+    {
+	current = callback;
+    }
+
+
+    FractionProgress::Record::~Record()
+    {
+	current = previous;
+    }
+
+
+    namespace
+    {
+	struct Mke2fsPhase
+	{
+	    const char* prefix;
+	    double weight;
+	};
+
+	const Mke2fsPhase mke2fs_phases[] = {
+	    { "Allocating group tables:", 0.10 },
+	    { "Writing inode tables:", 0.50 },
+	    { "Creating journal", 0.20 },
+	    { "Writing superblocks and filesystem accounting information:", 0.20 }
+	};
+
+	const int num_mke2fs_phases = sizeof(mke2fs_phases) / sizeof(mke2fs_phases[0]);
+
+
+	// Finds the last "done/total" counter in token.
+	bool
+	parse_counter(const string& token, unsigned long& done, unsigned long& total)
+	{
+	    static const char* digits = "0123456789";
+
+	    string::size_type slash = token.rfind('/');
+	    if (slash == string::npos || slash == 0)
+		return false;
+
+	    string::size_type begin = token.find_last_not_of(digits, slash - 1);
+	    begin = begin == string::npos ? 0 : begin + 1;
+	    string::size_type end = token.find_first_not_of(digits, slash + 1);
+	    if (end == string::npos)
+		end = token.size();
+
+	    if (begin == slash || end == slash + 1)
+		return false;
+
+	    done = stoul(token.substr(begin, slash - begin));
+	    total = stoul(token.substr(slash + 1, end - slash - 1));
+
+	    return total > 0;
+	}
+    }
+
+
+    void
+    Mke2fsProgress::reset()
+    {
+	FractionProgress::reset();
+
+	seen.clear();
+	phase = -1;
+    }
+
+
+    void
+    Mke2fsProgress::process(const string& txt, bool stderr)
+    {
+	if (stderr)
+	    return;
+
+	seen += txt;
+
+	// mke2fs updates the counters in place using backspaces so only
+	// complete tokens are parsed
+	string::size_type pos;
+	while ((pos = seen.find_first_of("\b\n")) != string::npos)
+	{
+	    process_token(seen.substr(0, pos));
+	    seen.erase(0, pos + 1);
+	}
+    }
+
+
+    void
+    Mke2fsProgress::process_token(const string& token)
+    {
+	for (int i = phase + 1; i < num_mke2fs_phases; ++i)
+	{
+	    if (token.find(mke2fs_phases[i].prefix) != string::npos)
+	    {
+		phase = i;
+		break;
+	    }
+	}
+
+	if (phase < 0)
+	    return;
+
+	double start = 0.0;
+	for (int i = 0; i < phase; ++i)
+	    start += mke2fs_phases[i].weight;
+
+	const double weight = mke2fs_phases[phase].weight;
+
+	unsigned long done, total;
+
+	if (token.find("done") != string::npos)
+	    set_fraction(start + weight);
+	else if (parse_counter(token, done, total))
+	    set_fraction(start + weight * min(done, total) / total);
+	else
+	    set_fraction(start);
+    }
+
 }
@@ -24,6 +24,8 @@
 #define OUTPUT_PROCESSOR_H
 
 
+#include <functional>
+
 #include "storage/StorageInterface.h"
 
 
@@ -128,6 +130,84 @@ namespace storage
 	unsigned long cur_cyl;
     };
 
+    /**
+     * Reports the progress of a command as a fraction between 0 and 1 to
+     * the callback installed by FractionProgress::Record when the object is
+     * constructed. Without further parsing only the start and the end of
+     * the command are reported. Reported fractions never decrease.
+     */
+    class FractionProgress : public OutputProcessor
+    {
+    public:
+
+	typedef std::function<void(const string& message, double fraction)> Callback;
+
+	FractionProgress(const string& message);
+
+	virtual void reset();
+	virtual void finish() { set_fraction(1.0); }
+	virtual void process(const string& txt, bool stderr) {}
+
+	void set_fraction(double fraction);
+	double get_fraction() const { return fraction; }
+
+	/**
+	 * Installs a callback for FractionProgress objects constructed
+	 * during the lifetime of the Record.
+	 */
+	class Record
+	{
+	public:
+
+	    Record(const Callback& callback);
+	    ~Record();
+
+	private:
+
+	    Callback previous;
+
+	};
+
+    protected:
+
+	const string message;
+	const Callback callback;
+
+    private:
+
+	// per thread so that commits in parallel threads, e.g. of the
+	// ImageBuilder, report to their own callbacks
+	static thread_local Callback current;
+
+	double fraction;
+
+    };
+
+
+    /**
+     * Parses the "done/total" counters mke2fs prints while writing the
+     * group tables, inode tables, journal and superblocks. The phases are
+     * weighted by their usual share of the runtime.
+     */
+    class Mke2fsProgress : public FractionProgress
+    {
+    public:
+
+	Mke2fsProgress(const string& message)
+	    : FractionProgress(message), phase(-1) {}
+
+	virtual void reset();
+	virtual void process(const string& txt, bool stderr);
+
+    private:
+
+	void process_token(const string& token);
+
+	string seen;
+	int phase;
+
+    };
+
 }
 
 
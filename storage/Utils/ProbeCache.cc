@@ -0,0 +1,344 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <list>
+#include <fstream>
+#include <sstream>
+#include <boost/algorithm/string.hpp>
+
+#include "config.h"
+#include "storage/Utils/ProbeCache.h"
+#include "storage/Utils/XmlFile.h"
+#include "storage/Utils/AppUtil.h"
+
+
+namespace storage
+{
+    using namespace std;
+
+
+    ProbeCache* ProbeCache::current = nullptr;
+
+
+    ProbeCache::ProbeCache(const string& filename)
+	: filename(filename), has_global_signature(false), hits(0), misses(0)
+    {
+	if (access(filename.c_str(), R_OK) != 0)
+	    return;
+
+	XmlFile xml(filename);
+
+	const xmlNode* root_node = xml.getRootElement();
+	if (!root_node)
+	{
+	    y2war("ignoring broken probe cache " << filename);
+	    return;
+	}
+
+	const xmlNode* cache_node = getChildNode(root_node, "ProbeCache");
+	if (!cache_node)
+	    return;
+
+	const xmlNode* commands_node = getChildNode(cache_node, "Commands");
+	if (!commands_node)
+	    return;
+
+	for (const xmlNode* command_node : getChildNodes(commands_node))
+	{
+	    string name;
+	    getChildValue(command_node, "name", name);
+
+	    Entry entry;
+	    getChildValue(command_node, "signature", entry.signature);
+	    getChildValue(command_node, "stdout", entry.command.stdout);
+	    getChildValue(command_node, "stderr", entry.command.stderr);
+	    getChildValue(command_node, "exit-code", entry.command.exit_code);
+
+	    entries[name] = entry;
+	}
+
+	y2mil("loaded " << entries.size() << " entries from probe cache " << filename);
+    }
+
+
+    bool
+    ProbeCache::lookup(const string& cmd, RemoteCommand& command)
+    {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	map<string, Entry>::iterator it = entries.find(cmd);
+	if (it != entries.end() && !it->second.signature.empty())
+	{
+	    if (it->second.signature == get_signature(cmd))
+	    {
+		y2mil("probe cache hit for \"" << cmd << "\"");
+
+		it->second.used = true;
+		command = it->second.command;
+		++hits;
+		return true;
+	    }
+	}
+
+	++misses;
+	return false;
+    }
+
+
+    void
+    ProbeCache::store(const string& cmd, const RemoteCommand& command)
+    {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	string signature = get_signature(cmd);
+	if (signature.empty())
+	    return;
+
+	Entry& entry = entries[cmd];
+	entry.signature = signature;
+	entry.command = command;
+	entry.used = true;
+    }
+
+
+    bool
+    ProbeCache::save() const
+    {
+	string dir = filename.substr(0, filename.rfind('/'));
+	if (!dir.empty() && mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST)
+	{
+	    y2war("creating " << dir << " failed errno:" << errno << " (" << strerror(errno) << ")");
+	    return false;
+	}
+
+	XmlFile xml;
+
+	xmlNode* cache_node = xmlNewNode("ProbeCache");
+	xml.setRootElement(cache_node);
+
+	xmlNode* comment = xmlNewComment(" generated by libstorage version " VERSION " ");
+	xmlAddPrevSibling(cache_node, comment);
+
+	xmlNode* commands_node = xmlNewChild(cache_node, "Commands");
+
+	for (const map<string, Entry>::value_type& it : entries)
+	{
+	    // drop entries of devices that are gone
+	    if (!it.second.used)
+		continue;
+
+	    xmlNode* command_node = xmlNewChild(commands_node, "Command");
+
+	    setChildValue(command_node, "name", it.first);
+	    setChildValue(command_node, "signature", it.second.signature);
+	    setChildValue(command_node, "stdout", it.second.command.stdout);
+	    setChildValue(command_node, "stderr", it.second.command.stderr);
+	    setChildValueIf(command_node, "exit-code", it.second.command.exit_code,
+			    it.second.command.exit_code != 0);
+	}
+
+	// a unique temporary file since several processes may save the
+	// cache at the same time, mkstemp also creates it with mode 0600
+	// since the cache may contain output of commands only root can run
+	string tmp_filename = filename + ".XXXXXX";
+	int fd = mkstemp(&tmp_filename[0]);
+	if (fd < 0)
+	{
+	    y2war("creating temporary file for probe cache " << filename << " failed, errno:" <<
+		  errno);
+	    return false;
+	}
+
+	close(fd);
+
+	bool ok = xml.save(tmp_filename) && rename(tmp_filename.c_str(), filename.c_str()) == 0;
+
+	if (!ok)
+	{
+	    y2war("saving probe cache " << filename << " failed");
+	    unlink(tmp_filename.c_str());
+	}
+
+	return ok;
+    }
+
+
+    string
+    ProbeCache::get_signature(const string& cmd)
+    {
+	// commands for block devices, e.g. "parted -s '/dev/sda' ..." or
+	// "mdadm --examine '/dev/sda1' '/dev/sdb1'", depend on all devices
+
+	string signature;
+
+	for (string::size_type pos1 = cmd.find("'/dev/"); pos1 != string::npos;
+	     pos1 = cmd.find("'/dev/", pos1 + 1))
+	{
+	    string::size_type pos2 = cmd.find('\'', pos1 + 1);
+	    string name = cmd.substr(pos1 + 6, pos2 == string::npos ? string::npos : pos2 - pos1 - 6);
+
+	    // a device without a signature of its own, use the global one
+	    if (name.empty() || name.find('/') != string::npos)
+	    {
+		signature.clear();
+		break;
+	    }
+
+	    map<string, string>::const_iterator it = device_signatures.find(name);
+	    if (it == device_signatures.end())
+		it = device_signatures.emplace(name, read_device_signature(name)).first;
+
+	    if (it->second.empty())
+	    {
+		signature.clear();
+		break;
+	    }
+
+	    if (!signature.empty())
+		signature += " ";
+	    signature += it->second;
+	}
+
+	if (!signature.empty())
+	    return signature;
+
+	if (!has_global_signature)
+	{
+	    global_signature = read_global_signature();
+	    has_global_signature = true;
+	}
+
+	return global_signature;
+    }
+
+
+    static bool
+    read_file(const string& path, string& content)
+    {
+	ifstream file(path);
+	if (!file)
+	    return false;
+
+	ostringstream buffer;
+	buffer << file.rdbuf();
+	content = buffer.str();
+	return true;
+    }
+
+
+    static string
+    content_hash(const string& path)
+    {
+	string content;
+	if (!read_file(path, content))
+	    return "none";
+
+	// std::hash may differ between processes, the cache is persistent
+	ostringstream ret;
+	ret << content.size() << ":" << hex << crc32(content.data(), content.size());
+	return ret.str();
+    }
+
+
+    static string
+    lvm_seqnos()
+    {
+	string ret;
+
+	DIR* dir = opendir("/etc/lvm/backup");
+	if (!dir)
+	    return ret;
+
+	list<string> names;
+
+	struct dirent* entry;
+	while ((entry = readdir(dir)) != NULL)
+	{
+	    if (entry->d_name[0] != '.')
+		names.push_back(entry->d_name);
+	}
+
+	closedir(dir);
+
+	names.sort();
+
+	for (const string& name : names)
+	{
+	    string content;
+	    if (!read_file("/etc/lvm/backup/" + name, content))
+		continue;
+
+	    string::size_type pos = content.find("\nseqno = ");
+	    if (pos == string::npos)
+		continue;
+
+	    ret += name + "=" + content.substr(pos + 9, content.find('\n', pos + 9) - pos - 9) + ",";
+	}
+
+	return ret;
+    }
+
+
+    string
+    ProbeCache::read_global_signature() const
+    {
+	string seqnum;
+	if (!read_file("/sys/kernel/uevent_seqnum", seqnum))
+	    return "";
+
+	boost::trim(seqnum);
+
+	return "seqnum:" + seqnum + " partitions:" + content_hash("/proc/partitions") +
+	    " mdstat:" + content_hash("/proc/mdstat") + " lvm:" + lvm_seqnos();
+    }
+
+
+    string
+    ProbeCache::read_device_signature(const string& name) const
+    {
+	string dev, size;
+	if (!read_file("/sys/class/block/" + name + "/dev", dev) ||
+	    !read_file("/sys/class/block/" + name + "/size", size))
+	    return "";
+
+	boost::trim(dev);
+	boost::trim(size);
+
+	// udev rewrites its database entry for every event of the device
+	struct stat st;
+	if (stat(("/run/udev/data/b" + dev).c_str(), &st) != 0)
+	    return "";
+
+	ostringstream ret;
+	ret << "dev:" << dev << " size:" << size << " udev:" << st.st_mtim.tv_sec << "."
+	    << st.st_mtim.tv_nsec;
+	return ret.str();
+    }
+
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#ifndef PROBE_CACHE_H
+#define PROBE_CACHE_H
+
+
+#include <string>
+#include <map>
+#include <mutex>
+#include <boost/noncopyable.hpp>
+
+#include "storage/Utils/Remote.h"
+
+
+#define PROBE_CACHE_FILE "/run/libstorage/probe-cache.xml"
+
+
+namespace storage
+{
+    using std::string;
+    using std::map;
+
+
+    /**
+     * Persistent cache for the output of probe commands. Each entry
+     * carries a signature of the state it was recorded in and is only
+     * used while the signature is unchanged.
+     *
+     * Commands naming a block device, e.g. parted or udevadm on
+     * '/dev/sda', are keyed by the dev_t and size of the device and the
+     * time udev last processed an event for it. All other commands are
+     * keyed by the kernel uevent sequence number, /proc/partitions,
+     * /proc/mdstat and the seqno of the LVM metadata backups. If no
+     * signature can be determined the command is not cached.
+     *
+     * Like ProbeProfile the cache is only used while made current with a
+     * Record object.
+     */
+    class ProbeCache : private boost::noncopyable
+    {
+    public:
+
+	/**
+	 * Loads the cache from filename. A missing or broken file gives an
+	 * empty cache.
+	 */
+	ProbeCache(const string& filename);
+	virtual ~ProbeCache() {}
+
+	bool lookup(const string& cmd, RemoteCommand& command);
+	void store(const string& cmd, const RemoteCommand& command);
+
+	/**
+	 * Saves the entries used or stored since loading. Errors are
+	 * logged and false is returned.
+	 */
+	bool save() const;
+
+	unsigned int get_hits() const { return hits; }
+	unsigned int get_misses() const { return misses; }
+
+	static ProbeCache* get_current() { return current; }
+
+	class Record : private boost::noncopyable
+	{
+	public:
+
+	    Record(ProbeCache& cache) : previous(current) { current = &cache; }
+	    ~Record() { current = previous; }
+
+	private:
+
+	    ProbeCache* previous;
+
+	};
+
+    protected:
+
+	// an empty signature means the state cannot be determined
+	virtual string read_global_signature() const;
+	virtual string read_device_signature(const string& name) const;
+
+    private:
+
+	string get_signature(const string& cmd);
+
+	struct Entry
+	{
+	    Entry() : signature(), command(), used(false) {}
+
+	    string signature;
+	    RemoteCommand command;
+	    bool used;
+	};
+
+	const string filename;
+
+	map<string, Entry> entries;
+
+	// signatures are determined once per probe
+	bool has_global_signature;
+	string global_signature;
+	map<string, string> device_signatures;
+
+	unsigned int hits;
+	unsigned int misses;
+
+	// lookup and store are called from all probe threads
+	std::mutex mutex;
+
+	static ProbeCache* current;
+
+    };
+
+}
+
+
+#endif
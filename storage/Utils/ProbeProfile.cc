@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#include <fstream>
+#include <algorithm>
+#include <boost/core/demangle.hpp>
+#include <boost/algorithm/string.hpp>
+#include <boost/io/ios_state.hpp>
+
+#include "storage/Utils/ProbeProfile.h"
+
+
+namespace storage
+{
+    using namespace std;
+
+
+    thread_local ProbeProfile* ProbeProfile::current = nullptr;
+
+
+    void
+    ProbeProfile::clear()
+    {
+	phases.clear();
+	phase_indices.clear();
+	stack.clear();
+	commands.clear();
+	caches.clear();
+    }
+
+
+    size_t
+    ProbeProfile::enter(const string& name)
+    {
+	string path = stack.empty() ? name : phases[stack.back()].name + " > " + name;
+
+	map<string, size_t>::const_iterator it = phase_indices.find(path);
+	if (it == phase_indices.end())
+	{
+	    phases.emplace_back(path, stack.size());
+	    it = phase_indices.emplace(path, phases.size() - 1).first;
+	}
+
+	stack.push_back(it->second);
+
+	return it->second;
+    }
+
+
+    void
+    ProbeProfile::leave(size_t index, double time)
+    {
+	phases[index].time += time;
+
+	if (!stack.empty() && stack.back() == index)
+	    stack.pop_back();
+    }
+
+
+    ProbeProfile::Phase*
+    ProbeProfile::get_current_phase()
+    {
+	return stack.empty() ? nullptr : &phases[stack.back()];
+    }
+
+
+    void
+    ProbeProfile::record_command(const string& cmd, double time, int exit_code)
+    {
+	Phase* phase = get_current_phase();
+	if (phase)
+	{
+	    phase->commands++;
+	    phase->command_time += time;
+	}
+
+	Command& command = commands[cmd];
+	if (command.count == 0 && phase)
+	    command.phase = phase->name;
+	command.count++;
+	command.time += time;
+	command.exit_code = exit_code;
+    }
+
+
+    void
+    ProbeProfile::record_lookup(const std::type_info& type, bool hit, double time)
+    {
+	Phase* phase = get_current_phase();
+	if (phase)
+	{
+	    if (hit)
+		phase->cache_hits++;
+	    else
+		phase->cache_misses++;
+	}
+
+	Cache& cache = caches[type_index(type)];
+	if (hit)
+	    cache.hits++;
+	else
+	    cache.misses++;
+	cache.time += time;
+    }
+
+
+    map<string, ProbeProfile::Cache>
+    ProbeProfile::get_caches() const
+    {
+	map<string, Cache> ret;
+
+	for (const map<type_index, Cache>::value_type& it : caches)
+	{
+	    string name = boost::core::demangle(it.first.name());
+	    boost::replace_all(name, "storage::", "");
+
+	    // types are unique, the demangled names not necessarily
+	    Cache& cache = ret[name];
+	    cache.hits += it.second.hits;
+	    cache.misses += it.second.misses;
+	    cache.time += it.second.time;
+	}
+
+	return ret;
+    }
+
+
+    void
+    ProbeProfile::save(const string& filename) const
+    {
+	ofstream out(filename);
+	classic(out);
+
+	out << *this;
+
+	out.close();
+
+	if (!out.good())
+	    y2err("writing probe profile " << filename << " failed");
+    }
+
+
+    std::ostream&
+    operator<<(std::ostream& s, const ProbeProfile& probe_profile)
+    {
+	boost::io::ios_all_saver ias(s);
+
+	s << fixed;
+	s.precision(3);
+
+	for (const ProbeProfile::Phase& phase : probe_profile.phases)
+	{
+	    s << string(2 * phase.depth, ' ') << "phase:" << phase.name << " time:" << phase.time
+	      << "s commands:" << phase.commands << " command-time:" << phase.command_time
+	      << "s cache-hits:" << phase.cache_hits << " cache-misses:" << phase.cache_misses
+	      << '\n';
+	}
+
+	// most expensive commands first
+
+	typedef map<string, ProbeProfile::Command>::const_iterator command_iterator;
+
+	vector<command_iterator> commands;
+	for (command_iterator it = probe_profile.commands.begin(); it != probe_profile.commands.end(); ++it)
+	    commands.push_back(it);
+
+	stable_sort(commands.begin(), commands.end(), [](command_iterator a, command_iterator b) {
+	    return a->second.time > b->second.time;
+	});
+
+	for (command_iterator it : commands)
+	{
+	    s << "command:" << it->first << " count:" << it->second.count << " time:"
+	      << it->second.time << "s exit-code:" << it->second.exit_code;
+	    if (!it->second.phase.empty())
+		s << " phase:" << it->second.phase;
+	    s << '\n';
+	}
+
+	for (const map<string, ProbeProfile::Cache>::value_type& it : probe_profile.get_caches())
+	{
+	    s << "cache:" << it.first << " hits:" << it.second.hits << " misses:" << it.second.misses
+	      << " time:" << it.second.time << "s\n";
+	}
+
+	return s;
+    }
+
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#ifndef PROBE_PROFILE_H
+#define PROBE_PROFILE_H
+
+
+#include <string>
+#include <vector>
+#include <map>
+#include <typeinfo>
+#include <typeindex>
+#include <ostream>
+#include <boost/noncopyable.hpp>
+
+#include "storage/Utils/AppUtil.h"
+
+
+namespace storage
+{
+    using std::string;
+    using std::vector;
+    using std::map;
+
+
+    /**
+     * Statistics of a probe run: the time spent in each probe phase, the
+     * commands run and the hit rates of the SystemInfo cache. Phases nest
+     * and the commands and cache lookups are attributed to the innermost
+     * phase.
+     *
+     * Recording only happens while a profile is made current with a
+     * Record object, otherwise the hooks in SystemCmd and SystemInfo only
+     * check a pointer. The profile is only current in the thread that
+     * created the Record object.
+     */
+    class ProbeProfile
+    {
+    public:
+
+	struct Phase
+	{
+	    Phase(const string& name, unsigned int depth)
+		: name(name), depth(depth), time(0.0), commands(0), command_time(0.0),
+		  cache_hits(0), cache_misses(0) {}
+
+	    string name;
+	    unsigned int depth;
+
+	    // including nested phases
+	    double time;
+
+	    // excluding nested phases
+	    unsigned int commands;
+	    double command_time;
+	    unsigned int cache_hits;
+	    unsigned int cache_misses;
+	};
+
+	struct Command
+	{
+	    Command() : count(0), time(0.0), exit_code(0) {}
+
+	    // phase of the first run
+	    string phase;
+
+	    unsigned int count;
+	    double time;
+	    int exit_code;
+	};
+
+	struct Cache
+	{
+	    Cache() : hits(0), misses(0), time(0.0) {}
+
+	    unsigned int hits;
+	    unsigned int misses;
+
+	    // time spent on misses, i.e. for creating the objects
+	    double time;
+	};
+
+	const vector<Phase>& get_phases() const { return phases; }
+	const map<string, Command>& get_commands() const { return commands; }
+
+	/**
+	 * The cache statistics by the (demangled) class name of the cached
+	 * SystemInfo object.
+	 */
+	map<string, Cache> get_caches() const;
+
+	void clear();
+
+	void record_command(const string& cmd, double time, int exit_code);
+	void record_lookup(const std::type_info& type, bool hit, double time);
+
+	static ProbeProfile* get_current() { return current; }
+
+	/**
+	 * Makes the profile current for the lifetime of the object.
+	 */
+	class Record : private boost::noncopyable
+	{
+	public:
+
+	    Record(ProbeProfile& profile) : previous(current) { current = &profile; }
+	    ~Record() { current = previous; }
+
+	private:
+
+	    ProbeProfile* previous;
+
+	};
+
+	/**
+	 * A phase lasting for the lifetime of the object. Phases with the
+	 * same name and parent are accumulated.
+	 */
+	class Scope : private boost::noncopyable
+	{
+	public:
+
+	    Scope(const string& name)
+		: profile(current)
+	    {
+		if (profile)
+		    index = profile->enter(name);
+	    }
+
+	    ~Scope()
+	    {
+		if (profile)
+		    profile->leave(index, stopwatch.read());
+	    }
+
+	private:
+
+	    ProbeProfile* profile;
+	    size_t index;
+	    StopWatch stopwatch;
+
+	};
+
+	void save(const string& filename) const;
+
+	friend std::ostream& operator<<(std::ostream& s, const ProbeProfile& probe_profile);
+
+    private:
+
+	size_t enter(const string& name);
+	void leave(size_t index, double time);
+
+	Phase* get_current_phase();
+
+	vector<Phase> phases;
+
+	// phase indices by path
+	map<string, size_t> phase_indices;
+
+	// stack of the active phases
+	vector<size_t> stack;
+
+	map<string, Command> commands;
+	map<std::type_index, Cache> caches;
+
+	// per thread, the threads of a parallel probe do not record
+	static thread_local ProbeProfile* current;
+
+    };
+
+}
+
+
+#endif
@@ -20,152 +20,170 @@
  */
 
 
-#include "storage/Utils/RegionImpl.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <iostream>
+
+#include "storage/Utils/Region.h"
+#include "storage/Utils/XmlFile.h"
 
 
 namespace storage
 {
+    using namespace std;
+
 
-    Region::Region()
-	: impl(new Impl())
+    Region
+    Region::intersection(const Region& rhs) const
     {
-    }
+	if (!intersect(rhs))
+	    throw runtime_error("regions do not intersect");
 
+	unsigned long long s = max(rhs.get_start(), get_start());
+	unsigned long long e = min(rhs.get_end(), get_end());
 
-    Region::Region(unsigned long long start, unsigned long long len)
-        : impl(new Impl(start, len))
-    {
+	return Region(s, e - s + 1);
     }
 
 
-    Region::~Region()
+    Region
+    Region::unite(const Region& rhs) const
     {
-    }
+	if (empty())
+	    return rhs;
 
+	if (rhs.empty())
+	    return *this;
 
-    Region::Impl&
-    Region::get_impl()
-    {
-        return *impl;
-    }
+	if (!intersect(rhs) && get_end() + 1 != rhs.start && rhs.get_end() + 1 != start)
+	    throw runtime_error("regions do not intersect");
 
+	unsigned long long s = min(rhs.get_start(), get_start());
+	unsigned long long e = max(rhs.get_end(), get_end());
 
-    const Region::Impl&
-    Region::get_impl() const
-    {
-        return *impl;
+	return Region(s, e - s + 1);
     }
 
 
-    bool
-    Region::empty() const
+    vector<Region>
+    Region::subtract(const Region& rhs) const
     {
-        return get_impl().empty();
-    }
+	vector<Region> ret;
 
+	if (empty())
+	    return ret;
 
-    unsigned long long
-    Region::get_start() const
-    {
-        return get_impl().get_start();
-    }
+	if (rhs.empty() || !intersect(rhs))
+	{
+	    ret.push_back(*this);
+	    return ret;
+	}
 
+	if (rhs.start > start)
+	    ret.push_back(Region(start, rhs.start - start));
 
-    unsigned long long
-    Region::get_length() const
-    {
-        return get_impl().get_length();
+	if (rhs.get_end() < get_end())
+	    ret.push_back(Region(rhs.get_end() + 1, get_end() - rhs.get_end()));
+
+	return ret;
     }
 
 
-    unsigned long long
-    Region::get_end() const
+    Region
+    Region::align(unsigned long long alignment) const
     {
-        return get_impl().get_end();
-    }
+	if (alignment == 0)
+	    throw invalid_argument("alignment is zero");
 
+	unsigned long long s = (start + alignment - 1) / alignment * alignment;
+	unsigned long long e = (start + length) / alignment * alignment;
 
-    void
-    Region::set_start(unsigned long long start)
-    {
-	get_impl().set_start(start);
+	return e > s ? Region(s, e - s) : Region(s, 0);
     }
 
 
-    void
-    Region::set_length(unsigned long long length)
+    vector<Region>
+    merge_regions(vector<Region> regions)
     {
-	get_impl().set_length(length);
-    }
+	regions.erase(remove_if(regions.begin(), regions.end(), [](const Region& region) {
+	    return region.empty();
+	}), regions.end());
 
+	sort(regions.begin(), regions.end());
 
-    bool
-    Region::operator==(const Region& rhs) const
-    {
-	return get_impl().operator==(rhs.get_impl());
-    }
+	vector<Region> ret;
 
+	for (const Region& region : regions)
+	{
+	    if (!ret.empty() && region.get_start() <= ret.back().get_end() + 1)
+		ret.back() = ret.back().unite(region);
+	    else
+		ret.push_back(region);
+	}
 
-    bool
-    Region::operator!=(const Region& rhs) const
-    {
-	return get_impl().operator!=(rhs.get_impl());
+	return ret;
     }
 
 
-    bool
-    Region::operator<(const Region& rhs) const
+    vector<Region>
+    subtract_regions(const Region& region, const vector<Region>& used)
     {
-	return get_impl().operator<(rhs.get_impl());
-    }
+	vector<Region> ret;
 
+	if (region.empty())
+	    return ret;
 
-    bool
-    Region::operator>(const Region& rhs) const
-    {
-	return get_impl().operator>(rhs.get_impl());
-    }
+	unsigned long long start = region.get_start();
 
+	for (const Region& tmp : merge_regions(used))
+	{
+	    if (tmp.get_end() < start)
+		continue;
 
-    bool
-    Region::inside(const Region& rhs) const
-    {
-	return get_impl().inside(rhs.get_impl());
-    }
+	    if (tmp.get_start() > region.get_end())
+		break;
 
+	    if (tmp.get_start() > start)
+		ret.push_back(Region(start, tmp.get_start() - start));
 
-    bool
-    Region::intersect(const Region& rhs) const
-    {
-	return get_impl().intersect(rhs.get_impl());
-    }
+	    start = tmp.get_end() + 1;
+	}
 
+	if (start <= region.get_end())
+	    ret.push_back(Region(start, region.get_end() - start + 1));
 
-    Region
-    Region::intersection(const Region& rhs) const
-    {
-	return get_impl().intersection(rhs.get_impl());
+	return ret;
     }
 
 
     std::ostream&
     operator<<(std::ostream& s, const Region& region)
     {
-	return operator<<(s, region.get_impl());
+	return s << "[" << region.start << "," << region.length << "]";
     }
 
 
     bool
     getChildValue(const xmlNode* node, const char* name, Region& value)
     {
-	return getChildValue(node, name, value.get_impl());
+	const xmlNode* tmp = getChildNode(node, name);
+	if (!tmp)
+	    return false;
+
+	getChildValue(tmp, "start", value.start);
+	getChildValue(tmp, "length", value.length);
+	return true;
     }
 
 
     void
     setChildValue(xmlNode* node, const char* name, const Region& value)
     {
-	setChildValue(node, name, value.get_impl());
+	xmlNode* tmp = xmlNewChild(node, name);
+
+	setChildValue(tmp, "start", value.start);
+	setChildValue(tmp, "length", value.length);
     }
 
 }
@@ -20,12 +20,13 @@
  */
 
 
+
 #ifndef REGION_H
 #define REGION_H
 
 
 #include <libxml/tree.h>
-#include <memory>
+#include <vector>
 
 #include "storage/StorageInterface.h"
 
@@ -35,54 +36,105 @@ namespace storage
     using namespace storage_legacy;
 
 
+    /**
+     * A region of blocks, e.g. sectors or cylinders, given by start and
+     * length. Region is a small value type that can be copied freely.
+     */
     class Region
     {
     public:
 
-	Region();
-	Region(unsigned long long start, unsigned long long length);
-	Region(const RegionInfo& region) : Region(region.start, region.len) {}
-	~Region();
-
-	bool empty() const;
-
-	unsigned long long get_start() const;
-	unsigned long long get_length() const;
-	unsigned long long get_end() const;
-
-	void set_start(unsigned long long start);
-	void set_length(unsigned long long length);
-
-	bool operator==(const Region& rhs) const;
-	bool operator!=(const Region& rhs) const;
-	bool operator<(const Region& rhs) const;
-	bool operator>(const Region& rhs) const;
-
-	bool inside(const Region& rhs) const;
-
-	bool intersect(const Region& rhs) const;
+	constexpr Region() : start(0), length(0) {}
+	constexpr Region(unsigned long long start, unsigned long long length)
+	    : start(start), length(length) {}
+	constexpr Region(const RegionInfo& region) : start(region.start), length(region.len) {}
+
+	constexpr bool empty() const { return length == 0; }
+
+	constexpr unsigned long long get_start() const { return start; }
+	constexpr unsigned long long get_length() const { return length; }
+	constexpr unsigned long long get_end() const { return start + length - 1; }
+
+	void set_start(unsigned long long start) { Region::start = start; }
+	void set_length(unsigned long long length) { Region::length = length; }
+
+	constexpr bool operator==(const Region& rhs) const
+	    { return start == rhs.start && length == rhs.length; }
+	constexpr bool operator!=(const Region& rhs) const
+	    { return !(*this == rhs); }
+	constexpr bool operator<(const Region& rhs) const
+	    { return start < rhs.start; }
+	constexpr bool operator>(const Region& rhs) const
+	    { return start > rhs.start; }
+
+	/**
+	 * Checks whether the region is inside rhs.
+	 */
+	constexpr bool inside(const Region& rhs) const
+	    { return start >= rhs.start && get_end() <= rhs.get_end(); }
+
+	/**
+	 * Checks whether rhs is inside the region.
+	 */
+	constexpr bool contains(const Region& rhs) const
+	    { return rhs.inside(*this); }
+
+	constexpr bool contains(unsigned long long block) const
+	    { return block >= start && block - start < length; }
+
+	constexpr bool intersect(const Region& rhs) const
+	    { return rhs.start <= get_end() && rhs.get_end() >= start; }
+
+	/**
+	 * Throws runtime_error if the regions do not intersect.
+	 */
 	Region intersection(const Region& rhs) const;
 
-	friend std::ostream& operator<<(std::ostream& s, const Region& region);
+	/**
+	 * Returns the union of the regions. Throws runtime_error if the
+	 * regions neither intersect nor are adjacent.
+	 */
+	Region unite(const Region& rhs) const;
 
-    public:
+	/**
+	 * Returns the parts of the region not covered by rhs, sorted by
+	 * start.
+	 */
+	std::vector<Region> subtract(const Region& rhs) const;
 
-	class Impl;
+	/**
+	 * Returns the largest region inside the region whose start and
+	 * length are multiples of alignment. May be empty.
+	 */
+	Region align(unsigned long long alignment) const;
 
-	Impl& get_impl();
-	const Impl& get_impl() const;
+	friend std::ostream& operator<<(std::ostream& s, const Region& region);
 
 	friend bool getChildValue(const xmlNode* node, const char* name, Region& value);
 	friend void setChildValue(xmlNode* node, const char* name, const Region& value);
 
-	operator RegionInfo() const { return RegionInfo(get_start(), get_length()); }
+	operator RegionInfo() const { return RegionInfo(start, length); }
 
     private:
 
-	std::shared_ptr<Impl> impl;
+	unsigned long long start;
+	unsigned long long length;
 
     };
 
+
+    /**
+     * Sorts the regions and merges intersecting and adjacent regions.
+     * Empty regions are dropped.
+     */
+    std::vector<Region> merge_regions(std::vector<Region> regions);
+
+    /**
+     * Returns the parts of region not covered by any of the used regions,
+     * sorted by start.
+     */
+    std::vector<Region> subtract_regions(const Region& region, const std::vector<Region>& used);
+
 }
 
 #endif
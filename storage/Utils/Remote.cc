@@ -1,11 +1,27 @@
 
 
 #include "storage/Utils/Remote.h"
+#include "storage/Utils/RemotePrefetch.h"
 
 
 namespace storage
 {
 
+    RemoteBatchResult
+    RemoteCallbacks::get_batch(const RemoteBatch& batch) const
+    {
+	RemoteBatchResult result;
+
+	for (const std::string& name : batch.commands)
+	    result.commands.push_back(get_command(name));
+
+	for (const std::string& name : batch.files)
+	    result.files.push_back(get_file(name));
+
+	return result;
+    }
+
+
     static const RemoteCallbacks* remote_callbacks = nullptr;
 
 
@@ -20,6 +36,9 @@ namespace storage
     set_remote_callbacks(const RemoteCallbacks* remote_callbacks)
     {
 	storage::remote_callbacks = remote_callbacks;
+
+	// prefetched results belong to the previous callbacks
+	RemotePrefetch::clear();
     }
 
 }
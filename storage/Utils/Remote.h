@@ -36,6 +36,26 @@ namespace storage
     };
 
 
+    struct RemoteBatch
+    {
+	RemoteBatch() : commands(), files() {}
+	RemoteBatch(const std::vector<std::string>& commands, const std::vector<std::string>& files)
+	    : commands(commands), files(files) {}
+
+	std::vector<std::string> commands;
+	std::vector<std::string> files;
+    };
+
+
+    struct RemoteBatchResult
+    {
+	RemoteBatchResult() : commands(), files() {}
+
+	std::vector<RemoteCommand> commands;
+	std::vector<RemoteFile> files;
+    };
+
+
     class RemoteCallbacks
     {
     public:
@@ -45,6 +65,13 @@ namespace storage
 	virtual RemoteCommand get_command(const std::string& name) const = 0;
 	virtual RemoteFile get_file(const std::string& name) const = 0;
 
+	// Returns the results of all commands and files of the batch, in
+	// the same order. Used by the probe to request everything it knows
+	// it will need at once. The default implementation calls get_command
+	// and get_file for each entry, implementations with a high latency
+	// should override it to pipeline the requests.
+	virtual RemoteBatchResult get_batch(const RemoteBatch& batch) const;
+
     };
 
     const RemoteCallbacks* get_remote_callbacks();
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#include "storage/Utils/AppUtil.h"
+#include "storage/Utils/Mockup.h"
+#include "storage/Utils/RemotePrefetch.h"
+
+
+namespace storage
+{
+    using namespace std;
+
+
+    void
+    RemotePrefetch::prefetch(const vector<string>& commands, const vector<string>& files)
+    {
+	const RemoteCallbacks* remote_callbacks = get_remote_callbacks();
+	if (!remote_callbacks || Mockup::get_mode() == Mockup::Mode::PLAYBACK)
+	    return;
+
+	RemoteBatch batch;
+
+	{
+	    lock_guard<std::mutex> lock(mutex);
+
+	    for (const string& name : commands)
+		if (RemotePrefetch::commands.count(name) == 0)
+		    batch.commands.push_back(name);
+
+	    for (const string& name : files)
+		if (RemotePrefetch::files.count(name) == 0)
+		    batch.files.push_back(name);
+	}
+
+	if (batch.commands.empty() && batch.files.empty())
+	    return;
+
+	y2mil("prefetching " << batch.commands.size() << " commands and " << batch.files.size() <<
+	      " files");
+
+	RemoteBatchResult result;
+
+	try
+	{
+	    result = remote_callbacks->get_batch(batch);
+	}
+	catch (const exception& e)
+	{
+	    y2err("remote batch failed: " << e.what());
+	    return;
+	}
+
+	if (result.commands.size() != batch.commands.size() ||
+	    result.files.size() != batch.files.size())
+	{
+	    y2err("remote batch result does not match request");
+	    return;
+	}
+
+	lock_guard<std::mutex> lock(mutex);
+
+	++batches;
+
+	for (size_t i = 0; i < batch.commands.size(); ++i)
+	    RemotePrefetch::commands[batch.commands[i]] = result.commands[i];
+
+	for (size_t i = 0; i < batch.files.size(); ++i)
+	    RemotePrefetch::files[batch.files[i]] = result.files[i];
+    }
+
+
+    RemoteCommand
+    RemotePrefetch::get_command(const string& name)
+    {
+	{
+	    lock_guard<std::mutex> lock(mutex);
+
+	    map<string, RemoteCommand>::iterator it = commands.find(name);
+	    if (it != commands.end())
+	    {
+		RemoteCommand command = std::move(it->second);
+		commands.erase(it);
+		++hits;
+		return command;
+	    }
+	}
+
+	return get_remote_callbacks()->get_command(name);
+    }
+
+
+    RemoteFile
+    RemotePrefetch::get_file(const string& name)
+    {
+	{
+	    lock_guard<std::mutex> lock(mutex);
+
+	    map<string, RemoteFile>::iterator it = files.find(name);
+	    if (it != files.end())
+	    {
+		RemoteFile file = std::move(it->second);
+		files.erase(it);
+		++hits;
+		return file;
+	    }
+	}
+
+	return get_remote_callbacks()->get_file(name);
+    }
+
+
+    void
+    RemotePrefetch::clear()
+    {
+	lock_guard<std::mutex> lock(mutex);
+
+	if (!commands.empty() || !files.empty())
+	    y2mil("dropping " << commands.size() << " unused prefetched commands and " <<
+		  files.size() << " files");
+
+	commands.clear();
+	files.clear();
+	hits = batches = 0;
+    }
+
+
+    std::mutex RemotePrefetch::mutex;
+
+    map<string, RemoteCommand> RemotePrefetch::commands;
+    map<string, RemoteFile> RemotePrefetch::files;
+
+    unsigned int RemotePrefetch::hits = 0;
+    unsigned int RemotePrefetch::batches = 0;
+
+}
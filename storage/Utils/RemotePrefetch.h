@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#ifndef REMOTE_PREFETCH_H
+#define REMOTE_PREFETCH_H
+
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+
+#include "storage/Utils/Remote.h"
+
+
+namespace storage
+{
+    using std::string;
+    using std::vector;
+    using std::map;
+
+
+    /**
+     * Results of remote commands and files requested ahead of time with
+     * one RemoteCallbacks::get_batch call. SystemCmd, AsciiFile and File
+     * get their remote results through this class so a prefetched result
+     * saves a round trip. Each prefetched result is used only once, later
+     * requests for the same name go to the remote callbacks again.
+     */
+    class RemotePrefetch
+    {
+    public:
+
+	/**
+	 * Requests the commands and files not already pending in one
+	 * batch. Does nothing without remote callbacks or during mockup
+	 * playback. Errors are only logged since the results will be
+	 * requested one by one later anyway.
+	 */
+	static void prefetch(const vector<string>& commands, const vector<string>& files);
+
+	static RemoteCommand get_command(const string& name);
+	static RemoteFile get_file(const string& name);
+
+	static void clear();
+
+	static unsigned int get_hits() { return hits; }
+	static unsigned int get_batches() { return batches; }
+
+    private:
+
+	static std::mutex mutex;
+
+	static map<string, RemoteCommand> commands;
+	static map<string, RemoteFile> files;
+
+	static unsigned int hits;
+	static unsigned int batches;
+
+    };
+
+}
+
+
+#endif
@@ -37,6 +37,8 @@
 
 #define MDADMBIN "/sbin/mdadm"
 
+#define LVMBIN "/sbin/lvm"
+
 #define PVCREATEBIN "/sbin/pvcreate"
 
 #define LVCREATEBIN "/sbin/lvcreate"
@@ -27,6 +27,7 @@
 #include <ostream>
 #include <fstream>
 #include <sys/wait.h>
+#include <sys/syscall.h>
 #include <string>
 #include <boost/algorithm/string.hpp>
 
@@ -34,6 +35,11 @@
 #include "storage/Utils/SystemCmd.h"
 #include "storage/Utils/Mockup.h"
 #include "storage/Utils/OutputProcessor.h"
+#include "storage/Utils/Tracer.h"
+#include "storage/Utils/ProbeProfile.h"
+#include "storage/Utils/ProbeCache.h"
+#include "storage/Utils/RemotePrefetch.h"
+#include "storage/Utils/AsyncCmd.h"
 
 
 namespace storage
@@ -61,7 +67,8 @@ SystemCmd::SystemCmd()
 void SystemCmd::init()
     {
     File_aC[0] = File_aC[1] = NULL;
-    pfds[0].events = pfds[1].events = POLLIN;
+    pfds[0].fd = pfds[1].fd = pfds[2].fd = -1;
+    pfds[0].events = pfds[1].events = pfds[2].events = POLLIN;
     }
 
 
@@ -71,6 +78,8 @@ SystemCmd::~SystemCmd()
 	fclose( File_aC[IDX_STDOUT] );
     if( File_aC[IDX_STDERR] )
 	fclose( File_aC[IDX_STDERR] );
+    if( pfds[2].fd >= 0 )
+	close( pfds[2].fd );
     }
 
 
@@ -88,32 +97,66 @@ SystemCmd::closeOpenFds() const
     int
     SystemCmd::execute(const string& Cmd_Cv)
     {
+	Tracer::Span span("command", Cmd_Cv);
+
 	if (Mockup::get_mode() == Mockup::Mode::PLAYBACK)
 	{
 	    const Mockup::Command& mockup_command = Mockup::get_command(Cmd_Cv);
 	    Lines_aC[IDX_STDOUT] = mockup_command.stdout;
 	    Lines_aC[IDX_STDERR] = mockup_command.stderr;
 	    Ret_i = mockup_command.exit_code;
+	    span.set_arg("exit-code", Ret_i);
+	    span.set_arg("source", "mockup");
+	    if (ProbeProfile::get_current())
+		ProbeProfile::get_current()->record_command(Cmd_Cv, 0.0, Ret_i);
+	    return 0;
+	}
+
+	ProbeCache* probe_cache = ProbeCache::get_current();
+
+	RemoteCommand cached_command;
+	if (probe_cache && probe_cache->lookup(Cmd_Cv, cached_command))
+	{
+	    Lines_aC[IDX_STDOUT] = cached_command.stdout;
+	    Lines_aC[IDX_STDERR] = cached_command.stderr;
+	    Ret_i = cached_command.exit_code;
+	    span.set_arg("exit-code", Ret_i);
+	    span.set_arg("source", "cache");
+	    if (ProbeProfile::get_current())
+		ProbeProfile::get_current()->record_command(Cmd_Cv, 0.0, Ret_i);
 	    return 0;
 	}
 
+	StopWatch stopwatch;
+
 	int ret;
 
 	if (get_remote_callbacks())
 	{
-	    const RemoteCommand remote_command = get_remote_callbacks()->get_command(Cmd_Cv);
+	    const RemoteCommand remote_command = RemotePrefetch::get_command(Cmd_Cv);
 	    Lines_aC[IDX_STDOUT] = remote_command.stdout;
 	    Lines_aC[IDX_STDERR] = remote_command.stderr;
 	    Ret_i = remote_command.exit_code;
 	    ret = 0;
+	    span.set_arg("source", "remote");
 	}
 	else
 	{
 	    y2mil("SystemCmd Executing:\"" << Cmd_Cv << "\"");
 	    Background_b = false;
 	    ret = doExecute(Cmd_Cv);
+
+	    // failing to run the command at all is not cached
+	    if (probe_cache && Ret_i >= 0)
+		probe_cache->store(Cmd_Cv, RemoteCommand(Lines_aC[IDX_STDOUT], Lines_aC[IDX_STDERR], Ret_i));
 	}
 
+	span.set_arg("exit-code", Ret_i);
+	span.set_arg("stdout-lines", Lines_aC[IDX_STDOUT].size());
+
+	if (ProbeProfile::get_current())
+	    ProbeProfile::get_current()->record_command(Cmd_Cv, stopwatch.read(), Ret_i);
+
 	if (Mockup::get_mode() == Mockup::Mode::RECORD)
 	{
 	    Mockup::set_command(Cmd_Cv, Mockup::Command(Lines_aC[IDX_STDOUT], Lines_aC[IDX_STDERR], Ret_i));
@@ -138,58 +181,26 @@ SystemCmd::executeRestricted( const string& Command_Cv,
 			      bool& ExceedTime, bool& ExceedLines )
 {
     y2mil("cmd:" << Command_Cv << " MaxTime:" << MaxTimeSec << " MaxLines:" << MaxLineOut);
-    ExceedTime = ExceedLines = false;
-    int ret = executeBackground( Command_Cv );
-    unsigned long ts = 0;
-    unsigned long ls = 0;
-    unsigned long start_time = time(NULL);
-    while( !ExceedTime && !ExceedLines && !doWait( false, ret ) )
-	{
-	if( MaxTimeSec>0 )
-	    {
-	    ts = time(NULL)-start_time;
-	    y2mil( "time used:" << ts );
-	    }
-	if( MaxLineOut>0 )
-	    {
-	    ls = numLines()+numLines(false,IDX_STDERR);
-	    y2mil( "lines out:" << ls );
-	    }
-	ExceedTime = MaxTimeSec>0 && ts>MaxTimeSec;
-	ExceedLines = MaxLineOut>0 && ls>MaxLineOut;
-	sleep( 1 );
-	}
-    if( ExceedTime || ExceedLines )
-	{
-	int r = kill( Pid_i, SIGKILL );
-	y2mil( "kill pid:" << Pid_i << " ret:" << r );
-	unsigned count=0;
-	int Status_ii;
-	int Wait_ii = -1;
-	while( count<5 && Wait_ii<=0 )
-	    {
-	    Wait_ii = waitpid( Pid_i, &Status_ii, WNOHANG );
-	    y2mil( "waitpid:" << Wait_ii );
-	    count++;
-	    sleep( 1 );
-	    }
-	/*
-	r = kill( Pid_i, SIGKILL );
-	y2mil( "kill pid:" << Pid_i << " ret:" << r );
-	count=0;
-	waitDone = false;
-	while( count<8 && !waitDone )
-	    {
-	    y2mil( "doWait:" << count );
-	    waitDone = doWait( false, ret );
-	    count++;
-	    sleep( 1 );
-	    }
-	*/
-	Ret_i = -257;
-	}
-    else
-	Ret_i = ret;
+
+    lastCmd = Command_Cv;
+    invalidate();
+
+    AsyncCmd async_cmd(Command_Cv);
+    async_cmd.set_timeout(MaxTimeSec * 1000);
+    async_cmd.set_max_lines(MaxLineOut);
+    async_cmd.set_output_processor(output_proc);
+
+    const AsyncCmd::Result& result = async_cmd.start().get();
+
+    Lines_aC[IDX_STDOUT] = result.stdout;
+    Lines_aC[IDX_STDERR] = result.stderr;
+
+    ExceedTime = result.timed_out;
+    ExceedLines = result.exceeded_lines;
+
+    int ret = result.exit_code;
+    Ret_i = ExceedTime || ExceedLines ? -257 : ret;
+
     y2mil("ret:" << ret << " ExceedTime:" << ExceedTime << " ExceedLines:" << ExceedLines);
     return ret;
 }
@@ -238,6 +249,7 @@ SystemCmd::doExecute( const string& Cmd )
 	    {
 	    y2err("fcntl O_NONBLOCK failed errno:" << errno << " (" << strerror(errno) << ")");
 	    }
+	pfds[1].fd = -1;
 	if( !Combine_b )
 	    {
 	    pfds[1].fd = serr[0];
@@ -290,6 +302,10 @@ SystemCmd::doExecute( const string& Cmd )
 		    y2err("close parent failed errno:" << errno << " (" << strerror(errno) << ")");
 		    }
 		Ret_i = 0;
+#ifdef SYS_pidfd_open
+		// lets poll notice the end of the child immediately
+		pfds[2].fd = syscall( SYS_pidfd_open, Pid_i, 0 );
+#endif
 		File_aC[IDX_STDOUT] = fdopen( sout[0], "r" );
 		if( File_aC[IDX_STDOUT] == NULL )
 		    {
@@ -343,7 +359,7 @@ SystemCmd::doWait( bool Hang_bv, int& Ret_ir )
 	{
 	y2deb("[0] id:" <<  pfds[0].fd << " ev:" << hex << (unsigned)pfds[0].events << dec << " [1] fs:" <<
 	      (Combine_b?-1:pfds[1].fd) << " ev:" << hex << (Combine_b?0:(unsigned)pfds[1].events));
-	int sel = poll( pfds, Combine_b?1:2, 1000 );
+	int sel = poll( pfds, 3, pfds[2].fd >= 0 ? 1000 : 100 );
 	if (sel < 0)
 	    {
 	    y2err("poll failed errno:" << errno << " (" << strerror(errno) << ")");
@@ -360,6 +376,11 @@ SystemCmd::doWait( bool Hang_bv, int& Ret_ir )
 
     if( Wait_ii != 0 )
 	{
+	if( pfds[2].fd >= 0 )
+	    {
+	    close( pfds[2].fd );
+	    pfds[2].fd = -1;
+	    }
 	checkOutput();
 	fclose( File_aC[IDX_STDOUT] );
 	File_aC[IDX_STDOUT] = NULL;
@@ -108,7 +108,8 @@ class SystemCmd : private boost::noncopyable
 	int Ret_i;
 	int Pid_i;
 	OutputProcessor* output_proc;
-	struct pollfd pfds[2];
+	// stdout, stderr and pidfd of the child
+	struct pollfd pfds[3];
 
 	static bool testmode;
 
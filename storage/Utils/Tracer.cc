@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+
+#include "storage/Utils/Tracer.h"
+#include "storage/Utils/AppUtil.h"
+
+
+namespace storage
+{
+    using namespace std;
+
+
+    std::atomic<bool> Tracer::enabled(false);
+    string Tracer::filename;
+
+    std::mutex Tracer::mutex;
+    vector<Tracer::Event> Tracer::events;
+
+    string Tracer::saved_filename;
+    size_t Tracer::num_saved = 0;
+
+
+    static const char trailer[] = "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+
+    string
+    Tracer::get_filename()
+    {
+	lock_guard<std::mutex> lock(mutex);
+
+	return filename;
+    }
+
+
+    void
+    Tracer::set_filename(const string& filename)
+    {
+	lock_guard<std::mutex> lock(mutex);
+
+	Tracer::filename = filename;
+	enabled = !filename.empty();
+
+	y2mil("trace filename:" << filename);
+    }
+
+
+    void
+    Tracer::clear()
+    {
+	lock_guard<std::mutex> lock(mutex);
+
+	events.clear();
+
+	saved_filename.clear();
+	num_saved = 0;
+    }
+
+
+    void
+    Tracer::save()
+    {
+	lock_guard<std::mutex> lock(mutex);
+
+	if (enabled)
+	    do_save(filename);
+    }
+
+
+    void
+    Tracer::save(const string& filename)
+    {
+	lock_guard<std::mutex> lock(mutex);
+
+	do_save(filename);
+    }
+
+
+    void
+    Tracer::do_save(const string& filename)
+    {
+	// events already in the file are kept by writing the new ones in
+	// place of the trailer
+
+	fstream out;
+	classic(out);
+
+	bool append = filename == saved_filename && num_saved > 0;
+	if (append)
+	{
+	    out.open(filename, ios::in | ios::out);
+	    if (out.is_open())
+		out.seekp(-(streamoff)(sizeof(trailer) - 1), ios::end);
+	    else
+		append = false;
+	}
+
+	if (!append)
+	{
+	    num_saved = 0;
+
+	    out.open(filename, ios::out | ios::trunc);
+	    out << "{\"traceEvents\":[";
+	}
+
+	pid_t pid = getpid();
+
+	for (vector<Event>::const_iterator it = events.begin(); it != events.end(); ++it)
+	{
+	    out << (num_saved == 0 && it == events.begin() ? "\n" : ",\n");
+
+	    out << "{\"name\":" << json_quote(it->name) << ",\"cat\":\"" << it->category
+		<< "\",\"ph\":\"X\",\"ts\":" << it->ts << ",\"dur\":" << it->dur
+		<< ",\"pid\":" << pid << ",\"tid\":" << it->tid;
+
+	    if (!it->args.empty())
+		out << ",\"args\":{" << it->args << "}";
+
+	    out << "}";
+	}
+
+	out << trailer;
+
+	out.close();
+
+	if (!out.good())
+	{
+	    y2err("writing trace " << filename << " failed");
+
+	    saved_filename.clear();
+	    num_saved = 0;
+	    return;
+	}
+
+	y2mil("wrote " << events.size() << " trace events to " << filename);
+
+	saved_filename = filename;
+	num_saved += events.size();
+
+	events.clear();
+	events.shrink_to_fit();
+    }
+
+
+    long long
+    Tracer::now()
+    {
+	return chrono::duration_cast<chrono::microseconds>(
+	    chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+
+    void
+    Tracer::Span::start(const char* category, const string& name)
+    {
+	Span::category = category;
+	Span::name = name;
+	ts = now();
+    }
+
+
+    void
+    Tracer::Span::finish()
+    {
+	long long dur = now() - ts;
+
+	lock_guard<std::mutex> lock(mutex);
+
+	events.push_back({ category, name, ts, dur, (long) syscall(SYS_gettid), args });
+    }
+
+
+    void
+    Tracer::Span::add_arg(const char* key, const string& json)
+    {
+	if (!args.empty())
+	    args += ",";
+
+	args += json_quote(key) + ":" + json;
+    }
+
+}
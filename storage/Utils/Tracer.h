@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2015 Novell, Inc.
+ *
+ * All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of version 2 of the GNU General Public License as published
+ * by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, contact Novell, Inc.
+ *
+ * To contact Novell about this file by physical or electronic mail, you may
+ * find current contact information at www.novell.com.
+ */
+
+
+#ifndef TRACER_H
+#define TRACER_H
+
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <sstream>
+#include <boost/noncopyable.hpp>
+
+#include "storage/Utils/JsonParser.h"
+
+
+namespace storage
+{
+    using std::string;
+    using std::vector;
+
+
+    /**
+     * Records what libstorage spends its time on as Chrome trace-event
+     * JSON, viewable with chrome://tracing or Perfetto. Disabled unless a
+     * filename is set, a disabled Span costs only a flag check.
+     */
+    class Tracer
+    {
+    public:
+
+	static bool is_enabled() { return enabled; }
+
+	static string get_filename();
+
+	/**
+	 * Enables tracing with a non-empty filename, disables it with an
+	 * empty one.
+	 */
+	static void set_filename(const string& filename);
+
+	static void clear();
+
+	/**
+	 * Writes the events recorded since the last save to the file set
+	 * with set_filename(). Does nothing if tracing is disabled.
+	 *
+	 * Saved events are dropped from memory. Saving again to the same
+	 * file appends to the events already in the file.
+	 */
+	static void save();
+
+	static void save(const string& filename);
+
+	/**
+	 * A duration event from construction to destruction. Spans nest
+	 * when created inside each other.
+	 */
+	class Span : private boost::noncopyable
+	{
+	public:
+
+	    Span(const char* category, const string& name)
+		: active(enabled)
+	    {
+		if (active)
+		    start(category, name);
+	    }
+
+	    ~Span()
+	    {
+		if (active)
+		    finish();
+	    }
+
+	    void set_arg(const char* key, const string& value)
+	    {
+		if (active)
+		    add_arg(key, json_quote(value));
+	    }
+
+	    void set_arg(const char* key, const char* value)
+	    {
+		if (active)
+		    add_arg(key, json_quote(value));
+	    }
+
+	    void set_arg(const char* key, bool value)
+	    {
+		if (active)
+		    add_arg(key, value ? "true" : "false");
+	    }
+
+	    template<typename Num>
+	    void set_arg(const char* key, const Num& value)
+	    {
+		static_assert(std::is_arithmetic<Num>::value, "not arithmetic");
+
+		if (active)
+		{
+		    std::ostringstream ostr;
+		    ostr.imbue(std::locale::classic());
+		    ostr << value;
+		    add_arg(key, ostr.str());
+		}
+	    }
+
+	private:
+
+	    void start(const char* category, const string& name);
+	    void finish();
+
+	    void add_arg(const char* key, const string& json);
+
+	    const bool active;
+
+	    const char* category;
+	    string name;
+	    long long ts;
+
+	    // key and value encoded as JSON
+	    string args;
+
+	};
+
+    private:
+
+	struct Event
+	{
+	    const char* category;
+	    string name;
+	    long long ts;
+	    long long dur;
+	    long tid;
+	    string args;
+	};
+
+	static long long now();
+
+	static void do_save(const string& filename);
+
+	static std::atomic<bool> enabled;
+	static string filename;
+
+	// protects all of the following and filename
+	static std::mutex mutex;
+	static vector<Event> events;
+
+	// file of the last save and the number of events in it
+	static string saved_filename;
+	static size_t num_saved;
+
+    };
+
+}
+
+
+#endif
@@ -32,6 +32,7 @@
 #include <boost/noncopyable.hpp>
 
 #include "storage/Utils/AppUtil.h"
+#include "storage/Utils/Interned.h"
 
 
 namespace storage
@@ -105,6 +106,18 @@ namespace storage
     }
 
 
+    template<typename Type>
+    bool getChildValue(const xmlNode* node, const char* name, Interned<Type>& value)
+    {
+	Type tmp;
+	if (!getChildValue(node, name, tmp))
+	    return false;
+
+	value = tmp;
+	return true;
+    }
+
+
     void setChildValue(xmlNode* node, const char* name, const char* value);
     void setChildValue(xmlNode* node, const char* name, const string& value);
     void setChildValue(xmlNode* node, const char* name, bool value);
@@ -134,6 +147,12 @@ namespace storage
 	    setChildValue(node, name, *it);
     }
 
+    template<typename Type>
+    void setChildValue(xmlNode* node, const char* name, const Interned<Type>& value)
+    {
+	setChildValue(node, name, value.get());
+    }
+
     template<typename Type>
     void setChildValueIf(xmlNode* node, const char* name, const Type& value, bool pred)
     {
@@ -0,0 +1,69 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <boost/test/unit_test.hpp>
+#include <boost/algorithm/string.hpp>
+
+#include "storage/SystemInfo/BlockSysfs.h"
+#include "storage/Utils/Mockup.h"
+#include "storage/Utils/SystemCmd.h"
+#include "storage/Utils/StorageDefines.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+void
+check(const vector<string>& input, const vector<string>& output)
+{
+    Mockup::set_mode(Mockup::Mode::PLAYBACK);
+    Mockup::set_command(GREPBIN " --with-filename --no-messages ''"
+			" /sys/block/*/size /sys/block/*/*/partition"
+			" /sys/block/*/*/size /sys/block/*/slaves/*/dev"
+			" /sys/block/*/dm/name /sys/block/*/dm/uuid",
+			RemoteCommand(input, vector<string>(), 2));
+
+    BlockSysfs blocksysfs;
+
+    ostringstream parsed;
+    parsed.setf(std::ios::boolalpha);
+    parsed << blocksysfs;
+
+    string lhs = parsed.str();
+    string rhs = boost::join(output, "\n") + "\n";
+
+    BOOST_CHECK_EQUAL(lhs, rhs);
+}
+
+
+BOOST_AUTO_TEST_CASE(parse1)
+{
+    vector<string> input = {
+	"/sys/block/sda/size:976773168",
+	"/sys/block/dm-0/size:4194304",
+	"/sys/block/cciss!c0d0/size:2097152",
+	"/sys/block/sda/sda1/partition:1",
+	"/sys/block/sda/sda2/partition:2",
+	"/sys/block/cciss!c0d0/cciss!c0d0p1/partition:1",
+	"/sys/block/sda/sda1/size:1048576",
+	"/sys/block/sda/sda2/size:975722496",
+	"/sys/block/sda/power/size:0",
+	"/sys/block/cciss!c0d0/cciss!c0d0p1/size:2095104",
+	"/sys/block/dm-0/slaves/sda2/dev:8:2",
+	"/sys/block/dm-0/dm/name:system-root",
+	"/sys/block/dm-0/dm/uuid:LVM-OMvXB4-0YVm-dUbV-l3Sd-iEB0-1dqP-dpbi3a"
+    };
+
+    vector<string> output = {
+	"data[cciss/c0d0] -> size_k:1048576",
+	"data[cciss/c0d0p1] -> size_k:1047552 disk:cciss/c0d0",
+	"data[dm-0] -> size_k:2097152 dm_name:system-root dm_uuid:LVM-OMvXB4-0YVm-dUbV-l3Sd-iEB0-1dqP-dpbi3a slaves:<sda2>",
+	"data[sda] -> size_k:488386584",
+	"data[sda1] -> size_k:524288 disk:sda",
+	"data[sda2] -> size_k:487861248 disk:sda"
+    };
+
+    check(input, output);
+}
@@ -0,0 +1,161 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <boost/test/unit_test.hpp>
+#include <boost/algorithm/string.hpp>
+
+#include "storage/SystemInfo/DmSysfs.h"
+#include "storage/Utils/Mockup.h"
+#include "storage/Utils/SystemCmd.h"
+#include "storage/Utils/StorageDefines.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+const string command = GREPBIN " --with-filename --no-messages ''"
+    " /sys/block/dm-*/dm/name /sys/block/dm-*/dm/uuid"
+    " /sys/block/dm-*/dev /sys/block/dm-*/slaves/*/dev"
+    " /sys/block/dm-*/slaves/*/device/vendor"
+    " /sys/block/dm-*/slaves/*/device/model";
+
+
+void
+check(const vector<string>& sysfs, const vector<string>& table, const vector<string>& output)
+{
+    Mockup::set_mode(Mockup::Mode::PLAYBACK);
+    Mockup::set_command(command, sysfs);
+    Mockup::set_command(DMSETUPBIN " table", table);
+
+    DmSysfs dmsysfs;
+
+    BOOST_CHECK(dmsysfs.is_supported());
+
+    ostringstream parsed;
+    parsed.setf(std::ios::boolalpha);
+    parsed << dmsysfs;
+
+    string lhs = parsed.str();
+    string rhs = boost::join(output, "\n") + "\n";
+
+    BOOST_CHECK_EQUAL(lhs, rhs);
+}
+
+
+BOOST_AUTO_TEST_CASE(parse1)
+{
+    vector<string> sysfs = {
+	"/sys/block/dm-0/dm/name:cr_home",
+	"/sys/block/dm-1/dm/name:system-root",
+	"/sys/block/dm-0/dm/uuid:CRYPT-LUKS1-a0b1c2d3e4f5a6b7c8d9e0f1a2b3c4d5-cr_home",
+	"/sys/block/dm-1/dm/uuid:LVM-OMvXB4-0YVm-dUbV-l3Sd-iEB0-1dqP-dpbi3a",
+	"/sys/block/dm-0/dev:254:0",
+	"/sys/block/dm-1/dev:254:1",
+	"/sys/block/dm-0/slaves/sda3/dev:8:3",
+	"/sys/block/dm-1/slaves/sda2/dev:8:2",
+	"/sys/block/dm-1/slaves/sdb1/dev:8:17"
+    };
+
+    vector<string> table = {
+	"cr_home: 0 409600 crypt aes-xts-plain64 0000000000000000000000000000000000000000000000000000000000000000 0 8:3 4096",
+	"system-root: 0 2097152 linear 8:2 2048",
+	"system-root: 2097152 1048576 linear 8:17 2048"
+    };
+
+    vector<string> output = {
+	"data[cr_home] -> kernel_name:dm-0 mjr:254 mnr:0 uuid:CRYPT-LUKS1-a0b1c2d3e4f5a6b7c8d9e0f1a2b3c4d5-cr_home targets:<crypt> slaves:</dev/sda3>",
+	"data[system-root] -> kernel_name:dm-1 mjr:254 mnr:1 uuid:LVM-OMvXB4-0YVm-dUbV-l3Sd-iEB0-1dqP-dpbi3a targets:<linear linear> slaves:</dev/sda2 /dev/sdb1>"
+    };
+
+    check(sysfs, table, output);
+}
+
+
+BOOST_AUTO_TEST_CASE(parse2)
+{
+    vector<string> sysfs = {
+	"/sys/block/dm-0/dm/name:36005076305ffc1ae00000000000021df",
+	"/sys/block/dm-0/dm/uuid:mpath-36005076305ffc1ae00000000000021df",
+	"/sys/block/dm-0/dev:254:0",
+	"/sys/block/dm-0/slaves/sdb/dev:8:16",
+	"/sys/block/dm-0/slaves/sda/dev:8:0",
+	"/sys/block/dm-0/slaves/sdb/device/vendor:IBM     ",
+	"/sys/block/dm-0/slaves/sda/device/vendor:IBM     ",
+	"/sys/block/dm-0/slaves/sdb/device/model:2107900         ",
+	"/sys/block/dm-0/slaves/sda/device/model:2107900         "
+    };
+
+    vector<string> table = {
+	"36005076305ffc1ae00000000000021df: 0 41943040 multipath 1 queue_if_no_path 0 1 1 service-time 0 2 1 8:0 1 8:16 1"
+    };
+
+    vector<string> output = {
+	"data[36005076305ffc1ae00000000000021df] -> kernel_name:dm-0 mjr:254 mnr:0 uuid:mpath-36005076305ffc1ae00000000000021df targets:<multipath> slaves:</dev/sda /dev/sdb>"
+    };
+
+    check(sysfs, table, output);
+}
+
+
+BOOST_AUTO_TEST_CASE(no_devices)
+{
+    Mockup::set_mode(Mockup::Mode::PLAYBACK);
+    Mockup::set_command(command, Mockup::Command(vector<string>(), vector<string>(), 2));
+    Mockup::set_command(DMSETUPBIN " table", vector<string>({ "No devices found" }));
+
+    DmSysfs dmsysfs;
+
+    BOOST_CHECK(dmsysfs.is_supported());
+    BOOST_CHECK(dmsysfs.begin() == dmsysfs.end());
+}
+
+
+BOOST_AUTO_TEST_CASE(derived)
+{
+    Mockup::set_mode(Mockup::Mode::PLAYBACK);
+    Mockup::set_command(command, vector<string>({
+	"/sys/block/dm-0/dm/name:cr_home",
+	"/sys/block/dm-0/dm/uuid:CRYPT-LUKS1-a0b1c2d3e4f5a6b7c8d9e0f1a2b3c4d5-cr_home",
+	"/sys/block/dm-0/dev:254:0",
+	"/sys/block/dm-0/slaves/sda3/dev:8:3",
+	"/sys/block/dm-1/dm/name:cr_swap",
+	"/sys/block/dm-1/dev:254:1",
+	"/sys/block/dm-1/slaves/sda2/dev:8:2",
+	"/sys/block/dm-2/dm/name:mpatha",
+	"/sys/block/dm-2/dev:254:2",
+	"/sys/block/dm-2/slaves/sdc/dev:8:32",
+	"/sys/block/dm-2/slaves/sdd/dev:8:48",
+	"/sys/block/dm-2/slaves/sdc/device/vendor:IBM     ",
+	"/sys/block/dm-2/slaves/sdc/device/model:2107900         "
+    }));
+    Mockup::set_command(DMSETUPBIN " table", vector<string>({
+	"cr_home: 0 409600 crypt aes-xts-plain64 :64:logon:cryptsetup:a0b1c2d3 0 8:3 4096",
+	"cr_swap: 0 409600 crypt twofish-cbc-plain 0000000000000000000000000000000000000000000000000000000000000000 0 8:2 0",
+	"mpatha: 0 41943040 multipath 0 0 1 1 service-time 0 2 1 8:32 1 8:48 1"
+    }));
+
+    DmSysfs dmsysfs;
+
+    BOOST_CHECK(dmsysfs.is_supported());
+
+    CmdDmsetupInfo::Entry dmsetup_entry;
+    BOOST_CHECK(dmsysfs.get_cmddmsetupinfo().getEntry("mpatha", dmsetup_entry));
+    BOOST_CHECK_EQUAL(dmsetup_entry.mnr, 2);
+    BOOST_CHECK_EQUAL(dmsetup_entry.segments, 1);
+
+    CmdMultipath::Entry multipath_entry;
+    BOOST_CHECK(dmsysfs.get_cmdmultipath().getEntry("mpatha", multipath_entry));
+    BOOST_CHECK_EQUAL(multipath_entry.vendor, "IBM");
+    BOOST_CHECK_EQUAL(multipath_entry.model, "2107900");
+    BOOST_CHECK_EQUAL(boost::join(multipath_entry.devices, " "), "/dev/sdc /dev/sdd");
+    BOOST_CHECK(!dmsysfs.get_cmdmultipath().getEntry("cr_home", multipath_entry));
+
+    EncryptType encrypt_type;
+    BOOST_CHECK(dmsysfs.get_encrypt_type("cr_home", encrypt_type));
+    BOOST_CHECK_EQUAL(encrypt_type, ENC_LUKS);
+    BOOST_CHECK(dmsysfs.get_encrypt_type("cr_swap", encrypt_type));
+    BOOST_CHECK_EQUAL(encrypt_type, ENC_TWOFISH);
+    BOOST_CHECK(!dmsysfs.get_encrypt_type("mpatha", encrypt_type));
+}
@@ -0,0 +1,151 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <boost/test/unit_test.hpp>
+#include <boost/algorithm/string.hpp>
+
+#include "storage/SystemInfo/CmdLvm.h"
+#include "storage/Utils/Mockup.h"
+#include "storage/Utils/StorageDefines.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+void
+check(const vector<string>& input, const vector<string>& output)
+{
+    Mockup::set_mode(Mockup::Mode::PLAYBACK);
+    Mockup::set_command(LVMBIN " fullreport --reportformat json --units k --nosuffix"
+			" --configreport vg -o vg_name,vg_uuid,vg_attr,vg_fmt,vg_extent_size,"
+			"vg_extent_count,vg_free_count"
+			" --configreport pv -o pv_name,pv_uuid,pv_attr,pv_pe_count,pv_pe_alloc_count"
+			" --configreport lv -o lv_name,lv_uuid,lv_attr,origin,pool_lv"
+			" --configreport seg -o lv_uuid,seg_size_pe,chunk_size", input);
+
+    CmdLvmFullreport cmdlvmfullreport;
+
+    ostringstream parsed;
+    parsed.setf(std::ios::boolalpha);
+    parsed << cmdlvmfullreport;
+
+    string lhs = parsed.str();
+    string rhs = boost::join(output, "\n") + "\n";
+
+    BOOST_CHECK_EQUAL(lhs, rhs);
+}
+
+
+BOOST_AUTO_TEST_CASE(parse1)
+{
+    vector<string> input = {
+	"  {",
+	"      \"report\": [",
+	"          {",
+	"              \"vg\": [",
+	"                  {\"vg_name\":\"system\", \"vg_uuid\":\"0CjwWr-FrTK-wpFX-jagq-hdqS-cLbX-QNLQyH\", \"vg_attr\":\"wz--n-\", \"vg_fmt\":\"lvm2\", \"vg_extent_size\":\"4096.00\", \"vg_extent_count\":\"3994\", \"vg_free_count\":\"1\"}",
+	"              ]",
+	"              ,",
+	"              \"pv\": [",
+	"                  {\"pv_name\":\"/dev/sda2\", \"pv_uuid\":\"lYyKzk-RXyH-2Bvu-VCHG-uTMq-j3AY-J0nGQm\", \"pv_attr\":\"a--\", \"pv_pe_count\":\"3994\", \"pv_pe_alloc_count\":\"3993\"}",
+	"              ]",
+	"              ,",
+	"              \"lv\": [",
+	"                  {\"lv_name\":\"root\", \"lv_uuid\":\"OMvXB4-0YVm-dUbV-l3Sd-iEB0-1dqP-dpbi3a\", \"lv_attr\":\"owi-aos---\", \"origin\":\"\", \"pool_lv\":\"\"},",
+	"                  {\"lv_name\":\"snap\", \"lv_uuid\":\"V7QPAV-tOE0-kwsm-SViW-JZOc-Gx3y-g9m37L\", \"lv_attr\":\"swi-a-s---\", \"origin\":\"root\", \"pool_lv\":\"\"},",
+	"                  {\"lv_name\":\"swap\", \"lv_uuid\":\"YZ1Zax-6sK4-BL6r-1yVq-vk0Q-0kkW-1aWTXK\", \"lv_attr\":\"-wi-ao----\", \"origin\":\"\", \"pool_lv\":\"\"}",
+	"              ]",
+	"              ,",
+	"              \"pvseg\": [",
+	"              ]",
+	"              ,",
+	"              \"seg\": [",
+	"                  {\"lv_uuid\":\"OMvXB4-0YVm-dUbV-l3Sd-iEB0-1dqP-dpbi3a\", \"seg_size_pe\":\"2560\", \"chunk_size\":\"0\"},",
+	"                  {\"lv_uuid\":\"OMvXB4-0YVm-dUbV-l3Sd-iEB0-1dqP-dpbi3a\", \"seg_size_pe\":\"870\", \"chunk_size\":\"0\"},",
+	"                  {\"lv_uuid\":\"V7QPAV-tOE0-kwsm-SViW-JZOc-Gx3y-g9m37L\", \"seg_size_pe\":\"50\", \"chunk_size\":\"4.00\"},",
+	"                  {\"lv_uuid\":\"YZ1Zax-6sK4-BL6r-1yVq-vk0Q-0kkW-1aWTXK\", \"seg_size_pe\":\"513\", \"chunk_size\":\"0\"}",
+	"              ]",
+	"          }",
+	"          ,",
+	"          {",
+	"              \"vg\": [",
+	"                  {\"vg_name\":\"\", \"vg_uuid\":\"\", \"vg_attr\":\"\", \"vg_fmt\":\"\", \"vg_extent_size\":\"0\", \"vg_extent_count\":\"0\", \"vg_free_count\":\"0\"}",
+	"              ]",
+	"              ,",
+	"              \"pv\": [",
+	"                  {\"pv_name\":\"/dev/sdb\", \"pv_uuid\":\"W6H0Wn-kXMM-f1xE-Iq2O-8ahF-1C6c-mWZSqY\", \"pv_attr\":\"---\", \"pv_pe_count\":\"0\", \"pv_pe_alloc_count\":\"0\"}",
+	"              ]",
+	"          }",
+	"      ]",
+	"  }"
+    };
+
+    vector<string> output = {
+	"name:system uuid:0CjwWr-FrTK-wpFX-jagq-hdqS-cLbX-QNLQyH status:resizable pe_size:4096 num_pe:3994 free_pe:1",
+	"lv name:root uuid:OMvXB4-0YVm-dUbV-l3Sd-iEB0-1dqP-dpbi3a status:available num_le:3430",
+	"lv name:snap uuid:V7QPAV-tOE0-kwsm-SViW-JZOc-Gx3y-g9m37L status:available origin:root num_le:3430 num_cow_le:50",
+	"lv name:swap uuid:YZ1Zax-6sK4-BL6r-1yVq-vk0Q-0kkW-1aWTXK status:available num_le:513",
+	"pv device:/dev/sda2 uuid:lYyKzk-RXyH-2Bvu-VCHG-uTMq-j3AY-J0nGQm status:allocatable num_pe:3994 free_pe:1"
+    };
+
+    check(input, output);
+}
+
+
+BOOST_AUTO_TEST_CASE(parse2)
+{
+    vector<string> input = {
+	"  {",
+	"      \"report\": [",
+	"          {",
+	"              \"vg\": [",
+	"                  {\"vg_name\":\"thin\", \"vg_uuid\":\"dBrbdF-4kq5-lM5R-7W2M-Hy3T-dbv4-1ee1v4\", \"vg_attr\":\"wz--n-\", \"vg_fmt\":\"lvm2\", \"vg_extent_size\":\"4096.00\", \"vg_extent_count\":\"1000\", \"vg_free_count\":\"498\"}",
+	"              ]",
+	"              ,",
+	"              \"lv\": [",
+	"                  {\"lv_name\":\"pool\", \"lv_uuid\":\"n4rXMV-cZGw-8zQh-C3qX-9RvJ-DbLL-0BE3Ap\", \"lv_attr\":\"twi-aotz--\", \"origin\":\"\", \"pool_lv\":\"\"},",
+	"                  {\"lv_name\":\"[pool_tdata]\", \"lv_uuid\":\"zqPWt9-0o5b-OSj5-wVgY-u0fw-2u2l-qHIk0b\", \"lv_attr\":\"Twi-ao----\", \"origin\":\"\", \"pool_lv\":\"\"},",
+	"                  {\"lv_name\":\"thin1\", \"lv_uuid\":\"c7PyqI-Vvn6-ZcIS-ZPKl-5tRH-0Q1l-Ayrl2e\", \"lv_attr\":\"Vri-a-tz--\", \"origin\":\"\", \"pool_lv\":\"pool\"}",
+	"              ]",
+	"              ,",
+	"              \"seg\": [",
+	"                  {\"lv_uuid\":\"n4rXMV-cZGw-8zQh-C3qX-9RvJ-DbLL-0BE3Ap\", \"seg_size_pe\":\"500\", \"chunk_size\":\"64.00\"},",
+	"                  {\"lv_uuid\":\"c7PyqI-Vvn6-ZcIS-ZPKl-5tRH-0Q1l-Ayrl2e\", \"seg_size_pe\":\"2500\", \"chunk_size\":\"0\"}",
+	"              ]",
+	"          }",
+	"      ]",
+	"  }"
+    };
+
+    vector<string> output = {
+	"name:thin uuid:dBrbdF-4kq5-lM5R-7W2M-Hy3T-dbv4-1ee1v4 status:resizable pe_size:4096 num_pe:1000 free_pe:498",
+	"lv name:pool uuid:n4rXMV-cZGw-8zQh-C3qX-9RvJ-DbLL-0BE3Ap status:available num_le:500 pool_chunk:64 pool",
+	"lv name:thin1 uuid:c7PyqI-Vvn6-ZcIS-ZPKl-5tRH-0Q1l-Ayrl2e status:available used_pool:pool num_le:2500 read_only"
+    };
+
+    check(input, output);
+}
+
+
+BOOST_AUTO_TEST_CASE(parse_invalid_escape)
+{
+    vector<string> input = {
+	"  {",
+	"      \"report\": [",
+	"          {",
+	"              \"vg\": [",
+	"                  {\"vg_name\":\"sy\\uXYZWstem\", \"vg_uuid\":\"\", \"vg_attr\":\"\", \"vg_fmt\":\"\", \"vg_extent_size\":\"0\", \"vg_extent_count\":\"0\", \"vg_free_count\":\"0\"}",
+	"              ]",
+	"          }",
+	"      ]",
+	"  }"
+    };
+
+    vector<string> output = {
+	"unsupported"
+    };
+
+    check(input, output);
+}
@@ -0,0 +1,183 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <boost/test/unit_test.hpp>
+#include <boost/algorithm/string.hpp>
+
+#include "storage/SystemInfo/ProcMdstat.h"
+#include "storage/SystemInfo/SystemInfo.h"
+#include "storage/Utils/Mockup.h"
+#include "storage/Utils/SystemCmd.h"
+#include "storage/Utils/StorageDefines.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+const string command = GREPBIN " --with-filename --no-messages ''"
+    " /sys/block/md*/md/level /sys/block/md*/md/raid_disks /sys/block/md*/md/chunk_size"
+    " /sys/block/md*/md/layout /sys/block/md*/md/metadata_version /sys/block/md*/md/array_state"
+    " /sys/block/md*/md/uuid /sys/block/md*/md/dev-*/state /sys/block/md*/md/dev-*/slot"
+    " /sys/block/md*/md/dev-*/size /sys/block/md*/size";
+
+
+void
+check(const vector<string>& input, const vector<string>& output)
+{
+    Mockup::set_mode(Mockup::Mode::PLAYBACK);
+    Mockup::set_command(command, input);
+
+    MdSysfs mdsysfs;
+
+    BOOST_CHECK(mdsysfs.is_supported());
+
+    ostringstream parsed;
+    parsed.setf(std::ios::boolalpha);
+    parsed << mdsysfs;
+
+    string lhs = parsed.str();
+    string rhs = boost::join(output, "\n") + "\n";
+
+    BOOST_CHECK_EQUAL(lhs, rhs);
+}
+
+
+BOOST_AUTO_TEST_CASE(parse1)
+{
+    vector<string> input = {
+	"/sys/block/md0/md/level:raid1",
+	"/sys/block/md0/md/raid_disks:2",
+	"/sys/block/md0/md/chunk_size:0",
+	"/sys/block/md0/md/layout:0",
+	"/sys/block/md0/md/metadata_version:1.0",
+	"/sys/block/md0/md/array_state:clean",
+	"/sys/block/md0/md/uuid:35dd06d4-b4e9-e248-9262-c3ad02b61654",
+	"/sys/block/md0/md/dev-sda1/state:in_sync",
+	"/sys/block/md0/md/dev-sdb1/state:in_sync",
+	"/sys/block/md0/md/dev-sda1/slot:0",
+	"/sys/block/md0/md/dev-sdb1/slot:1",
+	"/sys/block/md0/md/dev-sda1/size:8387520",
+	"/sys/block/md0/md/dev-sdb1/size:8387520",
+	"/sys/block/md0/size:16775040"
+    };
+
+    // same as for the /proc/mdstat of the parse1 test of ProcMdstat
+    vector<string> output = {
+	"data[md0] -> md_type:raid1 super:1.0 size_k:8387520 devices:</dev/sda1 /dev/sdb1>",
+	"detail[md0] -> uuid:35dd06d4:b4e9e248:9262c3ad:02b61654 metadata:1.0"
+    };
+
+    check(input, output);
+}
+
+
+BOOST_AUTO_TEST_CASE(parse2)
+{
+    vector<string> input = {
+	"/sys/block/md125/md/level:raid1",
+	"/sys/block/md126/md/level:raid0",
+	"/sys/block/md125/md/chunk_size:0",
+	"/sys/block/md126/md/chunk_size:131072",
+	"/sys/block/md127/md/chunk_size:0",
+	"/sys/block/md125/md/metadata_version:external:/md127/0",
+	"/sys/block/md126/md/metadata_version:external:/md127/1",
+	"/sys/block/md127/md/metadata_version:external:imsm",
+	"/sys/block/md125/md/array_state:read-auto",
+	"/sys/block/md126/md/array_state:clean",
+	"/sys/block/md127/md/array_state:inactive",
+	"/sys/block/md125/md/uuid:fb5ec8ef-9e4b-4c37-a1e2-2d7cf1bf4c4b",
+	"/sys/block/md125/md/dev-sda/slot:1",
+	"/sys/block/md125/md/dev-sdb/slot:0",
+	"/sys/block/md126/md/dev-sda/slot:1",
+	"/sys/block/md126/md/dev-sdb/slot:0",
+	"/sys/block/md127/md/dev-sda/slot:none",
+	"/sys/block/md127/md/dev-sdb/slot:none",
+	"/sys/block/md127/md/dev-sda/size:2552",
+	"/sys/block/md127/md/dev-sdb/size:2552",
+	"/sys/block/md125/size:8388608",
+	"/sys/block/md126/size:16757580",
+	"/sys/block/md127/size:0"
+    };
+
+    // same as for the /proc/mdstat of the parse2 test of ProcMdstat, the
+    // containers and their members have no details
+    vector<string> output = {
+	"data[md125] -> md_type:raid1 super:external:/md127/0 size_k:4194304 readonly devices:</dev/sdb /dev/sda> has_container container_name:md127 container_member:0",
+	"data[md126] -> md_type:raid0 super:external:/md127/1 chunk_k:128 size_k:8378790 devices:</dev/sdb /dev/sda> has_container container_name:md127 container_member:1",
+	"data[md127] -> md_type:unknown super:external:imsm size_k:5104 readonly inactive devices:<> spares:</dev/sda /dev/sdb> is_container"
+    };
+
+    check(input, output);
+}
+
+
+BOOST_AUTO_TEST_CASE(parse3)
+{
+    vector<string> input = {
+	"/sys/block/md1/md/level:raid10",
+	"/sys/block/md1/md/chunk_size:524288",
+	"/sys/block/md1/md/layout:258",
+	"/sys/block/md1/md/metadata_version:0.90",
+	"/sys/block/md1/md/array_state:active",
+	"/sys/block/md1/md/dev-sdc/state:in_sync",
+	"/sys/block/md1/md/dev-sdd/state:in_sync",
+	"/sys/block/md1/md/dev-sde/state:spare",
+	"/sys/block/md1/md/dev-sdc/slot:0",
+	"/sys/block/md1/md/dev-sdd/slot:1",
+	"/sys/block/md1/md/dev-sde/slot:none",
+	"/sys/block/md1/size:2097152",
+	"/sys/block/md2/md/level:raid5",
+	"/sys/block/md2/md/chunk_size:65536",
+	"/sys/block/md2/md/layout:2",
+	"/sys/block/md2/md/metadata_version:1.2",
+	"/sys/block/md2/md/array_state:clean",
+	"/sys/block/md2/size:4194304"
+    };
+
+    vector<string> output = {
+	"data[md1] -> md_type:raid10 md_parity:n2 chunk_k:512 size_k:1048576 devices:</dev/sdc /dev/sdd> spares:</dev/sde>",
+	"data[md2] -> md_type:raid5 md_parity:left-symmetric super:1.2 chunk_k:64 size_k:2097152 devices:<>"
+    };
+
+    check(input, output);
+}
+
+
+BOOST_AUTO_TEST_CASE(no_arrays)
+{
+    Mockup::set_mode(Mockup::Mode::PLAYBACK);
+    Mockup::set_command(command, RemoteCommand({}, {}, 2));
+
+    MdSysfs mdsysfs;
+
+    BOOST_CHECK(mdsysfs.is_supported());
+    BOOST_CHECK(mdsysfs.get_procmdstat().getEntries().empty());
+}
+
+
+BOOST_AUTO_TEST_CASE(systeminfo)
+{
+    Mockup::set_mode(Mockup::Mode::PLAYBACK);
+    Mockup::set_command(command, vector<string>({
+	"/sys/block/md0/md/level:raid1",
+	"/sys/block/md0/md/metadata_version:1.0",
+	"/sys/block/md0/md/array_state:clean",
+	"/sys/block/md0/md/uuid:35dd06d4-b4e9-e248-9262-c3ad02b61654",
+	"/sys/block/md0/size:16775040"
+    }));
+    Mockup::set_command(LSBIN " -1l --sort=none '/dev/md'", vector<string>({
+	"lrwxrwxrwx 1 root root 6 Oct 19 10:00 test -> ../md0"
+    }));
+
+    SystemInfo systeminfo;
+
+    BOOST_CHECK_EQUAL(systeminfo.getProcMdstat().getEntries().size(), 1);
+
+    // no mockup for mdadm so it must not be run
+    const MdadmDetail& detail = systeminfo.getMdadmDetail("/dev/md0");
+    BOOST_CHECK_EQUAL(detail.uuid, "35dd06d4:b4e9e248:9262c3ad:02b61654");
+    BOOST_CHECK_EQUAL(detail.devname, "test");
+    BOOST_CHECK_EQUAL(detail.metadata, "1.0");
+}
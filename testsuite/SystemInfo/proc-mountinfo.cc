@@ -0,0 +1,80 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <boost/test/unit_test.hpp>
+#include <boost/algorithm/string.hpp>
+
+#include "storage/SystemInfo/ProcMountinfo.h"
+#include "storage/Utils/Mockup.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+vector<string> input = {
+    "17 58 0:16 / /sys rw,nosuid,nodev,noexec,relatime shared:6 - sysfs sysfs rw",
+    "58 0 254:0 / / rw,relatime shared:1 - ext4 /dev/mapper/system-root rw,data=ordered",
+    "60 58 8:1 / /boot rw,relatime shared:30 - ext2 /dev/sda1 rw",
+    "61 58 8:2 /@/home /home rw,relatime shared:31 - btrfs /dev/sda2 rw,space_cache",
+    "62 58 8:2 /@/srv /srv\\040data rw,relatime shared:32 - btrfs /dev/sda2 rw,space_cache",
+    "63 60 8:3 / /boot rw,relatime shared:33 - vfat /dev/sda3 rw"
+};
+
+
+// must run before the mockup file is set
+BOOST_AUTO_TEST_CASE(no_mockup)
+{
+    Mockup::set_mode(Mockup::Mode::PLAYBACK);
+
+    ProcMountinfo procmountinfo;
+
+    BOOST_CHECK(!procmountinfo.is_mounted("/dev/sda1", "/boot"));
+}
+
+
+BOOST_AUTO_TEST_CASE(parse1)
+{
+    Mockup::set_mode(Mockup::Mode::PLAYBACK);
+    Mockup::set_file("/proc/self/mountinfo", input);
+
+    ProcMountinfo procmountinfo;
+
+    vector<string> output = {
+	"mount-id:17 parent-id:58 major:0 minor:16 root:/ mountpoint:/sys fs-type:sysfs device:sysfs",
+	"mount-id:58 parent-id:0 major:254 minor:0 root:/ mountpoint:/ fs-type:ext4 device:/dev/mapper/system-root",
+	"mount-id:60 parent-id:58 major:8 minor:1 root:/ mountpoint:/boot fs-type:ext2 device:/dev/sda1",
+	"mount-id:61 parent-id:58 major:8 minor:2 root:/@/home mountpoint:/home fs-type:btrfs device:/dev/sda2",
+	"mount-id:62 parent-id:58 major:8 minor:2 root:/@/srv mountpoint:/srv data fs-type:btrfs device:/dev/sda2",
+	"mount-id:63 parent-id:60 major:8 minor:3 root:/ mountpoint:/boot fs-type:vfat device:/dev/sda3"
+    };
+
+    ostringstream parsed;
+    parsed << procmountinfo;
+
+    BOOST_CHECK_EQUAL(parsed.str(), boost::join(output, "\n") + "\n");
+
+    // nothing changes in playback
+    BOOST_CHECK(!procmountinfo.refresh());
+}
+
+
+BOOST_AUTO_TEST_CASE(index1)
+{
+    Mockup::set_mode(Mockup::Mode::PLAYBACK);
+    Mockup::set_file("/proc/self/mountinfo", input);
+
+    ProcMountinfo procmountinfo;
+
+    BOOST_CHECK_EQUAL(boost::join(procmountinfo.get_mountpoints("/dev/sda2"), " "), "/home /srv data");
+    BOOST_CHECK(procmountinfo.get_mountpoints("/dev/sdb1").empty());
+
+    // /dev/sda3 is mounted on top of /dev/sda1
+    BOOST_CHECK_EQUAL(procmountinfo.get_device("/boot"), "/dev/sda3");
+    BOOST_CHECK_EQUAL(procmountinfo.get_device("/"), "/dev/mapper/system-root");
+    BOOST_CHECK_EQUAL(procmountinfo.get_device("/mnt"), "");
+
+    BOOST_CHECK(procmountinfo.is_mounted("/dev/sda1", "/boot"));
+    BOOST_CHECK(!procmountinfo.is_mounted("/dev/sda1", "/home"));
+}
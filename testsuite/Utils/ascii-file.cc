@@ -0,0 +1,160 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <sys/stat.h>
+#include <boost/test/unit_test.hpp>
+
+#include "storage/Utils/AsciiFile.h"
+#include "storage/Utils/AppUtil.h"
+#include "storage/Utils/Mockup.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+BOOST_AUTO_TEST_CASE(save)
+{
+    const string name = "ascii-file.tmp";
+
+    unlink(name.c_str());
+
+    AsciiFile file1(name);
+    file1.append("hello");
+    file1.append("world");
+    BOOST_CHECK(file1.save());
+
+    chmod(name.c_str(), 0640);
+
+    AsciiFile file2(name);
+    BOOST_CHECK_EQUAL(file2.numLines(), 2);
+    BOOST_CHECK_EQUAL(file2[1], "world");
+
+    file2.remove(0, 1);
+    BOOST_CHECK(file2.save());
+
+    // the file is replaced atomically but keeps its permissions
+    struct stat st;
+    BOOST_CHECK_EQUAL(stat(name.c_str(), &st), 0);
+    BOOST_CHECK_EQUAL(st.st_mode & 07777, 0640);
+
+    AsciiFile file3(name);
+    BOOST_CHECK_EQUAL(file3.numLines(), 1);
+    BOOST_CHECK_EQUAL(file3[0], "world");
+
+    unlink(name.c_str());
+}
+
+
+BOOST_AUTO_TEST_CASE(save_symlink)
+{
+    const string name = "ascii-file.tmp";
+    const string link = "ascii-file.link";
+
+    unlink(name.c_str());
+    unlink(link.c_str());
+
+    AsciiFile file1(name);
+    file1.append("hello");
+    BOOST_CHECK(file1.save());
+
+    BOOST_CHECK_EQUAL(symlink(name.c_str(), link.c_str()), 0);
+
+    AsciiFile file2(link);
+    file2.append("world");
+    BOOST_CHECK(file2.save());
+
+    // the link is kept and the target is updated
+    struct stat st;
+    BOOST_CHECK_EQUAL(lstat(link.c_str(), &st), 0);
+    BOOST_CHECK(S_ISLNK(st.st_mode));
+
+    AsciiFile file3(name);
+    BOOST_CHECK_EQUAL(file3.numLines(), 2);
+    BOOST_CHECK_EQUAL(file3[1], "world");
+
+    unlink(link.c_str());
+    unlink(name.c_str());
+}
+
+
+BOOST_AUTO_TEST_CASE(views)
+{
+    const string name = "ascii-file.tmp";
+
+    {
+	AsciiFile file(name);
+	file.append("first");
+	file.append("");
+	file.append("third");
+	BOOST_CHECK(file.save());
+    }
+
+    AsciiFile file(name);
+
+    vector<string_ref> views = file.views();
+    BOOST_CHECK_EQUAL(views.size(), 3);
+    BOOST_CHECK_EQUAL(views[0], "first");
+    BOOST_CHECK_EQUAL(views[1], "");
+    BOOST_CHECK_EQUAL(views[2], "third");
+
+    // lines are copied on modification
+    file[1] = "second";
+    BOOST_CHECK_EQUAL(file.views()[1], "second");
+    BOOST_CHECK_EQUAL(file.numLines(), 3);
+
+    unlink(name.c_str());
+}
+
+
+BOOST_AUTO_TEST_CASE(playback)
+{
+    Mockup::set_mode(Mockup::Mode::PLAYBACK);
+    Mockup::set_file("/etc/test", vector<string>({ "hello", "world" }));
+
+    AsciiFile file("/etc/test");
+
+    // the views stay valid when the mockup file is replaced
+    vector<string_ref> views = file.views();
+    Mockup::set_file("/etc/test", vector<string>({ "replaced" }));
+    BOOST_CHECK_EQUAL(views[1], "world");
+
+    file.append("again");
+    BOOST_CHECK(file.save());
+    BOOST_CHECK_EQUAL(Mockup::get_file("/etc/test").content.size(), 3);
+    BOOST_CHECK_EQUAL(views[0], "hello");
+
+    Mockup::set_mode(Mockup::Mode::NONE);
+}
+
+
+BOOST_AUTO_TEST_CASE(no_trailing_newline)
+{
+    const string name = "ascii-file.tmp";
+
+    FILE* fp = fopen(name.c_str(), "w");
+    fputs("first\nlast", fp);
+    fclose(fp);
+
+    // the last line is read even without a newline and written with one
+
+    AsciiFile file(name);
+    BOOST_CHECK_EQUAL(file.numLines(), 2);
+    BOOST_CHECK_EQUAL(file[1], "last");
+    BOOST_CHECK(file.save());
+
+    AsciiFile file2(name);
+    BOOST_CHECK_EQUAL(file2.numLines(), 2);
+
+    unlink(name.c_str());
+}
+
+
+BOOST_AUTO_TEST_CASE(read_error)
+{
+    // reading a directory fails after opening it
+    AsciiFile file(".");
+    BOOST_CHECK(!file.reload());
+    BOOST_CHECK_EQUAL(file.numLines(), 0);
+}
@@ -0,0 +1,148 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <boost/test/unit_test.hpp>
+
+#include "storage/Utils/AsyncCmd.h"
+#include "storage/Utils/SystemCmd.h"
+#include "storage/Utils/OutputProcessor.h"
+#include "storage/Utils/AppUtil.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+BOOST_AUTO_TEST_CASE(output)
+{
+    AsyncCmd cmd("echo hello; printf 'err\\npartial' >&2; exit 3");
+
+    const AsyncCmd::Result& result = cmd.start().get();
+
+    BOOST_REQUIRE_EQUAL(result.stdout.size(), 1);
+    BOOST_CHECK_EQUAL(result.stdout[0], "hello");
+
+    BOOST_REQUIRE_EQUAL(result.stderr.size(), 2);
+    BOOST_CHECK_EQUAL(result.stderr[0], "err");
+    BOOST_CHECK_EQUAL(result.stderr[1], "partial");
+
+    BOOST_CHECK_EQUAL(result.exit_code, 3);
+    BOOST_CHECK(!result.timed_out && !result.cancelled && !result.exceeded_lines);
+}
+
+
+BOOST_AUTO_TEST_CASE(concurrent)
+{
+    StopWatch stopwatch;
+
+    vector<unique_ptr<AsyncCmd>> cmds;
+    vector<shared_future<AsyncCmd::Result>> futures;
+
+    for (int i = 0; i < 8; ++i)
+    {
+	cmds.emplace_back(new AsyncCmd("sleep 0.3; echo " + to_string(i)));
+	futures.push_back(cmds.back()->start());
+    }
+
+    for (int i = 0; i < 8; ++i)
+    {
+	BOOST_REQUIRE_EQUAL(futures[i].get().stdout.size(), 1);
+	BOOST_CHECK_EQUAL(futures[i].get().stdout[0], to_string(i));
+    }
+
+    // the commands ran in parallel
+    BOOST_CHECK(stopwatch.read() < 2.0);
+}
+
+
+BOOST_AUTO_TEST_CASE(timeout)
+{
+    StopWatch stopwatch;
+
+    AsyncCmd cmd("sleep 10");
+    cmd.set_timeout(100);
+
+    const AsyncCmd::Result& result = cmd.start().get();
+
+    BOOST_CHECK(result.timed_out);
+    BOOST_CHECK_EQUAL(result.exit_code, -127);
+    BOOST_CHECK(stopwatch.read() < 5.0);
+}
+
+
+BOOST_AUTO_TEST_CASE(cancel)
+{
+    AsyncCmd cmd("sleep 10");
+
+    shared_future<AsyncCmd::Result> future = cmd.start();
+
+    BOOST_CHECK(future.wait_for(chrono::milliseconds(50)) == future_status::timeout);
+
+    cmd.cancel();
+
+    BOOST_CHECK(future.get().cancelled);
+    BOOST_CHECK(!future.get().timed_out);
+}
+
+
+BOOST_AUTO_TEST_CASE(max_lines)
+{
+    AsyncCmd cmd("while true; do echo line; done");
+    cmd.set_max_lines(100);
+
+    const AsyncCmd::Result& result = cmd.start().get();
+
+    BOOST_CHECK(result.exceeded_lines);
+    BOOST_CHECK(result.stdout.size() > 100);
+}
+
+
+class CountingProcessor : public OutputProcessor
+{
+public:
+
+    virtual void reset() override { resets++; }
+    virtual void finish() override { finishes++; }
+    virtual void process(const string& txt, bool stderr) override { text += txt; }
+
+    int resets = 0;
+    int finishes = 0;
+    string text;
+
+};
+
+
+BOOST_AUTO_TEST_CASE(output_processor)
+{
+    CountingProcessor processor;
+
+    AsyncCmd cmd("echo 1; sleep 0.1; echo 2");
+    cmd.set_output_processor(&processor);
+
+    cmd.start().get();
+
+    BOOST_CHECK_EQUAL(processor.resets, 1);
+    BOOST_CHECK_EQUAL(processor.finishes, 1);
+    BOOST_CHECK_EQUAL(processor.text, "1\n2\n");
+}
+
+
+BOOST_AUTO_TEST_CASE(restricted)
+{
+    StopWatch stopwatch;
+
+    SystemCmd cmd;
+
+    bool exceed_time, exceed_lines;
+    cmd.executeRestricted("echo start; sleep 10", 1, 0, exceed_time, exceed_lines);
+
+    BOOST_CHECK(exceed_time);
+    BOOST_CHECK(!exceed_lines);
+    BOOST_CHECK_EQUAL(cmd.retcode(), -257);
+    BOOST_REQUIRE_EQUAL(cmd.stdout().size(), 1);
+    BOOST_CHECK_EQUAL(cmd.stdout()[0], "start");
+
+    // no longer rounded up to full seconds of polling
+    BOOST_CHECK(stopwatch.read() < 3.0);
+}
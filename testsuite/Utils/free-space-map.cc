@@ -0,0 +1,72 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <boost/test/unit_test.hpp>
+
+#include "storage/Utils/FreeSpaceMap.h"
+#include "storage/Utils/StorageTmpl.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+string
+free_regions(const FreeSpaceMap& free_space_map)
+{
+    ostringstream tmp;
+    tmp << free_space_map.get_free_regions();
+    return tmp.str();
+}
+
+
+BOOST_AUTO_TEST_CASE(add_and_remove)
+{
+    FreeSpaceMap free_space_map;
+    free_space_map.reset(Region(0, 100));
+
+    BOOST_CHECK_EQUAL(free_regions(free_space_map), "<[0,100]>");
+
+    free_space_map.add_used(Region(10, 10));
+    free_space_map.add_used(Region(50, 20));
+    free_space_map.add_used(Region(90, 20));
+
+    BOOST_CHECK_EQUAL(free_regions(free_space_map), "<[0,10] [20,30] [70,20]>");
+
+    Region region;
+
+    BOOST_CHECK(free_space_map.get_largest_free_region(region));
+    BOOST_CHECK_EQUAL(region, Region(20, 30));
+
+    BOOST_CHECK(free_space_map.get_best_fit_region(15, region));
+    BOOST_CHECK_EQUAL(region, Region(70, 20));
+
+    BOOST_CHECK(!free_space_map.get_best_fit_region(31, region));
+
+    free_space_map.remove_used(Region(50, 20));
+
+    BOOST_CHECK_EQUAL(free_regions(free_space_map), "<[0,10] [20,70]>");
+
+    free_space_map.remove_used(Region(10, 10));
+
+    BOOST_CHECK_EQUAL(free_regions(free_space_map), "<[0,90]>");
+
+    BOOST_CHECK_THROW(free_space_map.remove_used(Region(10, 10)), logic_error);
+}
+
+
+BOOST_AUTO_TEST_CASE(overlapping)
+{
+    FreeSpaceMap free_space_map;
+    free_space_map.reset(Region(0, 100));
+
+    free_space_map.add_used(Region(10, 30));
+    free_space_map.add_used(Region(30, 30));
+
+    BOOST_CHECK_EQUAL(free_regions(free_space_map), "<[0,10] [60,40]>");
+
+    free_space_map.remove_used(Region(10, 30));
+
+    BOOST_CHECK_EQUAL(free_regions(free_space_map), "<[0,30] [60,40]>");
+}
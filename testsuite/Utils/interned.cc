@@ -0,0 +1,96 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <thread>
+#include <boost/test/unit_test.hpp>
+
+#include "storage/Utils/Interned.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+BOOST_AUTO_TEST_CASE(shared)
+{
+    string tmp = "/dev/sda";
+
+    Interned<string> a(tmp);
+    Interned<string> b(string("/dev/") + "sda");
+    Interned<string> c("/dev/sdb");
+
+    BOOST_CHECK_EQUAL(&a.get(), &b.get());
+    BOOST_CHECK(a == b);
+    BOOST_CHECK(a != c);
+    BOOST_CHECK(a < c);
+
+    BOOST_CHECK_EQUAL(a.get(), "/dev/sda");
+    BOOST_CHECK_EQUAL(c.get(), "/dev/sdb");
+}
+
+
+BOOST_AUTO_TEST_CASE(empty)
+{
+    Interned<vector<string>> a;
+    Interned<vector<string>> b(vector<string>({}));
+    Interned<vector<string>> c({ "/", "/home" });
+
+    BOOST_CHECK(a.empty());
+    BOOST_CHECK(a == b);
+    BOOST_CHECK(!c.empty());
+
+    c = vector<string>({ "/", "/home" });
+    BOOST_CHECK_EQUAL(c.get().size(), 2);
+
+    ostringstream out;
+    out << Interned<string>("/home");
+    BOOST_CHECK_EQUAL(out.str(), "/home");
+}
+
+
+BOOST_AUTO_TEST_CASE(released)
+{
+    Interned<string> empty;
+
+    size_t size = Interned<string>::table_size();
+
+    {
+	Interned<string> a("/dev/disk/by-id/released");
+	Interned<string> b(a);
+
+	BOOST_CHECK_EQUAL(Interned<string>::table_size(), size + 1);
+
+	a = empty;
+	BOOST_CHECK_EQUAL(Interned<string>::table_size(), size + 1);
+    }
+
+    BOOST_CHECK_EQUAL(Interned<string>::table_size(), size);
+
+    Interned<string> c("/dev/disk/by-id/released");
+    BOOST_CHECK_EQUAL(c.get(), "/dev/disk/by-id/released");
+    BOOST_CHECK_EQUAL(Interned<string>::table_size(), size + 1);
+}
+
+
+BOOST_AUTO_TEST_CASE(threads)
+{
+    vector<Interned<list<string>>> values(8);
+
+    vector<thread> threads;
+    for (size_t i = 0; i < values.size(); ++i)
+	threads.emplace_back([&values, i]() {
+	    for (int j = 0; j < 1000; ++j)
+		Interned<list<string>>({ "defaults", to_string(j) });
+	    values[i] = Interned<list<string>>({ "defaults" });
+	});
+
+    for (thread& thread : threads)
+	thread.join();
+
+    for (const Interned<list<string>>& value : values)
+	BOOST_CHECK(value == values.front());
+
+    // only the empty value and { "defaults" } are still referenced
+    BOOST_CHECK_EQUAL(Interned<list<string>>::table_size(), 2);
+}
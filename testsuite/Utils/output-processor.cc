@@ -0,0 +1,104 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <chrono>
+#include <boost/test/unit_test.hpp>
+
+#include "storage/Utils/OutputProcessor.h"
+#include "storage/Utils/SystemCmd.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+BOOST_AUTO_TEST_CASE(mke2fs)
+{
+    vector<double> fractions;
+
+    FractionProgress::Record record([&fractions](const string& message, double fraction) {
+	BOOST_CHECK_EQUAL(message, "mkfs");
+	fractions.push_back(fraction);
+    });
+
+    Mke2fsProgress progress("mkfs");
+    progress.reset();
+
+    progress.process("Discarding device blocks: 4096/262144\b\b\b\b\b\b\b\b\b\b\b\b\b", false);
+    progress.process("             \b\b\b\b\b\b\b\b\b\b\b\b\bdone                            \n", false);
+    progress.process("Allocating group tables: 0/8\b\b\b", false);
+    progress.process("   \b\b\bdone                            \n", false);
+    progress.process("Writing inode tables: 2/8\b\b\b4/", false);
+    progress.process("8\b\b\b   \b\b\bdone                            \n", false);
+    progress.process("Creating journal (8192 blocks): done\n", false);
+    progress.process("Writing superblocks and filesystem accounting information: 0/8\b\b\b", false);
+    progress.process("some error\b\n", true);
+    progress.process("   \b\b\bdone\n\n", false);
+
+    progress.finish();
+
+    vector<double> expected = { 0.0, 0.1, 0.225, 0.35, 0.6, 0.8, 1.0 };
+
+    BOOST_REQUIRE_EQUAL(fractions.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+	BOOST_CHECK_CLOSE(fractions[i], expected[i], 0.001);
+}
+
+
+BOOST_AUTO_TEST_CASE(monotonic)
+{
+    vector<double> fractions;
+
+    FractionProgress::Record record([&fractions](const string& message, double fraction) {
+	fractions.push_back(fraction);
+    });
+
+    FractionProgress progress("test");
+    progress.reset();
+    progress.set_fraction(0.5);
+    progress.set_fraction(0.25);
+    progress.set_fraction(0.5);
+    progress.set_fraction(2.0);
+    progress.finish();
+
+    BOOST_CHECK(fractions == vector<double>({ 0.0, 0.5, 1.0 }));
+}
+
+
+BOOST_AUTO_TEST_CASE(no_record)
+{
+    FractionProgress progress("test");
+    progress.reset();
+    progress.finish();
+
+    BOOST_CHECK_EQUAL(progress.get_fraction(), 1.0);
+}
+
+
+BOOST_AUTO_TEST_CASE(streaming)
+{
+    typedef chrono::steady_clock clock;
+
+    clock::time_point reported;
+
+    FractionProgress::Record record([&reported](const string& message, double fraction) {
+	if (fraction > 0.0 && fraction < 1.0 && reported == clock::time_point())
+	    reported = clock::now();
+    });
+
+    Mke2fsProgress progress("mkfs");
+
+    SystemCmd cmd;
+    cmd.setOutputProcessor(&progress);
+    cmd.execute("printf 'Allocating group tables: done\\n'; sleep 1");
+
+    clock::time_point finished = clock::now();
+
+    BOOST_CHECK_EQUAL(cmd.retcode(), 0);
+    BOOST_CHECK_EQUAL(progress.get_fraction(), 1.0);
+
+    // the progress must be reported while the command is still running
+    BOOST_REQUIRE(reported != clock::time_point());
+    BOOST_CHECK(finished - reported > chrono::milliseconds(500));
+}
@@ -0,0 +1,232 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <thread>
+#include <boost/test/unit_test.hpp>
+
+#include "storage/Utils/ProbeCache.h"
+#include "storage/Utils/SystemCmd.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+class TestProbeCache : public ProbeCache
+{
+public:
+
+    TestProbeCache(const string& filename) : ProbeCache(filename) {}
+
+    string global = "seqnum:1";
+    map<string, string> devices;
+
+protected:
+
+    virtual string read_global_signature() const override { return global; }
+
+    virtual string read_device_signature(const string& name) const override
+    {
+	map<string, string>::const_iterator it = devices.find(name);
+	return it != devices.end() ? it->second : "";
+    }
+
+};
+
+
+const string filename = "probe-cache.d/cache.xml";
+
+const string parted_sda = "/usr/sbin/parted -s '/dev/sda' unit s print";
+const string parted_sdb = "/usr/sbin/parted -s '/dev/sdb' unit s print";
+const string blkid = "/sbin/blkid -c '/dev/null'";
+
+
+static void
+cleanup()
+{
+    unlink(filename.c_str());
+    rmdir("probe-cache.d");
+}
+
+
+BOOST_AUTO_TEST_CASE(signatures)
+{
+    cleanup();
+
+    {
+	TestProbeCache cache(filename);
+	cache.devices = { { "sda", "dev:8:0 udev:1" }, { "sdb", "dev:8:16 udev:1" } };
+
+	RemoteCommand command;
+	BOOST_CHECK(!cache.lookup(parted_sda, command));
+
+	cache.store(parted_sda, RemoteCommand({ "sda", "", "line 3" }));
+	cache.store(parted_sdb, RemoteCommand({ "sdb" }, { "warning" }, 1));
+	cache.store(blkid, RemoteCommand({ "blkid" }));
+
+	cache.save();
+    }
+
+    {
+	TestProbeCache cache(filename);
+	cache.devices = { { "sda", "dev:8:0 udev:2" }, { "sdb", "dev:8:16 udev:1" } };
+
+	RemoteCommand command;
+
+	// sda had a udev event since, sdb did not
+
+	BOOST_CHECK(!cache.lookup(parted_sda, command));
+
+	BOOST_REQUIRE(cache.lookup(parted_sdb, command));
+	BOOST_CHECK_EQUAL(command.stdout.size(), 1);
+	BOOST_CHECK_EQUAL(command.stderr.size(), 1);
+	BOOST_CHECK_EQUAL(command.exit_code, 1);
+
+	BOOST_CHECK(cache.lookup(blkid, command));
+
+	cache.global = "seqnum:2";
+
+	// the global signature is only read once per probe
+
+	BOOST_CHECK(cache.lookup(blkid, command));
+
+	BOOST_CHECK_EQUAL(cache.get_hits(), 3);
+	BOOST_CHECK_EQUAL(cache.get_misses(), 1);
+
+	cache.save();
+    }
+
+    {
+	TestProbeCache cache(filename);
+	cache.devices = { { "sda", "dev:8:0 udev:2" }, { "sdb", "dev:8:16 udev:1" } };
+	cache.global = "seqnum:2";
+
+	RemoteCommand command;
+
+	// entries not used by the last probe are dropped
+
+	BOOST_CHECK(!cache.lookup(parted_sda, command));
+
+	BOOST_CHECK(cache.lookup(parted_sdb, command));
+
+	BOOST_CHECK(!cache.lookup(blkid, command));
+    }
+
+    cleanup();
+}
+
+
+BOOST_AUTO_TEST_CASE(several_devices)
+{
+    cleanup();
+
+    const string examine = "/sbin/mdadm --examine '/dev/sda1' '/dev/sdb1' --brief";
+
+    TestProbeCache cache(filename);
+    cache.devices = { { "sda1", "dev:8:1 udev:1" }, { "sdb1", "dev:8:17 udev:1" } };
+
+    cache.store(examine, RemoteCommand({ "ARRAY" }));
+    cache.save();
+
+    RemoteCommand command;
+
+    // a change of any device invalidates the entry
+
+    TestProbeCache cache2(filename);
+    cache2.devices = { { "sda1", "dev:8:1 udev:1" }, { "sdb1", "dev:8:17 udev:2" } };
+    BOOST_CHECK(!cache2.lookup(examine, command));
+
+    // a device without signature falls back to the global signature
+
+    TestProbeCache cache3(filename);
+    cache3.devices = { { "sda1", "dev:8:1 udev:1" } };
+    BOOST_CHECK(!cache3.lookup(examine, command));
+
+    TestProbeCache cache4(filename);
+    cache4.devices = { { "sda1", "dev:8:1 udev:1" }, { "sdb1", "dev:8:17 udev:1" } };
+    BOOST_CHECK(cache4.lookup(examine, command));
+
+    cleanup();
+}
+
+
+BOOST_AUTO_TEST_CASE(no_signature)
+{
+    cleanup();
+
+    TestProbeCache cache(filename);
+    cache.global = "";
+
+    cache.store(blkid, RemoteCommand({ "blkid" }));
+
+    RemoteCommand command;
+    BOOST_CHECK(!cache.lookup(blkid, command));
+}
+
+
+BOOST_AUTO_TEST_CASE(command)
+{
+    cleanup();
+
+    TestProbeCache cache(filename);
+
+    const string cmd = "/does/not/exist --probe";
+
+    cache.store(cmd, RemoteCommand({ "cached" }));
+
+    ProbeCache::Record record(cache);
+
+    SystemCmd systemcmd(cmd);
+
+    BOOST_CHECK_EQUAL(systemcmd.retcode(), 0);
+    BOOST_REQUIRE_EQUAL(systemcmd.stdout().size(), 1);
+    BOOST_CHECK_EQUAL(systemcmd.stdout()[0], "cached");
+}
+
+
+BOOST_AUTO_TEST_CASE(concurrent_save)
+{
+    cleanup();
+
+    // like several processes saving the cache at the same time
+    vector<thread> threads;
+    for (int i = 0; i < 8; ++i)
+	threads.emplace_back([i]() {
+	    for (int j = 0; j < 20; ++j)
+	    {
+		TestProbeCache cache(filename);
+		cache.store(blkid, RemoteCommand({ "blkid " + to_string(i) }));
+		BOOST_CHECK(cache.save());
+	    }
+	});
+
+    for (thread& thread : threads)
+	thread.join();
+
+    TestProbeCache cache(filename);
+
+    RemoteCommand command;
+    BOOST_REQUIRE(cache.lookup(blkid, command));
+    BOOST_CHECK_EQUAL(command.stdout.size(), 1);
+
+    struct stat st;
+    BOOST_REQUIRE_EQUAL(stat(filename.c_str(), &st), 0);
+    BOOST_CHECK_EQUAL(st.st_mode & 0777, 0600);
+
+    // no temporary files are left behind
+    vector<string> names;
+    DIR* dir = opendir("probe-cache.d");
+    BOOST_REQUIRE(dir);
+    while (struct dirent* entry = readdir(dir))
+	if (entry->d_name[0] != '.')
+	    names.push_back(entry->d_name);
+    closedir(dir);
+
+    BOOST_CHECK_EQUAL(names.size(), 1);
+
+    cleanup();
+}
@@ -0,0 +1,68 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <type_traits>
+#include <boost/test/unit_test.hpp>
+
+#include "storage/Utils/Region.h"
+#include "storage/Utils/StorageTmpl.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+static_assert(std::is_trivially_copyable<Region>::value, "Region not trivially copyable");
+static_assert(Region(10, 20).get_end() == 29, "constexpr failed");
+static_assert(Region(10, 20).contains(Region(15, 5)), "constexpr failed");
+
+
+template <typename Type>
+string
+to_string(const Type& value)
+{
+    ostringstream tmp;
+    tmp << value;
+    return tmp.str();
+}
+
+
+BOOST_AUTO_TEST_CASE(basics)
+{
+    Region region(10, 20);
+
+    BOOST_CHECK(region.contains(10));
+    BOOST_CHECK(region.contains(29));
+    BOOST_CHECK(!region.contains(30));
+
+    BOOST_CHECK(region.intersect(Region(29, 5)));
+    BOOST_CHECK(!region.intersect(Region(30, 5)));
+
+    BOOST_CHECK_EQUAL(region.intersection(Region(25, 10)), Region(25, 5));
+    BOOST_CHECK_THROW(region.intersection(Region(30, 10)), runtime_error);
+
+    BOOST_CHECK_EQUAL(region.unite(Region(30, 10)), Region(10, 30));
+    BOOST_CHECK_EQUAL(region.unite(Region(0, 15)), Region(0, 30));
+    BOOST_CHECK_THROW(region.unite(Region(31, 10)), runtime_error);
+
+    BOOST_CHECK_EQUAL(to_string(region.subtract(Region(15, 5))), "<[10,5] [20,10]>");
+    BOOST_CHECK_EQUAL(to_string(region.subtract(Region(0, 15))), "<[15,15]>");
+    BOOST_CHECK_EQUAL(to_string(region.subtract(Region(0, 100))), "<>");
+    BOOST_CHECK_EQUAL(to_string(region.subtract(Region(50, 10))), "<[10,20]>");
+
+    BOOST_CHECK_EQUAL(region.align(8), Region(16, 8));
+    BOOST_CHECK_EQUAL(Region(3, 4).align(8).get_length(), 0);
+}
+
+
+BOOST_AUTO_TEST_CASE(batch)
+{
+    vector<Region> regions = { Region(50, 10), Region(0, 10), Region(5, 10), Region(15, 5),
+			       Region(100, 0) };
+
+    BOOST_CHECK_EQUAL(to_string(merge_regions(regions)), "<[0,20] [50,10]>");
+
+    BOOST_CHECK_EQUAL(to_string(subtract_regions(Region(0, 100), regions)), "<[20,30] [60,40]>");
+    BOOST_CHECK_EQUAL(to_string(subtract_regions(Region(10, 45), regions)), "<[20,30]>");
+}
@@ -0,0 +1,166 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <unistd.h>
+#include <fstream>
+#include <sstream>
+#include <boost/test/unit_test.hpp>
+
+#include "storage/Utils/Tracer.h"
+#include "storage/Utils/JsonParser.h"
+#include "storage/Utils/SystemCmd.h"
+#include "storage/Utils/Mockup.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+class EventCollector : public JsonHandler
+{
+public:
+
+    virtual void start_object() override { ++depth; }
+    virtual void end_object() override { --depth; }
+    virtual void key(const string& key) override { last_key = key; }
+
+    virtual void value(const string& value) override
+    {
+	if (depth == 2 && last_key == "name")
+	    names.push_back(value);
+	else if (depth == 3)
+	    args[names.back() + "/" + last_key] = value;
+    }
+
+    int depth = 0;
+    string last_key;
+
+    vector<string> names;
+    map<string, string> args;
+
+};
+
+
+static EventCollector
+read_trace(const string& filename)
+{
+    ifstream in(filename);
+    stringstream buffer;
+    buffer << in.rdbuf();
+
+    EventCollector collector;
+    JsonParser parser(collector);
+    parser.parse(buffer.str());
+
+    return collector;
+}
+
+
+BOOST_AUTO_TEST_CASE(disabled)
+{
+    Tracer::set_filename("");
+
+    {
+	Tracer::Span span("test", "nothing");
+	span.set_arg("answer", 42);
+    }
+
+    Tracer::save("tracer-disabled.json");
+
+    EventCollector collector = read_trace("tracer-disabled.json");
+    unlink("tracer-disabled.json");
+
+    BOOST_CHECK(collector.names.empty());
+}
+
+
+BOOST_AUTO_TEST_CASE(spans)
+{
+    Tracer::set_filename("tracer-spans.json");
+    Tracer::clear();
+
+    {
+	Tracer::Span outer("test", "outer");
+	outer.set_arg("answer", 42);
+	outer.set_arg("ok", true);
+
+	Tracer::Span inner("test", "inner \"quoted\"");
+	inner.set_arg("text", "a\nb");
+    }
+
+    Tracer::save();
+    Tracer::set_filename("");
+
+    EventCollector collector = read_trace("tracer-spans.json");
+    unlink("tracer-spans.json");
+
+    // spans are recorded when they end
+
+    BOOST_REQUIRE_EQUAL(collector.names.size(), 2);
+    BOOST_CHECK_EQUAL(collector.names[0], "inner \"quoted\"");
+    BOOST_CHECK_EQUAL(collector.names[1], "outer");
+
+    BOOST_CHECK_EQUAL(collector.args["outer/answer"], "42");
+    BOOST_CHECK_EQUAL(collector.args["outer/ok"], "true");
+    BOOST_CHECK_EQUAL(collector.args["inner \"quoted\"/text"], "a\nb");
+}
+
+
+BOOST_AUTO_TEST_CASE(commands)
+{
+    Mockup::set_mode(Mockup::Mode::PLAYBACK);
+    Mockup::set_command("false", Mockup::Command({}, {}, 1));
+
+    Tracer::set_filename("tracer-commands.json");
+    Tracer::clear();
+
+    SystemCmd cmd("false");
+
+    Tracer::save();
+    Tracer::set_filename("");
+
+    EventCollector collector = read_trace("tracer-commands.json");
+    unlink("tracer-commands.json");
+
+    BOOST_REQUIRE_EQUAL(collector.names.size(), 1);
+    BOOST_CHECK_EQUAL(collector.names[0], "false");
+    BOOST_CHECK_EQUAL(collector.args["false/exit-code"], "1");
+    BOOST_CHECK_EQUAL(collector.args["false/source"], "mockup");
+}
+
+
+BOOST_AUTO_TEST_CASE(append)
+{
+    Tracer::set_filename("tracer-append.json");
+    Tracer::clear();
+
+    {
+	Tracer::Span span("test", "first");
+    }
+
+    Tracer::save();
+
+    {
+	Tracer::Span span("test", "second");
+    }
+
+    Tracer::save();
+    Tracer::set_filename("");
+
+    // saved events are dropped from memory but stay in the file
+
+    EventCollector collector = read_trace("tracer-append.json");
+    unlink("tracer-append.json");
+
+    BOOST_REQUIRE_EQUAL(collector.names.size(), 2);
+    BOOST_CHECK_EQUAL(collector.names[0], "first");
+    BOOST_CHECK_EQUAL(collector.names[1], "second");
+
+    Tracer::save("tracer-append-other.json");
+
+    collector = read_trace("tracer-append-other.json");
+    unlink("tracer-append-other.json");
+
+    BOOST_CHECK(collector.names.empty());
+}
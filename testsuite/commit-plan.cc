@@ -0,0 +1,127 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <unistd.h>
+#include <sstream>
+#include <boost/test/unit_test.hpp>
+
+#include "storage/Devices/DiskImpl.h"
+#include "storage/Devices/PartitionTable.h"
+#include "storage/Devices/Partition.h"
+#include "storage/Devices/Filesystem.h"
+#include "storage/Devicegraph.h"
+#include "storage/Actiongraph.h"
+#include "storage/CommitPlan.h"
+#include "storage/Storage.h"
+#include "storage/Environment.h"
+#include "storage/Utils/Region.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+BOOST_AUTO_TEST_CASE(plan)
+{
+    storage::Environment environment(true, ProbeMode::NONE, TargetMode::DIRECT);
+
+    Storage storage(environment);
+
+    Devicegraph* lhs = storage.create_devicegraph("lhs");
+
+    Disk* sda = Disk::create(lhs, "/dev/sda");
+    sda->get_impl().set_range(256);
+    sda->get_impl().set_geometry(Geometry(9999, 255, 63, 512));
+
+    Devicegraph* rhs = storage.copy_devicegraph("lhs", "rhs");
+
+    sda = Disk::find(rhs, "/dev/sda");
+
+    PartitionTable* msdos = sda->create_partition_table(PtType::MSDOS);
+
+    Partition* sda1 = msdos->create_partition("/dev/sda1", PRIMARY);
+    sda1->set_region(Region(0, 4000));
+    sda1->create_filesystem(EXT4);
+
+    Partition* sda2 = msdos->create_partition("/dev/sda2", PRIMARY);
+    sda2->set_region(Region(4000, 100));
+    sda2->create_filesystem(SWAP);
+
+    Actiongraph actiongraph(storage, lhs, rhs);
+
+    CommitTimeModel model;
+    model.set_cost("Create/Swap", CommitTimeModel::Cost(0.5));
+
+    CommitPlan plan(actiongraph, model);
+
+    double serial = 0.0;
+    for (Actiongraph::vertex_descriptor v : actiongraph.vertices())
+	serial += plan.get_cost(v);
+
+    BOOST_CHECK_CLOSE(plan.get_serial_time(), serial, 1e-6);
+
+    // one worker runs everything in sequence, unlimited workers only
+    // wait for the critical path
+
+    BOOST_CHECK_CLOSE(plan.get_makespan(1), serial, 1e-6);
+    BOOST_CHECK_CLOSE(plan.get_makespan(0), plan.get_critical_path_time(), 1e-6);
+    BOOST_CHECK(plan.get_critical_path_time() < serial);
+
+    // creating ext4 on 30 GiB is the most expensive step and thus on the
+    // critical path, the swap is not
+
+    const vector<Actiongraph::vertex_descriptor>& critical_path = plan.get_critical_path();
+    BOOST_REQUIRE(!critical_path.empty());
+
+    bool ext4 = false;
+    for (Actiongraph::vertex_descriptor v : actiongraph.vertices())
+    {
+	string key = CommitTimeModel::get_key(actiongraph, v);
+
+	if (key == "Create/Ext4")
+	{
+	    ext4 = true;
+	    BOOST_CHECK(plan.is_critical(v));
+	    BOOST_CHECK_CLOSE(CommitTimeModel::get_size_gib(actiongraph, v), 30.64, 0.1);
+	    BOOST_CHECK_CLOSE(plan.get_cost(v), 1.0 + 0.25 * 30.64, 0.1);
+	}
+
+	if (key == "Create/Swap")
+	{
+	    BOOST_CHECK(!plan.is_critical(v));
+	    BOOST_CHECK_CLOSE(plan.get_cost(v), 0.5, 1e-6);
+	}
+    }
+
+    BOOST_CHECK(ext4);
+
+    ostringstream json;
+    plan.write_json(json, 2);
+
+    BOOST_CHECK(json.str().find("\"critical-path\": [") != string::npos);
+    BOOST_CHECK(json.str().find("\"key\": \"Create/Ext4\"") != string::npos);
+}
+
+
+BOOST_AUTO_TEST_CASE(model_save_load)
+{
+    CommitTimeModel model;
+    model.set_cost("Create/Ext4", CommitTimeModel::Cost(2.5, 0.125));
+    model.set_cost("Mount", CommitTimeModel::Cost(0.75));
+
+    string filename = "commit-time-model.xml";
+    model.save(filename);
+
+    CommitTimeModel loaded;
+    loaded.load(filename);
+    unlink(filename.c_str());
+
+    BOOST_CHECK_EQUAL(loaded.get_cost("Create/Ext4").base, 2.5);
+    BOOST_CHECK_EQUAL(loaded.get_cost("Create/Ext4").per_gib, 0.125);
+    BOOST_CHECK_EQUAL(loaded.get_cost("Mount").base, 0.75);
+
+    // unknown device classes fall back to the action class
+
+    BOOST_CHECK_EQUAL(loaded.get_cost("Create/Nfs").base, 1.0);
+}
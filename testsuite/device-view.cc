@@ -0,0 +1,79 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <boost/test/unit_test.hpp>
+#include <boost/algorithm/string.hpp>
+
+#include "storage/DeviceView.h"
+#include "storage/Devicegraph.h"
+#include "storage/Utils/Mockup.h"
+#include "storage/Utils/StorageDefines.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+BOOST_AUTO_TEST_CASE(view)
+{
+    Mockup::set_mode(Mockup::Mode::PLAYBACK);
+
+    Mockup::set_command(GREPBIN " --with-filename --no-messages ''"
+			" /sys/block/*/size /sys/block/*/*/partition"
+			" /sys/block/*/*/size /sys/block/*/slaves/*/dev"
+			" /sys/block/*/dm/name /sys/block/*/dm/uuid", RemoteCommand({
+	"/sys/block/sda/size:976773168",
+	"/sys/block/dm-0/size:4194304",
+	"/sys/block/dm-1/size:8388608",
+	"/sys/block/sda/sda1/partition:1",
+	"/sys/block/sda/sda2/partition:2",
+	"/sys/block/sda/sda1/size:1048576",
+	"/sys/block/sda/sda2/size:975722496",
+	"/sys/block/dm-0/slaves/sda2/dev:8:2",
+	"/sys/block/dm-1/slaves/sda2/dev:8:2",
+	"/sys/block/dm-0/dm/name:system-root",
+	"/sys/block/dm-1/dm/name:system-swap",
+	"/sys/block/dm-0/dm/uuid:LVM-OMvXB4-0YVm-dUbV-l3Sd-iEB0-1dqP-dpbi3a",
+	"/sys/block/dm-1/dm/uuid:LVM-OMvXB4-0YVm-dUbV-l3Sd-iEB0-1dqP-YZ1Zax"
+    }, vector<string>(), 2));
+
+    Mockup::set_file("/proc/mounts", RemoteFile({
+	"/dev/mapper/system-root / ext4 rw,relatime,data=ordered 0 0",
+	"/dev/sda1 /boot/efi vfat rw 0 0"
+    }));
+
+    Mockup::set_file("/proc/swaps", RemoteFile({
+	"Filename                                Type            Size    Used    Priority",
+	"/dev/dm-1                               partition       4194300 0       -1"
+    }));
+
+    DeviceView device_view;
+
+    ostringstream out;
+    out << device_view;
+
+    vector<string> output = {
+	"/dev/mapper/system-root type:lvm_lv size_k:2097152 mountpoint:/ parents:/dev/sda2",
+	"/dev/mapper/system-swap type:lvm_lv size_k:4194304 mountpoint:swap parents:/dev/sda2",
+	"/dev/sda type:disk size_k:488386584",
+	"/dev/sda1 type:partition size_k:524288 mountpoint:/boot/efi parents:/dev/sda",
+	"/dev/sda2 type:partition size_k:487861248 parents:/dev/sda"
+    };
+
+    BOOST_CHECK_EQUAL(out.str(), boost::join(output, "\n") + "\n");
+
+    size_t sda2 = device_view.find("/dev/sda2");
+    BOOST_CHECK_EQUAL(device_view.get_type(sda2), "partition");
+
+    vector<size_t> children = device_view.get_children(sda2);
+    BOOST_REQUIRE_EQUAL(children.size(), 2);
+    BOOST_CHECK_EQUAL(device_view.get_name(children[0]), "/dev/mapper/system-root");
+    BOOST_CHECK_EQUAL(device_view.get_name(children[1]), "/dev/mapper/system-swap");
+
+    BOOST_CHECK_EQUAL(device_view.get_children(device_view.find("/dev/sda")).size(), 2);
+    BOOST_CHECK(device_view.get_children(device_view.find("/dev/sda1")).empty());
+
+    BOOST_CHECK_THROW(device_view.find("/dev/sdb"), DeviceNotFound);
+    BOOST_CHECK_THROW(device_view.get_name(device_view.size()), out_of_range);
+}
@@ -0,0 +1,133 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <boost/test/unit_test.hpp>
+#include <set>
+
+#include "storage/Devices/Disk.h"
+#include "storage/Devices/PartitionTable.h"
+#include "storage/Devices/Partition.h"
+#include "storage/Devices/Filesystem.h"
+#include "storage/Devices/LvmVg.h"
+#include "storage/Devices/LvmLv.h"
+#include "storage/Holders/User.h"
+#include "storage/Holders/Subdevice.h"
+#include "storage/Utils/Region.h"
+#include "storage/Devicegraph.h"
+#include "storage/DevicegraphTemplate.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+Disk*
+create_layout(Devicegraph* devicegraph, const string& name)
+{
+    Disk* disk = Disk::create(devicegraph, name);
+    disk->set_size_k(16 * 1024 * 1024);
+
+    PartitionTable* gpt = disk->create_partition_table(PtType::GPT);
+
+    Partition* esp = gpt->create_partition(name + "1", PRIMARY);
+    esp->set_region(Region(0, 1024));
+    esp->set_id(ID_GPT_BOOT);
+    esp->create_filesystem(EXT4);
+
+    Partition* lvm = gpt->create_partition(name + "2", PRIMARY);
+    lvm->set_region(Region(1024, 4096));
+    lvm->set_id(ID_LVM);
+
+    LvmVg* lvm_vg = LvmVg::create(devicegraph, "/dev/vg-@");
+    User::create(devicegraph, lvm, lvm_vg);
+
+    LvmLv* lvm_lv = LvmLv::create(devicegraph, "/dev/vg-@/root");
+    Subdevice::create(devicegraph, lvm_vg, lvm_lv);
+    lvm_lv->create_filesystem(XFS);
+
+    return disk;
+}
+
+
+BOOST_AUTO_TEST_CASE(instantiate)
+{
+    Devicegraph* devicegraph = new Devicegraph();
+
+    Disk* sda = create_layout(devicegraph, "/dev/sda");
+
+    const Disk* sdb = Disk::create(devicegraph, "/dev/sdb");
+    const Disk* nvme0n1 = Disk::create(devicegraph, "/dev/nvme0n1");
+
+    DevicegraphTemplate devicegraph_template(sda);
+
+    BOOST_CHECK_EQUAL(devicegraph_template.num_devices(), 7);
+    BOOST_CHECK_EQUAL(devicegraph_template.num_holders(), 7);
+
+    devicegraph->set_checkpoint("before");
+
+    devicegraph_template.instantiate(devicegraph, { sdb, nvme0n1 });
+
+    BOOST_CHECK_EQUAL(devicegraph->num_devices(), 3 * 8);
+    BOOST_CHECK_EQUAL(devicegraph->num_holders(), 3 * 7);
+
+    devicegraph->check();
+
+    const Partition* nvme0n1p2 = dynamic_cast<const Partition*>(BlkDevice::find(devicegraph, "/dev/nvme0n1p2"));
+    BOOST_REQUIRE(nvme0n1p2);
+    BOOST_CHECK_EQUAL(nvme0n1p2->get_region().get_start(), 1024);
+    BOOST_CHECK_EQUAL(nvme0n1p2->get_id(), ID_LVM);
+    BOOST_CHECK_EQUAL(nvme0n1p2->get_partition_table()->get_disk(), nvme0n1);
+
+    BOOST_CHECK(BlkDevice::find(devicegraph, "/dev/sdb1"));
+    BOOST_CHECK(BlkDevice::find(devicegraph, "/dev/vg-sdb/root"));
+    BOOST_CHECK(BlkDevice::find(devicegraph, "/dev/vg-nvme0n1/root"));
+
+    const BlkDevice* root = BlkDevice::find(devicegraph, "/dev/vg-sdb/root");
+    BOOST_CHECK(root->get_filesystem());
+    BOOST_CHECK_EQUAL(root->get_parents().size(), 1);
+
+    // the new sids are unique and in one block
+    vector<sid_t> sids = devicegraph->get_sids();
+    BOOST_CHECK_EQUAL(set<sid_t>(sids.begin(), sids.end()).size(), sids.size());
+
+    vector<sid_t> new_sids;
+    for (sid_t sid : sids)
+	if (sid > nvme0n1->get_sid())
+	    new_sids.push_back(sid);
+    BOOST_CHECK_EQUAL(new_sids.size(), 2 * 7);
+    BOOST_CHECK_EQUAL(*max_element(new_sids.begin(), new_sids.end()) - nvme0n1->get_sid(), 2 * 7);
+
+    // the free space of the copied partition tables fits the new partitions
+    BOOST_CHECK_EQUAL(nvme0n1p2->get_partition_table()->get_unused_partition_slots().size(),
+		      sda->get_partition_table()->get_unused_partition_slots().size());
+
+    devicegraph->restore_checkpoint("before");
+
+    BOOST_CHECK_EQUAL(devicegraph->num_devices(), 8 + 2);
+    BOOST_CHECK_EQUAL(devicegraph->num_holders(), 7);
+
+    delete devicegraph;
+}
+
+
+BOOST_AUTO_TEST_CASE(errors)
+{
+    Devicegraph* devicegraph = new Devicegraph();
+
+    Disk* sda = create_layout(devicegraph, "/dev/sda");
+
+    DevicegraphTemplate devicegraph_template(sda);
+
+    LvmVg* lvm_vg = LvmVg::create(devicegraph, "/dev/other");
+    BOOST_CHECK_THROW(devicegraph_template.instantiate(devicegraph, { lvm_vg }), runtime_error);
+
+    // a volume group spanning two disks cannot be captured with one disk
+    Disk* sdb = Disk::create(devicegraph, "/dev/sdb");
+    User::create(devicegraph, sdb, lvm_vg);
+    User::create(devicegraph, sda->get_partition_table()->get_partitions()[1], lvm_vg);
+
+    BOOST_CHECK_THROW(DevicegraphTemplate tmp(sda), runtime_error);
+
+    delete devicegraph;
+}
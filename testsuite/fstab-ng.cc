@@ -278,6 +278,43 @@ BOOST_AUTO_TEST_CASE(remove4)
 }
 
 
+BOOST_AUTO_TEST_CASE(batch1)
+{
+    setup({
+	"UUID=1234  /test1  ext4  defaults  0 0",
+	"/dev/sdb2  /test2  xfs  defaults  0 0"
+    });
+
+    EtcFstab fstab("/etc");
+
+    fstab.setDevice("/dev/sdb1", {}, "1234", "", {}, "");
+
+    FstabChange entry1;
+    entry1.device = entry1.dentry = "/dev/sdc1";
+    entry1.mount = "/test3";
+    entry1.fs = "ext4";
+
+    FstabChange entry2;
+    entry2.device = entry2.dentry = "/dev/sdc2";
+    entry2.mount = "/test4";
+    entry2.fs = "ext4";
+
+    // all changes of a commit are collected and written by a single flush,
+    // an entry added and removed again never shows up
+
+    fstab.removeEntry(FstabKey("/dev/sdb1", "/test1"));
+    fstab.addEntry(entry1);
+    fstab.addEntry(entry2);
+    fstab.removeEntry(FstabKey("/dev/sdc2", "/test4"));
+    fstab.flush();
+
+    check({
+	"/dev/sdb2  /test2  xfs  defaults  0 0",
+	"/dev/sdc1            /test3               ext4       defaults              0 0"
+    });
+}
+
+
 BOOST_AUTO_TEST_CASE(find1)
 {
     setup({
@@ -291,3 +328,117 @@ BOOST_AUTO_TEST_CASE(find1)
     BOOST_CHECK_EQUAL(fstab.findDevice("/dev/sdb1", entry), true);
     BOOST_CHECK_EQUAL(entry.mount, "/test1");
 }
+
+
+BOOST_AUTO_TEST_CASE(find2)
+{
+    setup({
+	"/dev/disk/by-id/ata-XYZ-part1  /test1  ext4  defaults  0 0",
+	"LABEL=data  /test2  xfs  defaults  0 0",
+	"/dev/sdd1  /test3  ext4  defaults  0 0"
+    });
+
+    EtcFstab fstab("/etc");
+
+    fstab.setDevice("/dev/sdb1", {}, "", "", { "ata-XYZ-part1" }, "");
+    fstab.setDevice("/dev/sdc1", {}, "", "data", {}, "");
+
+    FstabEntry entry;
+
+    BOOST_CHECK(fstab.findDevice("/dev/sdb1", entry));
+    BOOST_CHECK_EQUAL(entry.mount, "/test1");
+
+    BOOST_CHECK(fstab.findDevice(list<string>({ "/dev/sdx1", "/dev/sdc1" }), entry));
+    BOOST_CHECK_EQUAL(entry.mount, "/test2");
+
+    BOOST_CHECK(fstab.findMount("/test3", entry));
+    BOOST_CHECK_EQUAL(entry.device, "/dev/sdd1");
+
+    BOOST_CHECK(!fstab.findMount("/test4"));
+}
+
+
+BOOST_AUTO_TEST_CASE(lines1)
+{
+    setup({
+	"/dev/sdb1  /test1  ext4  defaults  0 0",
+	"/dev/sdb2  /test2  ext4  defaults  0 0",
+	"/dev/sdc1  /test1  ext4  noauto  0 0",
+	"/dev/sdb3  /test3  ext4  defaults  0 0"
+    });
+
+    EtcFstab fstab("/etc");
+
+    // the lines of the entries are tracked, the second entry for /test1 is
+    // removed and the line of /test3 is still found after that
+
+    FstabChange entry;
+    entry.device = entry.dentry = "/dev/sdb3";
+    entry.mount = "/test3";
+    entry.fs = "ext4";
+    entry.opts = { "noatime" };
+
+    fstab.removeEntry(FstabKey("/dev/sdb2", "/test2"));
+    fstab.removeEntry(FstabKey("/dev/sdc1", "/test1"));
+    fstab.updateEntry(FstabKey("/dev/sdb3", "/test3"), entry);
+    fstab.flush();
+
+    check({
+	"/dev/sdb1  /test1  ext4  defaults  0 0",
+	"/dev/sdb3  /test3  ext4  noatime   0 0"
+    });
+}
+
+
+BOOST_AUTO_TEST_CASE(lines2)
+{
+    setup({
+	"/dev/sdb1  /data/a  ext4  defaults  0 0"
+    });
+
+    EtcFstab fstab("/etc");
+
+    // new entries are inserted before the first entry below their mount
+    // point, also before lines inserted during the same flush
+
+    vector<string> mounts = { "/data/a/x", "/data/a/y", "/data", "/" };
+
+    for (size_t i = 0; i < mounts.size(); ++i)
+    {
+	FstabChange entry;
+	entry.device = entry.dentry = "/dev/sdc" + to_string(i + 1);
+	entry.mount = mounts[i];
+	entry.fs = "ext4";
+	entry.opts = {};
+	fstab.addEntry(entry);
+    }
+
+    fstab.flush();
+
+    check({
+	"/dev/sdc4            /                    ext4       defaults              0 0",
+	"/dev/sdc3            /data                ext4       defaults              0 0",
+	"/dev/sdb1  /data/a  ext4  defaults  0 0",
+	"/dev/sdc1            /data/a/x            ext4       defaults              0 0",
+	"/dev/sdc2            /data/a/y            ext4       defaults              0 0"
+    });
+
+    // the line numbers are assigned again after flushing
+
+    FstabChange entry;
+    entry.device = entry.dentry = "/dev/sdc1";
+    entry.mount = "/data/a/x";
+    entry.fs = "ext4";
+    entry.opts = { "noatime" };
+
+    fstab.removeEntry(FstabKey("/dev/sdc3", "/data"));
+    fstab.updateEntry(FstabKey("/dev/sdc1", "/data/a/x"), entry);
+    fstab.flush();
+
+    check({
+	"/dev/sdc4            /                    ext4       defaults              0 0",
+	"/dev/sdb1  /data/a  ext4  defaults  0 0",
+	"/dev/sdc1            /data/a/x            ext4       noatime               0 0",
+	"/dev/sdc2            /data/a/y            ext4       defaults              0 0"
+    });
+}
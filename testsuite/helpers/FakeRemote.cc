@@ -0,0 +1,90 @@
+
+
+#include <stdexcept>
+
+#include "storage/Utils/Mockup.h"
+#include "testsuite/helpers/FakeRemote.h"
+
+
+using namespace std;
+
+
+namespace storage
+{
+
+    FakeRemoteCallbacks::FakeRemoteCallbacks(const string& mockup_filename, bool batching)
+	: batching(batching), round_trips(0), batches(0)
+    {
+	Mockup::load(mockup_filename);
+    }
+
+
+    RemoteCommand
+    FakeRemoteCallbacks::get_command(const string& name) const
+    {
+	++round_trips;
+	singles.push_back(name);
+
+	return lookup_command(name);
+    }
+
+
+    RemoteFile
+    FakeRemoteCallbacks::get_file(const string& name) const
+    {
+	++round_trips;
+	singles.push_back(name);
+
+	return lookup_file(name);
+    }
+
+
+    RemoteBatchResult
+    FakeRemoteCallbacks::get_batch(const RemoteBatch& batch) const
+    {
+	if (!batching)
+	    return RemoteCallbacks::get_batch(batch);
+
+	++round_trips;
+	++batches;
+
+	RemoteBatchResult result;
+
+	for (const string& name : batch.commands)
+	    result.commands.push_back(lookup_command(name));
+
+	for (const string& name : batch.files)
+	    result.files.push_back(lookup_file(name));
+
+	return result;
+    }
+
+
+    RemoteCommand
+    FakeRemoteCallbacks::lookup_command(const string& name) const
+    {
+	try
+	{
+	    return Mockup::get_command(name);
+	}
+	catch (const runtime_error&)
+	{
+	    return RemoteCommand({}, { "command not found" }, 127);
+	}
+    }
+
+
+    RemoteFile
+    FakeRemoteCallbacks::lookup_file(const string& name) const
+    {
+	try
+	{
+	    return Mockup::get_file(name);
+	}
+	catch (const runtime_error&)
+	{
+	    return RemoteFile();
+	}
+    }
+
+}
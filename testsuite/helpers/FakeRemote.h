@@ -0,0 +1,52 @@
+
+#include <string>
+#include <vector>
+
+#include "storage/Utils/Remote.h"
+
+
+namespace storage
+{
+
+    using std::string;
+    using std::vector;
+
+
+    /*
+     * Remote callbacks answering from a mockup file instead of a remote
+     * machine. Counts the round trips, a batch counts as one round trip.
+     * Unknown commands fail with exit code 127, unknown files are empty.
+     */
+
+
+    class FakeRemoteCallbacks : public RemoteCallbacks
+    {
+    public:
+
+	FakeRemoteCallbacks(const string& mockup_filename, bool batching = true);
+
+	virtual RemoteCommand get_command(const string& name) const override;
+	virtual RemoteFile get_file(const string& name) const override;
+
+	virtual RemoteBatchResult get_batch(const RemoteBatch& batch) const override;
+
+	unsigned int get_round_trips() const { return round_trips; }
+	unsigned int get_batches() const { return batches; }
+
+	// names requested one by one
+	const vector<string>& get_singles() const { return singles; }
+
+    private:
+
+	RemoteCommand lookup_command(const string& name) const;
+	RemoteFile lookup_file(const string& name) const;
+
+	const bool batching;
+
+	mutable unsigned int round_trips;
+	mutable unsigned int batches;
+	mutable vector<string> singles;
+
+    };
+
+}
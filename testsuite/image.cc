@@ -0,0 +1,258 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <unistd.h>
+#include <sys/stat.h>
+#include <fstream>
+#include <boost/test/unit_test.hpp>
+
+#include "storage/Devices/Disk.h"
+#include "storage/Devices/PartitionTable.h"
+#include "storage/Devices/Partition.h"
+#include "storage/Devices/Filesystem.h"
+#include "storage/Utils/Region.h"
+#include "storage/Devicegraph.h"
+#include "storage/Storage.h"
+#include "storage/Environment.h"
+#include "storage/ImageBuilder.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+string
+read(const string& filename, unsigned long long offset, size_t size)
+{
+    ifstream in(filename, ios::binary);
+    in.seekg(offset);
+
+    string data(size, '\0');
+    in.read(&data[0], size);
+    return data;
+}
+
+
+unsigned long long
+read_le(const string& filename, unsigned long long offset, size_t size)
+{
+    string data = read(filename, offset, size);
+
+    unsigned long long value = 0;
+    for (size_t i = size; i > 0; --i)
+	value = (value << 8) | (unsigned char)(data[i - 1]);
+    return value;
+}
+
+
+unsigned int
+crc32(const string& data)
+{
+    unsigned int crc = 0xffffffff;
+    for (unsigned char c : data)
+    {
+	crc ^= c;
+	for (int i = 0; i < 8; ++i)
+	    crc = crc & 1 ? 0xedb88320 ^ (crc >> 1) : crc >> 1;
+    }
+    return crc ^ 0xffffffff;
+}
+
+
+void
+check_gpt_header(const string& filename, unsigned long long lba)
+{
+    BOOST_CHECK_EQUAL(read(filename, lba * 512, 8), "EFI PART");
+
+    string header = read(filename, lba * 512, 92);
+    unsigned int crc = read_le(filename, lba * 512 + 16, 4);
+    header.replace(16, 4, 4, '\0');
+    BOOST_CHECK_EQUAL(crc32(header), crc);
+
+    unsigned long long array_lba = read_le(filename, lba * 512 + 72, 8);
+    BOOST_CHECK_EQUAL(crc32(read(filename, array_lba * 512, 128 * 128)),
+		      read_le(filename, lba * 512 + 88, 4));
+}
+
+
+void
+check_ext4_size(const string& filename, unsigned long long start, unsigned long long length)
+{
+    // blocks count and block size from the superblock must match the
+    // partition, otherwise mke2fs wrote beyond its end
+    unsigned long long blocks = read_le(filename, start * 512 + 1024 + 4, 4);
+    unsigned long long log_block_size = read_le(filename, start * 512 + 1024 + 24, 4);
+    BOOST_CHECK_EQUAL(blocks << (10 + log_block_size), length * 512);
+}
+
+
+BOOST_AUTO_TEST_CASE(gpt)
+{
+    const string filename = "image-gpt.img";
+
+    storage::Environment environment(true, ProbeMode::NONE, TargetMode::IMAGE);
+
+    Storage storage(environment);
+
+    Devicegraph* staging = storage.get_staging();
+
+    Disk* disk = Disk::create(staging, filename);
+    disk->set_size_k(64 * 1024);
+
+    PartitionTable* gpt = disk->create_partition_table(PtType::GPT);
+
+    Partition* root = gpt->create_partition(filename + "1", PRIMARY);
+    root->set_region(Region(0, 64));
+
+    Filesystem* ext4 = root->create_filesystem(EXT4);
+    ext4->set_label("root");
+    ext4->set_mountpoints({ "/" });
+
+    Partition* swap = gpt->create_partition(filename + "2", PRIMARY);
+    swap->set_region(Region(64, 128));
+    swap->set_id(ID_SWAP);
+
+    swap->create_filesystem(SWAP);
+
+    storage.commit(nullptr);
+
+    struct stat st;
+    BOOST_REQUIRE_EQUAL(stat(filename.c_str(), &st), 0);
+    BOOST_CHECK_EQUAL(st.st_size, 64 * 1024 * 1024);
+    BOOST_CHECK_LT(st.st_blocks * 512, st.st_size);
+
+    // protective MBR
+    BOOST_CHECK_EQUAL(read_le(filename, 510, 2), 0xaa55);
+    BOOST_CHECK_EQUAL(read_le(filename, 446 + 4, 1), 0xee);
+
+    const unsigned long long last = 64 * 2048 - 1;
+
+    check_gpt_header(filename, 1);
+    check_gpt_header(filename, last);
+
+    BOOST_CHECK_EQUAL(read_le(filename, 1024 + 32, 8), 2048);
+    BOOST_CHECK_EQUAL(read_le(filename, 1024 + 40, 8), 32767);
+    BOOST_CHECK_EQUAL(read_le(filename, 1024 + 128 + 32, 8), 32768);
+    BOOST_CHECK_EQUAL(read_le(filename, 1024 + 128 + 40, 8), 98303);
+
+    // ext4 superblock with magic and label
+    BOOST_CHECK_EQUAL(read_le(filename, 2048 * 512 + 1024 + 56, 2), 0xef53);
+    BOOST_CHECK_EQUAL(read(filename, 2048 * 512 + 1024 + 120, 5), string("root\0", 5));
+    check_ext4_size(filename, 2048, 30720);
+
+    // swap signature
+    BOOST_CHECK_EQUAL(read(filename, 32768 * 512 + 4096 - 10, 10), "SWAPSPACE2");
+    BOOST_CHECK_EQUAL(read_le(filename, 32768 * 512 + 1024 + 4, 4), 65536 * 512 / 4096 - 1);
+
+    unlink(filename.c_str());
+}
+
+
+BOOST_AUTO_TEST_CASE(msdos)
+{
+    const string filename = "image-msdos.img";
+
+    storage::Environment environment(true, ProbeMode::NONE, TargetMode::IMAGE);
+
+    Storage storage(environment);
+
+    Devicegraph* staging = storage.get_staging();
+
+    Disk* disk = Disk::create(staging, filename);
+    disk->set_size_k(64 * 1024);
+
+    PartitionTable* msdos = disk->create_partition_table(PtType::MSDOS);
+
+    Partition* primary = msdos->create_partition(filename + "1", PRIMARY);
+    primary->set_region(Region(0, 32));
+    primary->set_boot(true);
+
+    Partition* extended = msdos->create_partition(filename + "2", EXTENDED);
+    extended->set_region(Region(32, 224));
+
+    Partition* logical1 = msdos->create_partition(filename + "5", LOGICAL);
+    logical1->set_region(Region(32, 64));
+    logical1->create_filesystem(EXT4);
+
+    Partition* logical2 = msdos->create_partition(filename + "6", LOGICAL);
+    logical2->set_region(Region(96, 64));
+    logical2->set_id(ID_SWAP);
+
+    storage.commit(nullptr);
+
+    BOOST_CHECK_EQUAL(read_le(filename, 510, 2), 0xaa55);
+
+    BOOST_CHECK_EQUAL(read_le(filename, 446, 1), 0x80);
+    BOOST_CHECK_EQUAL(read_le(filename, 446 + 4, 1), 0x83);
+    BOOST_CHECK_EQUAL(read_le(filename, 446 + 8, 4), 2048);
+    BOOST_CHECK_EQUAL(read_le(filename, 446 + 12, 4), 14336);
+
+    BOOST_CHECK_EQUAL(read_le(filename, 462 + 4, 1), 0x0f);
+    BOOST_CHECK_EQUAL(read_le(filename, 462 + 8, 4), 16384);
+
+    // first EBR at the start of the extended partition
+    const unsigned long long ebr1 = 16384 * 512;
+    BOOST_CHECK_EQUAL(read_le(filename, ebr1 + 510, 2), 0xaa55);
+    BOOST_CHECK_EQUAL(read_le(filename, ebr1 + 446 + 4, 1), 0x83);
+    BOOST_CHECK_EQUAL(read_le(filename, ebr1 + 446 + 8, 4), 2048);
+    BOOST_CHECK_EQUAL(read_le(filename, ebr1 + 446 + 12, 4), 30720);
+    BOOST_CHECK_EQUAL(read_le(filename, ebr1 + 462 + 4, 1), 0x05);
+    BOOST_CHECK_EQUAL(read_le(filename, ebr1 + 462 + 8, 4), 32768);
+    BOOST_CHECK_EQUAL(read_le(filename, ebr1 + 462 + 12, 4), 32768);
+
+    const unsigned long long ebr2 = 49152 * 512;
+    BOOST_CHECK_EQUAL(read_le(filename, ebr2 + 446 + 4, 1), 0x82);
+    BOOST_CHECK_EQUAL(read_le(filename, ebr2 + 446 + 8, 4), 2048);
+    BOOST_CHECK_EQUAL(read_le(filename, ebr2 + 446 + 12, 4), 30720);
+    BOOST_CHECK_EQUAL(read_le(filename, ebr2 + 462 + 4, 1), 0x00);
+
+    BOOST_CHECK_EQUAL(read_le(filename, 18432 * 512 + 1024 + 56, 2), 0xef53);
+    check_ext4_size(filename, 18432, 30720);
+
+    // the filesystem of the first logical partition must not overwrite
+    // the second EBR
+    BOOST_CHECK_EQUAL(read_le(filename, ebr2 + 510, 2), 0xaa55);
+
+    unlink(filename.c_str());
+}
+
+
+BOOST_AUTO_TEST_CASE(builder)
+{
+    Devicegraph* devicegraph = new Devicegraph();
+
+    Disk* disk = Disk::create(devicegraph, "/dev/vda");
+    disk->set_size_k(32 * 1024);
+
+    PartitionTable* gpt = disk->create_partition_table(PtType::GPT);
+
+    Partition* root = gpt->create_partition("/dev/vda1", PRIMARY);
+    root->set_region(Region(0, 120));
+    root->create_filesystem(EXT4);
+
+    ImageBuilder image_builder(devicegraph);
+
+    vector<map<string, string>> filenames;
+    for (int i = 0; i < 4; ++i)
+	filenames.push_back({ { "/dev/vda", "image-builder-" + to_string(i) + ".img" } });
+
+    image_builder.build(filenames, 2);
+
+    for (const map<string, string>& tmp : filenames)
+    {
+	const string& filename = tmp.at("/dev/vda");
+
+	check_gpt_header(filename, 1);
+	BOOST_CHECK_EQUAL(read_le(filename, 2048 * 512 + 1024 + 56, 2), 0xef53);
+
+	unlink(filename.c_str());
+    }
+
+    BOOST_CHECK_EXCEPTION(image_builder.build(map<string, string>({ { "/dev/vdb", "image-builder.img" } })),
+			  runtime_error, [](const runtime_error& e) {
+			      return string(e.what()) == "no image filename for /dev/vda";
+			  });
+
+    delete devicegraph;
+}
@@ -0,0 +1,126 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <boost/test/unit_test.hpp>
+
+#include "storage/Devices/DiskImpl.h"
+#include "storage/Devices/PartitionTable.h"
+#include "storage/Devices/Partition.h"
+#include "storage/Devicegraph.h"
+#include "storage/DevicegraphImpl.h"
+#include "storage/Storage.h"
+#include "storage/Environment.h"
+#include "storage/Utils/Region.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+BOOST_AUTO_TEST_CASE(undo_redo)
+{
+    storage::Environment environment(true, ProbeMode::NONE, TargetMode::DIRECT);
+
+    Storage storage(environment);
+
+    Devicegraph* devicegraph = storage.get_staging();
+
+    Disk* sda = Disk::create(devicegraph, "/dev/sda");
+    sda->get_impl().set_range(256);
+    sda->get_impl().set_geometry(Geometry(9999, 255, 63, 512));
+
+    // nothing is recorded before the first checkpoint
+
+    BOOST_CHECK_EQUAL(devicegraph->get_impl().journal.num_entries(), 0);
+
+    devicegraph->set_checkpoint("empty");
+
+    PartitionTable* msdos = sda->create_partition_table(PtType::MSDOS);
+
+    Partition* sda1 = msdos->create_partition("/dev/sda1", PRIMARY);
+    sda1->set_region(Region(0, 1000));
+
+    devicegraph->set_checkpoint("one");
+
+    sda1->set_region(Region(0, 2000));
+    sda1->set_id(ID_SWAP);
+
+    Partition* sda2 = msdos->create_partition("/dev/sda2", PRIMARY);
+    sda2->set_region(Region(2000, 1000));
+
+    devicegraph->set_checkpoint("two");
+
+    BOOST_CHECK_EQUAL(devicegraph->num_devices(), 4);
+    BOOST_CHECK_EQUAL(devicegraph->num_holders(), 3);
+
+    devicegraph->restore_checkpoint("one");
+
+    BOOST_CHECK_EQUAL(devicegraph->num_devices(), 3);
+    BOOST_CHECK_EQUAL(devicegraph->num_holders(), 2);
+    BOOST_CHECK_EQUAL(sda1->get_region().get_length(), 1000);
+    BOOST_CHECK_EQUAL(sda1->get_id(), ID_LINUX);
+
+    devicegraph->restore_checkpoint("empty");
+
+    BOOST_CHECK_EQUAL(devicegraph->num_devices(), 1);
+    BOOST_CHECK_EQUAL(devicegraph->num_holders(), 0);
+
+    devicegraph->check();
+
+    // redo brings back the very same objects
+
+    devicegraph->restore_checkpoint("two");
+
+    BOOST_CHECK_EQUAL(devicegraph->num_devices(), 4);
+    BOOST_CHECK_EQUAL(devicegraph->num_holders(), 3);
+    BOOST_CHECK_EQUAL(Partition::find(devicegraph, "/dev/sda1"), sda1);
+    BOOST_CHECK_EQUAL(sda1->get_region().get_length(), 2000);
+    BOOST_CHECK_EQUAL(sda1->get_id(), ID_SWAP);
+
+    devicegraph->check();
+}
+
+
+BOOST_AUTO_TEST_CASE(remove_and_discard)
+{
+    storage::Environment environment(true, ProbeMode::NONE, TargetMode::DIRECT);
+
+    Storage storage(environment);
+
+    Devicegraph* devicegraph = storage.get_staging();
+
+    Disk* sda = Disk::create(devicegraph, "/dev/sda");
+    sda->get_impl().set_range(256);
+    sda->get_impl().set_geometry(Geometry(9999, 255, 63, 512));
+
+    PartitionTable* msdos = sda->create_partition_table(PtType::MSDOS);
+    msdos->create_partition("/dev/sda1", PRIMARY);
+
+    devicegraph->set_checkpoint("before");
+
+    msdos->delete_partition("/dev/sda1");
+
+    devicegraph->set_checkpoint("after");
+
+    BOOST_CHECK_EQUAL(devicegraph->num_devices(), 2);
+
+    devicegraph->restore_checkpoint("before");
+
+    BOOST_CHECK_EQUAL(devicegraph->num_devices(), 3);
+    BOOST_CHECK_EQUAL(devicegraph->num_holders(), 2);
+
+    devicegraph->check();
+
+    // a new change discards checkpoints that could be redone
+
+    msdos->create_partition("/dev/sda2", PRIMARY);
+
+    BOOST_CHECK(devicegraph->has_checkpoint("before"));
+    BOOST_CHECK(!devicegraph->has_checkpoint("after"));
+
+    devicegraph->restore_checkpoint("before");
+
+    BOOST_CHECK_EQUAL(devicegraph->num_devices(), 3);
+    BOOST_CHECK_THROW(Partition::find(devicegraph, "/dev/sda2"), DeviceNotFound);
+}
@@ -204,3 +204,57 @@ BOOST_AUTO_TEST_CASE(test_gpt1)
     BOOST_CHECK_EQUAL(it->logicalSlot, false);
     BOOST_CHECK_EQUAL(it->logicalPossible, false);
 }
+
+
+BOOST_AUTO_TEST_CASE(test_update)
+{
+    storage::Environment environment(true, ProbeMode::NONE, TargetMode::DIRECT);
+
+    Storage storage(environment);
+
+    Devicegraph* devicegraph = storage.get_staging();
+
+    Disk* sda = Disk::create(devicegraph, "/dev/sda");
+    sda->get_impl().set_range(256);
+    sda->get_impl().set_geometry(Geometry(9999, 255, 63, 512));
+
+    PartitionTable* gpt = sda->create_partition_table(PtType::GPT);
+
+    Partition* sda1 = gpt->create_partition("/dev/sda1", PRIMARY);
+    sda1->set_region(Region(0, 1000));
+
+    BOOST_CHECK_EQUAL(gpt->get_unused_partition_slots().size(), 1);
+
+    // the free space is updated when partitions change
+
+    Partition* sda2 = gpt->create_partition("/dev/sda2", PRIMARY);
+    sda2->set_region(Region(2000, 3000));
+
+    Region region;
+
+    BOOST_CHECK(gpt->get_impl().get_largest_free_region(false, region));
+    BOOST_CHECK_EQUAL(region, Region(5000, 4999));
+
+    BOOST_CHECK(gpt->get_impl().get_best_fit_region(500, false, region));
+    BOOST_CHECK_EQUAL(region, Region(1000, 1000));
+
+    BOOST_CHECK(!gpt->get_impl().get_best_fit_region(6000, false, region));
+
+    sda2->set_region(Region(2000, 7000));
+
+    BOOST_CHECK(gpt->get_impl().get_largest_free_region(false, region));
+    BOOST_CHECK_EQUAL(region, Region(1000, 1000));
+
+    gpt->delete_partition("/dev/sda1");
+
+    BOOST_CHECK(gpt->get_impl().get_largest_free_region(false, region));
+    BOOST_CHECK_EQUAL(region, Region(0, 2000));
+
+    list<PartitionSlotInfo> slots = gpt->get_unused_partition_slots();
+
+    BOOST_CHECK_EQUAL(slots.size(), 2);
+    BOOST_CHECK_EQUAL(slots.front().cylRegion.start, 0);
+    BOOST_CHECK_EQUAL(slots.front().cylRegion.len, 2000);
+    BOOST_CHECK_EQUAL(slots.back().cylRegion.start, 9000);
+    BOOST_CHECK_EQUAL(slots.back().cylRegion.len, 999);
+}
@@ -0,0 +1,70 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <iostream>
+#include <boost/test/unit_test.hpp>
+
+#include "storage/Environment.h"
+#include "storage/Storage.h"
+#include "storage/DevicegraphImpl.h"
+
+#include "testsuite/helpers/TsCmp.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+// must be the first test since the sids in the devicegraph file start
+// with the first sid
+BOOST_AUTO_TEST_CASE(dependencies)
+{
+    storage::Environment environment(true, ProbeMode::READ_MOCKUP, TargetMode::DIRECT);
+    environment.set_mockup_filename("disk-mockup.xml");
+    environment.set_probe_jobs(4);
+
+    Storage storage(environment);
+
+    const Devicegraph* probed = storage.get_probed();
+
+    probed->check();
+
+    Devicegraph* staging = storage.get_staging();
+
+    staging->load("disk-devicegraph.xml");
+    staging->check();
+
+    TsCmpDevicegraph cmp(*probed, *staging);
+    BOOST_CHECK_MESSAGE(cmp.ok(), cmp);
+}
+
+
+BOOST_AUTO_TEST_CASE(reproducible)
+{
+    storage::Environment environment(true, ProbeMode::READ_MOCKUP, TargetMode::DIRECT);
+    environment.set_mockup_filename("disk-mockup.xml");
+
+    vector<string> outputs;
+
+    for (unsigned int jobs : { 1, 2, 4 })
+    {
+	environment.set_probe_jobs(jobs);
+
+	Storage storage(environment);
+
+	const Devicegraph* probed = storage.get_probed();
+
+	vector<sid_t> sids = probed->get_sids();
+	sid_t first = sids.front();
+
+	ostringstream output;
+	for (sid_t sid : sids)
+	    output << sid - first << " " << probed->find_device(sid)->get_displayname() << endl;
+
+	outputs.push_back(output.str());
+    }
+
+    BOOST_CHECK_EQUAL(outputs[1], outputs[0]);
+    BOOST_CHECK_EQUAL(outputs[2], outputs[0]);
+}
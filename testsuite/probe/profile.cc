@@ -0,0 +1,64 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <algorithm>
+#include <boost/test/unit_test.hpp>
+
+#include "storage/Environment.h"
+#include "storage/Storage.h"
+#include "storage/StorageImpl.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+BOOST_AUTO_TEST_CASE(profile)
+{
+    storage::Environment environment(true, ProbeMode::READ_MOCKUP, TargetMode::DIRECT);
+    environment.set_mockup_filename("disk-mockup.xml");
+
+    Storage storage(environment);
+
+    const ProbeProfile& probe_profile = storage.get_impl().get_probe_profile();
+
+    // phases nest and are reported in order of first entry
+
+    vector<string> names;
+    for (const ProbeProfile::Phase& phase : probe_profile.get_phases())
+	names.push_back(phase.name);
+
+    BOOST_REQUIRE(!names.empty());
+    BOOST_CHECK_EQUAL(names[0], "probe");
+    BOOST_CHECK(find(names.begin(), names.end(), "probe > disk discovery") != names.end());
+    BOOST_CHECK(find(names.begin(), names.end(), "probe > Disk /dev/sda > partition table") != names.end());
+    BOOST_CHECK(find(names.begin(), names.end(), "probe > filesystems") != names.end());
+
+    // commands are attributed to the phase running them first
+
+    const map<string, ProbeProfile::Command>& commands = probe_profile.get_commands();
+
+    map<string, ProbeProfile::Command>::const_iterator it =
+	commands.find("/usr/sbin/parted -s '/dev/sda' unit cyl print unit s print");
+    BOOST_REQUIRE(it != commands.end());
+    BOOST_CHECK_EQUAL(it->second.count, 1);
+    BOOST_CHECK_EQUAL(it->second.phase, "probe > Disk /dev/sda > partition table");
+
+    // every SystemInfo object is created once, further lookups are hits
+
+    map<string, ProbeProfile::Cache> caches = probe_profile.get_caches();
+
+    BOOST_CHECK_EQUAL(caches["Parted"].misses, 2);
+    BOOST_CHECK_EQUAL(caches["Blkid"].misses, 1);
+    BOOST_CHECK(caches["Blkid"].hits > 0);
+
+    unsigned int commands_in_phases = 0;
+    for (const ProbeProfile::Phase& phase : probe_profile.get_phases())
+	commands_in_phases += phase.commands;
+
+    unsigned int commands_run = 0;
+    for (const map<string, ProbeProfile::Command>::value_type& command : commands)
+	commands_run += command.second.count;
+
+    BOOST_CHECK_EQUAL(commands_in_phases, commands_run);
+}
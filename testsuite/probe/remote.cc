@@ -0,0 +1,70 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <iostream>
+#include <boost/test/unit_test.hpp>
+
+#include "storage/Environment.h"
+#include "storage/Storage.h"
+#include "storage/DevicegraphImpl.h"
+#include "storage/Utils/Remote.h"
+
+#include "testsuite/helpers/TsCmp.h"
+#include "testsuite/helpers/FakeRemote.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+unsigned int
+probe(const FakeRemoteCallbacks& remote_callbacks, bool compare)
+{
+    set_remote_callbacks(&remote_callbacks);
+
+    storage::Environment environment(true, ProbeMode::STANDARD, TargetMode::DIRECT);
+
+    Storage storage(environment);
+
+    set_remote_callbacks(nullptr);
+
+    const Devicegraph* probed = storage.get_probed();
+
+    probed->check();
+
+    // the sids in the devicegraph file only match for the first probe
+    if (!compare)
+	return remote_callbacks.get_round_trips();
+
+    Devicegraph* staging = storage.get_staging();
+
+    staging->load("disk-devicegraph.xml");
+    staging->check();
+
+    TsCmpDevicegraph cmp(*probed, *staging);
+    BOOST_CHECK_MESSAGE(cmp.ok(), cmp);
+
+    return remote_callbacks.get_round_trips();
+}
+
+
+BOOST_AUTO_TEST_CASE(batched)
+{
+    FakeRemoteCallbacks batched("disk-mockup.xml");
+    unsigned int batched_round_trips = probe(batched, true);
+
+    FakeRemoteCallbacks unbatched("disk-mockup.xml", false);
+    unsigned int unbatched_round_trips = probe(unbatched, false);
+
+    cout << "round trips unbatched:" << unbatched_round_trips << " batched:"
+	 << batched_round_trips << endl;
+
+    for (const string& name : batched.get_singles())
+	cout << "single request " << name << endl;
+
+    BOOST_CHECK_EQUAL(batched.get_batches(), 4);
+    BOOST_CHECK(batched.get_singles().empty());
+    BOOST_CHECK_EQUAL(batched_round_trips, 4);
+    BOOST_CHECK(unbatched_round_trips >= 20);
+}
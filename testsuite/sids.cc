@@ -0,0 +1,98 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <boost/test/unit_test.hpp>
+#include <set>
+#include <thread>
+
+#include "storage/Devices/DiskImpl.h"
+#include "storage/Devices/PartitionImpl.h"
+#include "storage/Holders/Subdevice.h"
+#include "storage/Devicegraph.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+void
+create_disks(Devicegraph* devicegraph, int n)
+{
+    for (int i = 0; i < n; ++i)
+    {
+	Disk* disk = Disk::create(devicegraph, "/dev/sd" + to_string(i));
+	Partition* partition = Partition::create(devicegraph, "/dev/sd" + to_string(i) + "1", PRIMARY);
+	Subdevice::create(devicegraph, disk, partition);
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(threads)
+{
+    const int num_threads = 8;
+    const int n = 500;
+
+    vector<Devicegraph*> devicegraphs;
+    vector<thread> threads;
+
+    for (int i = 0; i < num_threads; ++i)
+    {
+	devicegraphs.push_back(new Devicegraph());
+	threads.emplace_back(create_disks, devicegraphs.back(), n);
+    }
+
+    for (thread& t : threads)
+	t.join();
+
+    set<sid_t> sids;
+
+    for (Devicegraph* devicegraph : devicegraphs)
+    {
+	BOOST_CHECK_EQUAL(devicegraph->num_devices(), 2 * n);
+	BOOST_CHECK_EQUAL(devicegraph->num_holders(), n);
+
+	for (sid_t sid : devicegraph->get_sids())
+	    sids.insert(sid);
+
+	delete devicegraph;
+    }
+
+    BOOST_CHECK_EQUAL(sids.size(), num_threads * 2 * n);
+}
+
+
+BOOST_AUTO_TEST_CASE(reservation)
+{
+    Devicegraph* devicegraph = new Devicegraph();
+
+    sid_t first, second, third;
+
+    {
+	Device::Impl::SidReservation reservation(2);
+
+	first = Disk::create(devicegraph, "/dev/sda")->get_sid();
+
+	// other threads do not use the reservation
+	sid_t other;
+	thread([&other]() {
+	    Devicegraph tmp;
+	    other = Disk::create(&tmp, "/dev/sdz")->get_sid();
+	}).join();
+	BOOST_CHECK_GT(other, first + 1);
+
+	second = Disk::create(devicegraph, "/dev/sdb")->get_sid();
+	third = Disk::create(devicegraph, "/dev/sdc")->get_sid();
+    }
+
+    BOOST_CHECK_EQUAL(second, first + 1);
+    BOOST_CHECK_GT(third, second + 1);
+
+    // after the reservation sids come from the global counter again
+    BOOST_CHECK_GT(Disk::create(devicegraph, "/dev/sdd")->get_sid(), third);
+
+    sid_t start = Device::Impl::allocate_sids(10);
+    BOOST_CHECK_GE(Disk::create(devicegraph, "/dev/sde")->get_sid(), start + 10);
+
+    delete devicegraph;
+}
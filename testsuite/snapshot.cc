@@ -0,0 +1,117 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <thread>
+#include <boost/test/unit_test.hpp>
+
+#include "storage/Devices/DiskImpl.h"
+#include "storage/Devices/PartitionTable.h"
+#include "storage/Devices/Partition.h"
+#include "storage/Devicegraph.h"
+#include "storage/Storage.h"
+#include "storage/Environment.h"
+#include "storage/Utils/Region.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+BOOST_AUTO_TEST_CASE(snapshot)
+{
+    storage::Environment environment(true, ProbeMode::NONE, TargetMode::DIRECT);
+
+    Storage storage(environment);
+
+    shared_ptr<const Devicegraph> probed = storage.get_snapshot("probed");
+    BOOST_CHECK(probed->empty());
+
+    BOOST_CHECK_THROW(storage.get_snapshot("staging"), runtime_error);
+
+    Devicegraph* staging = storage.get_staging();
+    Disk::create(staging, "/dev/sda");
+
+    storage.publish_snapshot("staging");
+
+    shared_ptr<const Devicegraph> staging1 = storage.get_snapshot("staging");
+    BOOST_CHECK_EQUAL(staging1->num_devices(), 1);
+
+    Disk::create(staging, "/dev/sdb");
+
+    BOOST_CHECK_EQUAL(storage.get_snapshot("staging")->num_devices(), 1);
+
+    storage.publish_snapshot("staging");
+
+    shared_ptr<const Devicegraph> staging2 = storage.get_snapshot("staging");
+    BOOST_CHECK_EQUAL(staging2->num_devices(), 2);
+
+    // older snapshots stay valid and unchanged
+
+    BOOST_CHECK_EQUAL(staging1->num_devices(), 1);
+    BOOST_CHECK(storage.get_snapshot("probed") == probed);
+}
+
+
+BOOST_AUTO_TEST_CASE(outlive_storage)
+{
+    shared_ptr<const Devicegraph> staging;
+
+    {
+	storage::Environment environment(true, ProbeMode::NONE, TargetMode::IMAGE);
+
+	Storage storage(environment);
+
+	Disk* disk = Disk::create(storage.get_staging(), "/dev/sda");
+	disk->set_size_k(16 * 1024 * 1024);
+
+	storage.publish_snapshot("staging");
+
+	staging = storage.get_snapshot("staging");
+    }
+
+    BOOST_CHECK(!staging->get_storage());
+
+    const Disk* disk = Disk::find(staging.get(), "/dev/sda");
+    BOOST_CHECK(disk->get_default_partition_table_type() == PtType::MSDOS);
+    BOOST_CHECK(disk->get_impl().is_image_target());
+}
+
+
+BOOST_AUTO_TEST_CASE(concurrent_free_space)
+{
+    storage::Environment environment(true, ProbeMode::NONE, TargetMode::DIRECT);
+
+    Storage storage(environment);
+
+    Devicegraph* staging = storage.get_staging();
+
+    Disk* sda = Disk::create(staging, "/dev/sda");
+    sda->get_impl().set_range(256);
+    sda->get_impl().set_geometry(Geometry(9999, 255, 63, 512));
+
+    PartitionTable* msdos = sda->create_partition_table(PtType::MSDOS);
+    for (unsigned int i = 0; i < 4; ++i)
+	msdos->create_partition("/dev/sda" + to_string(i + 1), PRIMARY)->set_region(Region(i * 2000, 1000));
+
+    storage.publish_snapshot("staging");
+
+    // the free space of the snapshot is built on demand by the readers
+
+    shared_ptr<const Devicegraph> snapshot = storage.get_snapshot("staging");
+    const PartitionTable* partition_table = Disk::find(snapshot.get(), "/dev/sda")->get_partition_table();
+
+    vector<size_t> num_slots(8);
+
+    vector<thread> threads;
+    for (size_t i = 0; i < num_slots.size(); ++i)
+	threads.emplace_back([partition_table, &num_slots, i]() {
+	    num_slots[i] = partition_table->get_unused_partition_slots().size();
+	});
+
+    for (thread& t : threads)
+	t.join();
+
+    for (size_t n : num_slots)
+	BOOST_CHECK_EQUAL(n, 4);
+}
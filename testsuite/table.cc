@@ -0,0 +1,164 @@
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE libstorage
+
+#include <boost/test/unit_test.hpp>
+
+#include "storage/Devices/Disk.h"
+#include "storage/Devices/Partition.h"
+#include "storage/Devices/LvmVg.h"
+#include "storage/Devices/LvmLv.h"
+#include "storage/Holders/User.h"
+#include "storage/Holders/Subdevice.h"
+#include "storage/Devicegraph.h"
+
+
+using namespace std;
+using namespace storage;
+
+
+BOOST_AUTO_TEST_CASE(table)
+{
+    Devicegraph* devicegraph = new Devicegraph();
+
+    Disk* sda = Disk::create(devicegraph, "/dev/sda");
+    sda->set_size_k(1024 * 1024);
+
+    Partition* sda1 = Partition::create(devicegraph, "/dev/sda1", PRIMARY);
+    Subdevice::create(devicegraph, sda, sda1);
+
+    Partition* sda2 = Partition::create(devicegraph, "/dev/sda2", PRIMARY);
+    Subdevice::create(devicegraph, sda, sda2);
+
+    LvmVg* system = LvmVg::create(devicegraph, "/dev/system");
+    User::create(devicegraph, sda1, system);
+    User::create(devicegraph, sda2, system);
+
+    LvmLv* system_root = LvmLv::create(devicegraph, "/dev/system/root");
+    Subdevice::create(devicegraph, system, system_root);
+
+    const DevicegraphTable table = devicegraph->get_table();
+
+    BOOST_REQUIRE_EQUAL(table.size(), 5);
+    BOOST_REQUIRE_EQUAL(table.parent_offsets.size(), 6);
+    BOOST_CHECK_EQUAL(table.parent_sids.size(), 5);
+    BOOST_REQUIRE_EQUAL(table.child_offsets.size(), 6);
+    BOOST_CHECK_EQUAL(table.child_sids.size(), 5);
+
+    BOOST_CHECK(table.sids == devicegraph->get_sids());
+
+    for (size_t i = 0; i < table.size(); ++i)
+    {
+	const Device* device = devicegraph->find_device(table.sids[i]);
+
+	vector<sid_t> parent_sids(table.parent_sids.begin() + table.parent_offsets[i],
+				  table.parent_sids.begin() + table.parent_offsets[i + 1]);
+
+	vector<sid_t> expected;
+	for (const Device* parent : device->get_parents())
+	    expected.push_back(parent->get_sid());
+
+	BOOST_CHECK(parent_sids == expected);
+	BOOST_CHECK(parent_sids == devicegraph->get_parent_sids(table.sids[i]));
+
+	vector<sid_t> child_sids(table.child_sids.begin() + table.child_offsets[i],
+				 table.child_sids.begin() + table.child_offsets[i + 1]);
+	BOOST_CHECK(child_sids == devicegraph->get_children_sids(table.sids[i]));
+
+	if (device == sda)
+	{
+	    BOOST_CHECK_EQUAL(table.classnames[i], "Disk");
+	    BOOST_CHECK_EQUAL(table.names[i], "/dev/sda");
+	    BOOST_CHECK_EQUAL(table.sizes_k[i], 1024 * 1024);
+	    BOOST_CHECK_EQUAL(devicegraph->get_children_sids(table.sids[i]).size(), 2);
+	}
+	else if (device == sda1)
+	{
+	    BOOST_CHECK_EQUAL(table.classnames[i], "Partition");
+	    BOOST_CHECK_EQUAL(table.names[i], "/dev/sda1");
+	}
+	else if (device == system)
+	{
+	    BOOST_CHECK_EQUAL(table.classnames[i], "LvmVg");
+	    BOOST_CHECK_EQUAL(parent_sids.size(), 2);
+	}
+    }
+
+    delete devicegraph;
+}
+
+
+BOOST_AUTO_TEST_CASE(table_json)
+{
+    Devicegraph* devicegraph = new Devicegraph();
+
+    Disk* sda = Disk::create(devicegraph, "/dev/sda");
+    sda->set_size_k(1024);
+
+    Partition* sda1 = Partition::create(devicegraph, "/dev/sda1", PRIMARY);
+    Subdevice::create(devicegraph, sda, sda1);
+
+    string sda_sid = to_string(sda->get_sid());
+    string sda1_sid = to_string(sda1->get_sid());
+
+    BOOST_CHECK_EQUAL(devicegraph->get_table_json(),
+		      "{\"sids\":[" + sda_sid + "," + sda1_sid + "],"
+		      "\"classnames\":[\"Disk\",\"Partition\"],"
+		      "\"names\":[\"/dev/sda\",\"/dev/sda1\"],"
+		      "\"sizes_k\":[1024,0],"
+		      "\"parent_offsets\":[0,0,1],"
+		      "\"parent_sids\":[" + sda_sid + "],"
+		      "\"child_offsets\":[0,1,1],"
+		      "\"child_sids\":[" + sda1_sid + "]}");
+
+    delete devicegraph;
+}
+
+
+BOOST_AUTO_TEST_CASE(walk_large)
+{
+    Devicegraph* devicegraph = new Devicegraph();
+
+    // 2000 disks with 4 partitions each
+    for (int i = 0; i < 2000; ++i)
+    {
+	Disk* disk = Disk::create(devicegraph, "/dev/disk" + to_string(i));
+	for (int j = 1; j <= 4; ++j)
+	{
+	    Partition* partition = Partition::create(devicegraph, disk->get_name() + "p" +
+						     to_string(j), PRIMARY);
+	    Subdevice::create(devicegraph, disk, partition);
+	}
+    }
+
+    const DevicegraphTable table = devicegraph->get_table();
+    BOOST_REQUIRE_EQUAL(table.size(), 10000);
+
+    map<sid_t, size_t> indices;
+    for (size_t i = 0; i < table.size(); ++i)
+	indices[table.sids[i]] = i;
+
+    // walk down from all disks using only the table
+    size_t num_disks = 0, num_partitions = 0;
+
+    for (size_t i = 0; i < table.size(); ++i)
+    {
+	if (table.parent_offsets[i] != table.parent_offsets[i + 1])
+	    continue;
+
+	++num_disks;
+
+	for (size_t j = table.child_offsets[i]; j < table.child_offsets[i + 1]; ++j)
+	{
+	    size_t child = indices.at(table.child_sids[j]);
+	    BOOST_CHECK_EQUAL(table.classnames[child], "Partition");
+	    BOOST_CHECK_EQUAL(table.parent_sids[table.parent_offsets[child]], table.sids[i]);
+	    ++num_partitions;
+	}
+    }
+
+    BOOST_CHECK_EQUAL(num_disks, 2000);
+    BOOST_CHECK_EQUAL(num_partitions, 8000);
+
+    delete devicegraph;
+}